@@ -950,6 +950,28 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         default=0,
         min=0, max=16,
     )
+    use_bvh_disk_cache: BoolProperty(
+        name="Use BVH Disk Cache",
+        description="Store BVHs of instanced geometry on disk and reuse them in later final renders, "
+        "when the geometry is unchanged. Only used for the BVH2 of instanced geometry, as built for CUDA and "
+        "for HIP without hardware ray-tracing. The scene BVH, Embree and hardware ray-tracing BVHs are "
+        "always rebuilt",
+        default=False,
+    )
+    bvh_disk_cache_size_limit: IntProperty(
+        name="BVH Disk Cache Size",
+        description="Maximum size in megabytes of the BVH disk cache, removing the least recently used BVHs "
+        "when exceeded (0 for no limit)",
+        min=0,
+        default=4096,
+    )
+    use_bvh_refit: BoolProperty(
+        name="Refit BVH",
+        description="Update the BVH of deforming geometry by refitting instead of rebuilding it, "
+        "when the topology does not change. Faster updates with persistent data, but may render "
+        "slower with large deformation. Not used for Embree and hardware ray-tracing BVHs",
+        default=False,
+    )
 
     bake_type: EnumProperty(
         name="Bake Type",
@@ -1048,6 +1070,13 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         items=enum_texture_limit,
     )
 
+    texture_cache_memory_limit: IntProperty(
+        name="Memory Limit",
+        description="Maximum memory in megabytes for texture cache tiles, evicting the least recently used tiles when exceeded (0 for no limit)",
+        min=0,
+        default=0,
+    )
+
     use_fast_gi: BoolProperty(
         name="Fast GI Approximation",
         description="Approximate diffuse indirect light with background tinted ambient occlusion. "
@@ -1103,6 +1132,11 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         items=enum_bvh_layouts,
         default='EMBREE',
     )
+    debug_use_cpu_wavefront: BoolProperty(
+        name="Wavefront",
+        description="Render batches of paths together and sort them by shader before surface shading",
+        default=False,
+    )
 
     adaptive_compile_description = "Compile the Cycles GPU kernel with only the feature set required for the current scene"
 
@@ -899,11 +899,13 @@ class CYCLES_RENDER_PT_performance_texture_cache(CyclesButtonsPanel, Panel):
         layout.use_property_decorate = False
 
         rd = context.scene.render
+        cscene = context.scene.cycles
 
         col = layout.column()
         col.active = rd.use_texture_cache
 
         col.prop(rd, "use_auto_generate_texture_cache", text="Auto Generate")
+        col.prop(cscene, "texture_cache_memory_limit", text="Memory Limit")
 
         row = col.split(factor=0.4)
         row.label()
@@ -913,7 +915,6 @@ class CYCLES_RENDER_PT_performance_texture_cache(CyclesButtonsPanel, Panel):
 
         prefs = context.preferences
         if prefs.experimental.use_cycles_debug and prefs.view.show_developer_ui:
-            cscene = context.scene.cycles
             col = layout.column(heading="Debug")
             col.active = rd.use_texture_cache
             col.prop(cscene, "debug_use_texture_cache_eviction")
@@ -954,6 +955,7 @@ class CYCLES_RENDER_PT_performance_acceleration_structure(CyclesButtonsPanel, Pa
                 sub.prop(cscene, "debug_bvh_time_steps")
 
                 col.prop(cscene, "debug_use_hair_bvh")
+                col.prop(cscene, "use_bvh_refit")
 
                 sub = col.column(align=True)
                 sub.label(text="Cycles built without Embree support")
@@ -965,6 +967,11 @@ class CYCLES_RENDER_PT_performance_acceleration_structure(CyclesButtonsPanel, Pa
             sub.prop(cscene, "debug_bvh_time_steps")
 
             col.prop(cscene, "debug_use_hair_bvh")
+            col.prop(cscene, "use_bvh_disk_cache")
+            sub = col.column()
+            sub.active = cscene.use_bvh_disk_cache
+            sub.prop(cscene, "bvh_disk_cache_size_limit")
+            col.prop(cscene, "use_bvh_refit")
 
             # CPU is used in addition to a GPU
             if use_multi_device(context) and use_embree:
@@ -2291,6 +2298,7 @@ class CYCLES_RENDER_PT_debug(CyclesDebugButtonsPanel, Panel):
         row.prop(cscene, "debug_use_cpu_sse42", toggle=True)
         row.prop(cscene, "debug_use_cpu_avx2", toggle=True)
         col.prop(cscene, "debug_bvh_layout", text="BVH")
+        col.prop(cscene, "debug_use_cpu_wavefront")
 
         import platform
         is_macos = platform.system() == 'Darwin'
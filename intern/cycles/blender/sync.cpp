@@ -990,6 +990,12 @@ SceneParams BlenderSync::get_scene_params(blender::UserDef &b_preferences,
   params.use_bvh_compact_structure = RNA_boolean_get(&cscene, "debug_use_compact_bvh");
   params.use_bvh_unaligned_nodes = RNA_boolean_get(&cscene, "debug_use_hair_bvh");
   params.num_bvh_time_steps = RNA_int_get(&cscene, "debug_bvh_time_steps");
+  /* Only for final renders, where geometry is likely the same in the next frame or process. */
+  params.use_bvh_disk_cache = background && RNA_boolean_get(&cscene, "use_bvh_disk_cache");
+  params.bvh_disk_cache_size_limit = size_t(get_int(cscene, "bvh_disk_cache_size_limit")) * 1024 *
+                                     1024;
+  params.use_bvh_refit = RNA_boolean_get(&cscene, "use_bvh_refit");
+  params.use_persistent_data = (b_scene.r.mode & blender::R_PERSISTENT_DATA) != 0;
 
   blender::PointerRNA csscene = RNA_pointer_get(&scene_rna_ptr, "cycles_curves");
   params.hair_subdivisions = get_int(csscene, "subdivisions");
@@ -1022,6 +1028,8 @@ SceneParams BlenderSync::get_scene_params(blender::UserDef &b_preferences,
   params.auto_texture_cache = b_scene.r.scemode & blender::R_TEXTURE_CACHE_AUTO_GENERATE;
   params.texture_cache_path = blender_absolute_path(
       b_data, nullptr, b_preferences.texture_cachedir);
+  params.texture_cache_memory_limit = size_t(get_int(cscene, "texture_cache_memory_limit")) *
+                                      1024 * 1024;
 
   return params;
 }
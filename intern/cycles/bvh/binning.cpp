@@ -13,7 +13,9 @@
 
 #include "util/algorithm.h"
 #include "util/boundbox.h"
+#include "util/tbb.h"
 #include "util/types.h"
+#include "util/vector.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -55,13 +57,15 @@ __forceinline int get_best_dimension(const float4 &bestSAH)
 BVHObjectBinning::BVHObjectBinning(const BVHRange &job,
                                    BVHReference *prims,
                                    const BVHUnaligned *unaligned_heuristic,
-                                   const Transform *aligned_space)
+                                   const Transform *aligned_space,
+                                   const bool use_parallel_binning)
     : BVHRange(job),
       splitSAH(FLT_MAX),
       dim(0),
       pos(0),
       unaligned_heuristic_(unaligned_heuristic),
-      aligned_space_(aligned_space)
+      aligned_space_(aligned_space),
+      use_parallel_binning_(use_parallel_binning)
 {
   if (aligned_space_ == nullptr) {
     bounds_ = bounds();
@@ -79,74 +83,36 @@ BVHObjectBinning::BVHObjectBinning(const BVHRange &job,
   num_bins = min(size_t(MAX_BINS), size_t(4.0f + 0.05f * size()));
   scale = safe_divide(make_float3((float)num_bins), cent_bounds_.size());
 
-  /* initialize binning counter and bounds */
-  BoundBox bin_bounds[MAX_BINS][4]; /* bounds for every bin in every dimension */
-  int4 bin_count[MAX_BINS];         /* number of primitives mapped to bin */
-
-  for (size_t i = 0; i < num_bins; i++) {
-    bin_count[i] = make_int4(0);
-    bin_bounds[i][0] = bin_bounds[i][1] = bin_bounds[i][2] = BoundBox::empty;
-  }
-
-  /* map geometry to bins, unrolled once */
-  {
-    int64_t i;
-
-    for (i = 0; i < int64_t(size()) - 1; i += 2) {
-      prefetch_L2(&prims[start() + i + 8]);
-
-      /* map even and odd primitive to bin */
-      const BVHReference &prim0 = prims[start() + i + 0];
-      const BVHReference &prim1 = prims[start() + i + 1];
-
-      const BoundBox bounds0 = get_prim_bounds(prim0);
-      const BoundBox bounds1 = get_prim_bounds(prim1);
-
-      const int4 bin0 = get_bin(bounds0);
-      const int4 bin1 = get_bin(bounds1);
-
-      /* increase bounds for bins for even primitive */
-      const int b00 = (int)extract<0>(bin0);
-      bin_count[b00][0]++;
-      bin_bounds[b00][0].grow(bounds0);
-      const int b01 = (int)extract<1>(bin0);
-      bin_count[b01][1]++;
-      bin_bounds[b01][1].grow(bounds0);
-      const int b02 = (int)extract<2>(bin0);
-      bin_count[b02][2]++;
-      bin_bounds[b02][2].grow(bounds0);
-
-      /* increase bounds of bins for odd primitive */
-      const int b10 = (int)extract<0>(bin1);
-      bin_count[b10][0]++;
-      bin_bounds[b10][0].grow(bounds1);
-      const int b11 = (int)extract<1>(bin1);
-      bin_count[b11][1]++;
-      bin_bounds[b11][1].grow(bounds1);
-      const int b12 = (int)extract<2>(bin1);
-      bin_count[b12][2]++;
-      bin_bounds[b12][2].grow(bounds1);
-    }
-
-    /* for uneven number of primitives */
-    if (i < int64_t(size())) {
-      /* map primitive to bin */
-      const BVHReference &prim0 = prims[start() + i];
-      const BoundBox bounds0 = get_prim_bounds(prim0);
-      const int4 bin0 = get_bin(bounds0);
-
-      /* increase bounds of bins */
-      const int b00 = (int)extract<0>(bin0);
-      bin_count[b00][0]++;
-      bin_bounds[b00][0].grow(bounds0);
-      const int b01 = (int)extract<1>(bin0);
-      bin_count[b01][1]++;
-      bin_bounds[b01][1].grow(bounds0);
-      const int b02 = (int)extract<2>(bin0);
-      bin_count[b02][2]++;
-      bin_bounds[b02][2].grow(bounds0);
+  /* map geometry to bins */
+  Bins bins;
+  if (use_parallel()) {
+    /* Bin chunks of primitives in parallel and merge them afterwards, since near the root of
+     * the tree there are few subtrees to build in parallel yet. */
+    const size_t num_chunks = divide_up(size(), PARALLEL_BINNING_CHUNK_SIZE);
+    vector<Bins> chunk_bins(num_chunks);
+
+    parallel_for(size_t(0), num_chunks, [&](const size_t chunk) {
+      const size_t chunk_start = start() + chunk * PARALLEL_BINNING_CHUNK_SIZE;
+      const size_t chunk_end = min(chunk_start + PARALLEL_BINNING_CHUNK_SIZE, size_t(end()));
+      bin_primitives(prims, chunk_start, chunk_end, chunk_bins[chunk]);
+    });
+
+    bins = chunk_bins[0];
+    for (size_t chunk = 1; chunk < num_chunks; chunk++) {
+      for (size_t i = 0; i < num_bins; i++) {
+        bins.count[i] = bins.count[i] + chunk_bins[chunk].count[i];
+        bins.bounds[i][0].grow(chunk_bins[chunk].bounds[i][0]);
+        bins.bounds[i][1].grow(chunk_bins[chunk].bounds[i][1]);
+        bins.bounds[i][2].grow(chunk_bins[chunk].bounds[i][2]);
+      }
     }
   }
+  else {
+    bin_primitives(prims, start(), end(), bins);
+  }
+
+  const int4 *bin_count = bins.count;
+  const BoundBox(*bin_bounds)[4] = bins.bounds;
 
   /* sweep from right to left and compute parallel prefix of merged bounds */
   float4 r_area[MAX_BINS];  /* area of bounds of primitives on the right */
@@ -209,6 +175,79 @@ BVHObjectBinning::BVHObjectBinning(const BVHRange &job,
   leafSAH = bounds_.half_area() * blocks(size());
 }
 
+void BVHObjectBinning::bin_primitives(const BVHReference *prims,
+                                      const size_t begin,
+                                      const size_t end,
+                                      Bins &bins) const
+{
+  /* initialize binning counter and bounds */
+  int4 *bin_count = bins.count;
+  BoundBox(*bin_bounds)[4] = bins.bounds;
+
+  for (size_t i = 0; i < num_bins; i++) {
+    bin_count[i] = make_int4(0);
+    bin_bounds[i][0] = bin_bounds[i][1] = bin_bounds[i][2] = BoundBox::empty;
+  }
+
+  /* map geometry to bins, unrolled once */
+  int64_t i;
+
+  for (i = int64_t(begin); i < int64_t(end) - 1; i += 2) {
+    prefetch_L2(&prims[i + 8]);
+
+    /* map even and odd primitive to bin */
+    const BVHReference &prim0 = prims[i + 0];
+    const BVHReference &prim1 = prims[i + 1];
+
+    const BoundBox bounds0 = get_prim_bounds(prim0);
+    const BoundBox bounds1 = get_prim_bounds(prim1);
+
+    const int4 bin0 = get_bin(bounds0);
+    const int4 bin1 = get_bin(bounds1);
+
+    /* increase bounds for bins for even primitive */
+    const int b00 = (int)extract<0>(bin0);
+    bin_count[b00][0]++;
+    bin_bounds[b00][0].grow(bounds0);
+    const int b01 = (int)extract<1>(bin0);
+    bin_count[b01][1]++;
+    bin_bounds[b01][1].grow(bounds0);
+    const int b02 = (int)extract<2>(bin0);
+    bin_count[b02][2]++;
+    bin_bounds[b02][2].grow(bounds0);
+
+    /* increase bounds of bins for odd primitive */
+    const int b10 = (int)extract<0>(bin1);
+    bin_count[b10][0]++;
+    bin_bounds[b10][0].grow(bounds1);
+    const int b11 = (int)extract<1>(bin1);
+    bin_count[b11][1]++;
+    bin_bounds[b11][1].grow(bounds1);
+    const int b12 = (int)extract<2>(bin1);
+    bin_count[b12][2]++;
+    bin_bounds[b12][2].grow(bounds1);
+  }
+
+  /* for uneven number of primitives */
+  if (i < int64_t(end)) {
+    /* map primitive to bin */
+    const BVHReference &prim0 = prims[i];
+    const BoundBox bounds0 = get_prim_bounds(prim0);
+    const int4 bin0 = get_bin(bounds0);
+
+    /* increase bounds of bins */
+    const int b00 = (int)extract<0>(bin0);
+    bin_count[b00][0]++;
+    bin_bounds[b00][0].grow(bounds0);
+    const int b01 = (int)extract<1>(bin0);
+    bin_count[b01][1]++;
+    bin_bounds[b01][1].grow(bounds0);
+    const int b02 = (int)extract<2>(bin0);
+    bin_count[b02][2]++;
+    bin_bounds[b02][2].grow(bounds0);
+  }
+}
+
 void BVHObjectBinning::split(BVHReference *prims,
                              BVHObjectBinning &left_o,
                              BVHObjectBinning &right_o) const
@@ -223,6 +262,11 @@ void BVHObjectBinning::split(BVHReference *prims,
   int64_t l = 0;
   int64_t r = N - 1;
 
+  if (use_parallel()) {
+    l = split_parallel(prims, lgeom_bounds, lcent_bounds, rgeom_bounds, rcent_bounds);
+    r = l - 1;
+  }
+
   while (l <= r) {
     prefetch_L2(&prims[start() + l + 8]);
     prefetch_L2(&prims[start() + r - 8]);
@@ -247,8 +291,15 @@ void BVHObjectBinning::split(BVHReference *prims,
   /* finish */
   if (l != 0 && N - 1 - r != 0) {
     right_o = BVHObjectBinning(BVHRange(rgeom_bounds, rcent_bounds, start() + l, N - 1 - r),
-                               prims);
-    left_o = BVHObjectBinning(BVHRange(lgeom_bounds, lcent_bounds, start(), l), prims);
+                               prims,
+                               nullptr,
+                               nullptr,
+                               use_parallel_binning_);
+    left_o = BVHObjectBinning(BVHRange(lgeom_bounds, lcent_bounds, start(), l),
+                              prims,
+                              nullptr,
+                              nullptr,
+                              use_parallel_binning_);
     return;
   }
 
@@ -270,8 +321,110 @@ void BVHObjectBinning::split(BVHReference *prims,
   }
 
   right_o = BVHObjectBinning(BVHRange(rgeom_bounds, rcent_bounds, start() + N / 2, N / 2 + N % 2),
-                             prims);
-  left_o = BVHObjectBinning(BVHRange(lgeom_bounds, lcent_bounds, start(), N / 2), prims);
+                             prims,
+                             nullptr,
+                             nullptr,
+                             use_parallel_binning_);
+  left_o = BVHObjectBinning(BVHRange(lgeom_bounds, lcent_bounds, start(), N / 2),
+                            prims,
+                            nullptr,
+                            nullptr,
+                            use_parallel_binning_);
+}
+
+size_t BVHObjectBinning::split_parallel(BVHReference *prims,
+                                        BoundBox &lgeom_bounds,
+                                        BoundBox &lcent_bounds,
+                                        BoundBox &rgeom_bounds,
+                                        BoundBox &rcent_bounds) const
+{
+  struct Chunk {
+    size_t start;
+    size_t end;
+    size_t num_left = 0;
+    size_t left_offset = 0;
+    size_t right_offset = 0;
+    BoundBox lgeom_bounds = BoundBox::empty;
+    BoundBox rgeom_bounds = BoundBox::empty;
+    BoundBox lcent_bounds = BoundBox::empty;
+    BoundBox rcent_bounds = BoundBox::empty;
+  };
+
+  const size_t N = size();
+  const size_t num_chunks = divide_up(N, PARALLEL_BINNING_CHUNK_SIZE);
+  vector<Chunk> chunks(num_chunks);
+  for (size_t i = 0; i < num_chunks; i++) {
+    chunks[i].start = start() + i * PARALLEL_BINNING_CHUNK_SIZE;
+    chunks[i].end = min(chunks[i].start + PARALLEL_BINNING_CHUNK_SIZE, size_t(end()));
+  }
+
+  auto is_left = [&](const BVHReference &prim) {
+    return get_bin(get_prim_bounds(prim).center2())[dim] < pos;
+  };
+
+  /* Count primitives on either side and compute their bounds. */
+  parallel_for(size_t(0), num_chunks, [&](const size_t i) {
+    Chunk &chunk = chunks[i];
+    for (size_t j = chunk.start; j < chunk.end; j++) {
+      const BVHReference &prim = prims[j];
+      const float3 center = prim.bounds().center2();
+
+      if (is_left(prim)) {
+        chunk.lgeom_bounds.grow(prim.bounds());
+        chunk.lcent_bounds.grow(center);
+        chunk.num_left++;
+      }
+      else {
+        chunk.rgeom_bounds.grow(prim.bounds());
+        chunk.rcent_bounds.grow(center);
+      }
+    }
+  });
+
+  /* Compute where every chunk writes its primitives, keeping them in order. */
+  size_t num_left = 0;
+  for (Chunk &chunk : chunks) {
+    chunk.left_offset = num_left;
+    num_left += chunk.num_left;
+
+    lgeom_bounds.grow(chunk.lgeom_bounds);
+    lcent_bounds.grow(chunk.lcent_bounds);
+    rgeom_bounds.grow(chunk.rgeom_bounds);
+    rcent_bounds.grow(chunk.rcent_bounds);
+  }
+
+  size_t num_right = 0;
+  for (Chunk &chunk : chunks) {
+    chunk.right_offset = num_left + num_right;
+    num_right += (chunk.end - chunk.start) - chunk.num_left;
+  }
+
+  /* Partition into temporary storage and copy back. */
+  vector<BVHReference> partitioned(N);
+
+  parallel_for(size_t(0), num_chunks, [&](const size_t i) {
+    const Chunk &chunk = chunks[i];
+    size_t left = chunk.left_offset;
+    size_t right = chunk.right_offset;
+    for (size_t j = chunk.start; j < chunk.end; j++) {
+      const BVHReference &prim = prims[j];
+      if (is_left(prim)) {
+        partitioned[left++] = prim;
+      }
+      else {
+        partitioned[right++] = prim;
+      }
+    }
+  });
+
+  parallel_for(size_t(0), num_chunks, [&](const size_t i) {
+    const Chunk &chunk = chunks[i];
+    std::copy(partitioned.begin() + (chunk.start - start()),
+              partitioned.begin() + (chunk.end - start()),
+              prims + chunk.start);
+  });
+
+  return num_left;
 }
 
 CCL_NAMESPACE_END
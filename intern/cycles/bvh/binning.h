@@ -16,21 +16,24 @@ CCL_NAMESPACE_BEGIN
 
 class BVHBuild;
 
-/* Single threaded object binner. Finds the split with the best SAH heuristic
+/* Object binner. Finds the split with the best SAH heuristic
  * by testing for each dimension multiple partitionings for regular spaced
  * partition locations. A partitioning for a partition location is computed,
  * by putting primitives whose centroid is on the left and right of the split
  * location to different sets. The SAH is evaluated by computing the number of
- * blocks occupied by the primitives in the partitions. */
+ * blocks occupied by the primitives in the partitions.
+ *
+ * Large ranges are optionally binned and partitioned by multiple threads. */
 
 class BVHObjectBinning : public BVHRange {
  public:
-  __forceinline BVHObjectBinning() : leafSAH(FLT_MAX) {}
+  __forceinline BVHObjectBinning() : leafSAH(FLT_MAX), use_parallel_binning_(false) {}
 
   BVHObjectBinning(const BVHRange &job,
                    BVHReference *prims,
                    const BVHUnaligned *unaligned_heuristic = nullptr,
-                   const Transform *aligned_space = nullptr);
+                   const Transform *aligned_space = nullptr,
+                   const bool use_parallel_binning = false);
 
   void split(BVHReference *prims, BVHObjectBinning &left_o, BVHObjectBinning &right_o) const;
 
@@ -55,9 +58,39 @@ class BVHObjectBinning : public BVHRange {
   const BVHUnaligned *unaligned_heuristic_;
   const Transform *aligned_space_;
 
+  bool use_parallel_binning_;
+
   enum { MAX_BINS = 32 };
   enum { LOG_BLOCK_SIZE = 2 };
 
+  /* Ranges from this size on are binned and partitioned in parallel, in chunks of primitives.
+   * Chunks are fixed size so the result does not depend on the number of threads. */
+  enum { PARALLEL_BINNING_MIN_SIZE = 1 << 16 };
+  enum { PARALLEL_BINNING_CHUNK_SIZE = 1 << 14 };
+
+  /* Number of primitives mapped to bin and bounds for every bin in every dimension. */
+  struct Bins {
+    int4 count[MAX_BINS];
+    BoundBox bounds[MAX_BINS][4];
+  };
+
+  void bin_primitives(const BVHReference *prims,
+                      const size_t begin,
+                      const size_t end,
+                      Bins &bins) const;
+
+  /* Partition the range in parallel, returns the number of primitives on the left. */
+  size_t split_parallel(BVHReference *prims,
+                        BoundBox &lgeom_bounds,
+                        BoundBox &lcent_bounds,
+                        BoundBox &rgeom_bounds,
+                        BoundBox &rcent_bounds) const;
+
+  __forceinline bool use_parallel() const
+  {
+    return use_parallel_binning_ && size() >= PARALLEL_BINNING_MIN_SIZE;
+  }
+
   /* computes the bin numbers for each dimension for a box. */
   __forceinline int4 get_bin(const BoundBox &box) const
   {
@@ -521,7 +521,11 @@ unique_ptr<BVHNode> BVHBuild::run()
   }
   else {
     /* Perform multithreaded binning build. */
-    const BVHObjectBinning rootbin(root, (!references.empty()) ? references.data() : nullptr);
+    const BVHObjectBinning rootbin(root,
+                                   (!references.empty()) ? references.data() : nullptr,
+                                   nullptr,
+                                   nullptr,
+                                   params.use_parallel_binning);
     rootnode = build_node(rootbin, 0);
     task_pool.wait_work();
   }
@@ -712,8 +716,11 @@ unique_ptr<BVHNode> BVHBuild::build_node(const BVHObjectBinning &range, const in
   bool do_unalinged_split = false;
   if (params.use_unaligned_nodes && splitSAH > params.unaligned_split_threshold * leafSAH) {
     aligned_space = unaligned_heuristic.compute_aligned_space(range, references.data());
-    unaligned_range = BVHObjectBinning(
-        range, references.data(), &unaligned_heuristic, &aligned_space);
+    unaligned_range = BVHObjectBinning(range,
+                                       references.data(),
+                                       &unaligned_heuristic,
+                                       &aligned_space,
+                                       params.use_parallel_binning);
     unalignedSplitSAH = params.sah_node_cost * unaligned_range.unaligned_bounds().half_area() +
                         params.sah_primitive_cost * unaligned_range.splitSAH;
     unalignedLeafSAH = params.sah_primitive_cost * unaligned_range.leafSAH;
@@ -15,6 +15,7 @@
 #include "scene/pointcloud.h"
 
 #include "bvh/build.h"
+#include "bvh/disk_cache.h"
 #include "bvh/node.h"
 #include "bvh/unaligned.h"
 
@@ -38,6 +39,27 @@ BVH2::BVH2(const BVHParams &params_,
 
 void BVH2::build(Progress &progress, Stats * /*unused*/)
 {
+  /* Reuse the BVH of identical geometry from a previous render. */
+  string disk_cache_key;
+  if (!params.disk_cache_path.empty() && !params.top_level && geometry.size() == 1) {
+    disk_cache_key = bvh_disk_cache_key(params, geometry[0]);
+    if (!disk_cache_key.empty() &&
+        bvh_disk_cache_read(params.disk_cache_path, disk_cache_key, pack))
+    {
+      /* Visibility is not part of the key, compute it for the objects like a refit does. */
+      pack_primitives();
+      refit_nodes();
+      return;
+    }
+  }
+
+  if (params.top_level) {
+    traceable_objects.resize(objects.size());
+    for (size_t i = 0; i < objects.size(); i++) {
+      traceable_objects[i] = objects[i]->is_traceable();
+    }
+  }
+
   progress.set_substatus("Building BVH");
 
   /* build nodes */
@@ -73,10 +95,22 @@ void BVH2::build(Progress &progress, Stats * /*unused*/)
   /* pack nodes */
   progress.set_substatus("Packing BVH nodes");
   pack_nodes(root.get());
+
+  if (!disk_cache_key.empty() && !progress.get_cancel()) {
+    bvh_disk_cache_write(params.disk_cache_path, disk_cache_key, pack);
+  }
 }
 
 void BVH2::refit(Progress &progress)
 {
+  /* For the top level BVH, the pack must only contain the top level nodes and primitives, the
+   * instance BVHs are merged again after refitting since they may have been rebuilt. */
+  if (params.top_level) {
+    assert(pack.nodes.size() == num_top_level_nodes);
+    assert(pack.leaf_nodes.size() == num_top_level_leaf_nodes);
+    assert(pack.prim_index.size() == num_top_level_prims);
+  }
+
   progress.set_substatus("Packing BVH primitives");
   pack_primitives();
 
@@ -86,6 +120,26 @@ void BVH2::refit(Progress &progress)
 
   progress.set_substatus("Refitting BVH nodes");
   refit_nodes();
+
+  if (params.top_level) {
+    progress.set_substatus("Packing BVH instances");
+    pack_instances(num_top_level_nodes, num_top_level_leaf_nodes);
+  }
+}
+
+bool BVH2::can_refit_top_level() const
+{
+  if (!params.top_level || traceable_objects.size() != objects.size()) {
+    return false;
+  }
+
+  for (size_t i = 0; i < objects.size(); i++) {
+    if (objects[i]->is_traceable() != traceable_objects[i]) {
+      return false;
+    }
+  }
+
+  return true;
 }
 
 unique_ptr<BVHNode> BVH2::widen_children_nodes(unique_ptr<BVHNode> &&root)
@@ -240,7 +294,20 @@ void BVH2::pack_nodes(const BVHNode *root)
   pack.leaf_nodes.clear();
   /* For top level BVH, first merge existing BVH's so we know the offsets. */
   if (params.top_level) {
-    pack_instances(node_size, num_leaf_nodes * BVH_NODE_LEAF_SIZE);
+    /* Adjust primitive index to point to the triangle in the global array, for
+     * geometry with transform applied and already in the top level BVH.
+     */
+    for (size_t i = 0; i < pack.prim_index.size(); i++) {
+      if (pack.prim_index[i] != -1) {
+        pack.prim_index[i] += objects[pack.prim_object[i]]->get_geometry()->prim_offset;
+      }
+    }
+
+    num_top_level_nodes = node_size;
+    num_top_level_leaf_nodes = num_leaf_nodes * BVH_NODE_LEAF_SIZE;
+    num_top_level_prims = pack.prim_index.size();
+
+    pack_instances(num_top_level_nodes, num_top_level_leaf_nodes);
   }
   else {
     pack.nodes.resize(node_size);
@@ -296,8 +363,6 @@ void BVH2::pack_nodes(const BVHNode *root)
 
 void BVH2::refit_nodes()
 {
-  assert(!params.top_level);
-
   BoundBox bbox = BoundBox::empty;
   uint visibility = 0;
   refit_node(0, (pack.root_index == -1) ? true : false, bbox, visibility);
@@ -465,15 +530,6 @@ void BVH2::pack_primitives()
 
 void BVH2::pack_instances(size_t nodes_size, size_t leaf_nodes_size)
 {
-  /* Adjust primitive index to point to the triangle in the global array, for
-   * geometry with transform applied and already in the top level BVH.
-   */
-  for (size_t i = 0; i < pack.prim_index.size(); i++) {
-    if (pack.prim_index[i] != -1) {
-      pack.prim_index[i] += objects[pack.prim_object[i]]->get_geometry()->prim_offset;
-    }
-  }
-
   /* track offsets of instanced BVH data in global array */
   size_t prim_offset = pack.prim_index.size();
   size_t nodes_offset = nodes_size;
@@ -44,9 +44,21 @@ class BVH2 : public BVH {
   void build(Progress &progress, Stats *stats);
   void refit(Progress &progress);
 
+  /* Test if the top level BVH can be refit, which requires the same primitives to be traced as
+   * when it was built. Only geometry positions and object transforms may have changed. */
+  bool can_refit_top_level() const;
+
   PackedBVH pack;
 
+  /* Size of the top level nodes and primitives in the pack, without merged instance BVHs. */
+  size_t num_top_level_nodes = 0;
+  size_t num_top_level_leaf_nodes = 0;
+  size_t num_top_level_prims = 0;
+
  protected:
+  /* Objects that were traceable when building the top level BVH. */
+  vector<bool> traceable_objects;
+
   /* Building process. */
   virtual unique_ptr<BVHNode> widen_children_nodes(unique_ptr<BVHNode> &&root);
 
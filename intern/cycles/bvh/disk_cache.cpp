@@ -0,0 +1,324 @@
+/* SPDX-FileCopyrightText: 2011-2026 Blender Foundation
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "bvh/disk_cache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <thread>
+
+#include "bvh/bvh.h"
+#include "bvh/params.h"
+
+#include "scene/attribute.h"
+#include "scene/hair.h"
+#include "scene/mesh.h"
+#include "scene/pointcloud.h"
+
+#include "util/log.h"
+#include "util/md5.h"
+#include "util/path.h"
+#include "util/time.h"
+
+#include <OpenImageIO/filesystem.h>
+
+CCL_NAMESPACE_BEGIN
+
+/* Increment when the BVH2 builder or the packed layout change, to invalidate old entries. */
+static const int BVH_DISK_CACHE_VERSION = 1;
+
+static const char BVH_DISK_CACHE_MAGIC[8] = {'C', 'Y', 'C', 'L', 'B', 'V', 'H', '2'};
+
+struct BVHDiskCacheHeader {
+  char magic[8];
+  int root_index;
+  int pad;
+  uint64_t nodes_size;
+  uint64_t leaf_nodes_size;
+  uint64_t object_node_size;
+  uint64_t prim_type_size;
+  uint64_t prim_index_size;
+  uint64_t prim_object_size;
+  uint64_t prim_time_size;
+};
+
+/* Key */
+
+static void md5_append_data(MD5Hash &md5, const void *data, size_t size)
+{
+  /* Append in chunks, since the hash only supports int sizes. */
+  const uint8_t *bytes = static_cast<const uint8_t *>(data);
+  while (size > 0) {
+    const int chunk_size = int(std::min(size, size_t(1) << 30));
+    md5.append(bytes, chunk_size);
+    bytes += chunk_size;
+    size -= chunk_size;
+  }
+}
+
+template<typename T> static void md5_append_value(MD5Hash &md5, const T value)
+{
+  md5_append_data(md5, &value, sizeof(value));
+}
+
+template<typename T> static void md5_append_array(MD5Hash &md5, const array<T> &data)
+{
+  md5_append_value(md5, uint64_t(data.size()));
+  md5_append_data(md5, data.data(), data.size() * sizeof(T));
+}
+
+static void md5_append_attribute(MD5Hash &md5, const Attribute *attr)
+{
+  if (attr == nullptr) {
+    md5_append_value(md5, -1);
+    return;
+  }
+
+  md5_append_value(md5, attr->size);
+  md5_append_value(md5, attr->num_motion_steps());
+  for (int step = 0; step < attr->num_motion_steps(); step++) {
+    md5_append_data(md5, attr->data(step), size_t(attr->size) * attr->data_sizeof());
+  }
+}
+
+string bvh_disk_cache_key(const BVHParams &params, const Geometry *geom)
+{
+  if (!(geom->is_mesh() || geom->is_volume() || geom->is_hair() || geom->is_pointcloud())) {
+    return "";
+  }
+
+  MD5Hash md5;
+  md5.append(string_printf("version:%d", BVH_DISK_CACHE_VERSION));
+
+  /* Build parameters, appended one by one to not depend on padding. */
+  md5_append_value(md5, params.use_spatial_split);
+  md5_append_value(md5, params.spatial_split_alpha);
+  md5_append_value(md5, params.unaligned_split_threshold);
+  md5_append_value(md5, params.sah_node_cost);
+  md5_append_value(md5, params.sah_primitive_cost);
+  md5_append_value(md5, params.min_leaf_size);
+  md5_append_value(md5, params.max_triangle_leaf_size);
+  md5_append_value(md5, params.max_motion_triangle_leaf_size);
+  md5_append_value(md5, params.max_curve_leaf_size);
+  md5_append_value(md5, params.max_motion_curve_leaf_size);
+  md5_append_value(md5, params.max_point_leaf_size);
+  md5_append_value(md5, params.max_motion_point_leaf_size);
+  md5_append_value(md5, params.use_unaligned_nodes);
+  md5_append_value(md5, params.use_parallel_binning);
+  md5_append_value(md5, params.num_motion_triangle_steps);
+  md5_append_value(md5, params.num_motion_curve_steps);
+  md5_append_value(md5, params.num_motion_point_steps);
+
+  /* Geometry data used by the build. */
+  md5_append_value(md5, int(geom->geometry_type));
+  md5_append_value(md5, int(geom->primitive_type()));
+  md5_append_value(md5, geom->has_motion_blur());
+  md5_append_value(md5, geom->get_motion_steps());
+  md5_append_attribute(md5, geom->attributes.find(ATTR_STD_POSITION));
+
+  if (geom->is_mesh() || geom->is_volume()) {
+    const Mesh *mesh = static_cast<const Mesh *>(geom);
+    md5_append_array(md5, mesh->get_triangles());
+  }
+  else if (geom->is_hair()) {
+    const Hair *hair = static_cast<const Hair *>(geom);
+    md5_append_attribute(md5, hair->attributes.find(ATTR_STD_RADIUS));
+    md5_append_array(md5, hair->get_curve_first_key());
+  }
+  else if (geom->is_pointcloud()) {
+    md5_append_attribute(md5, geom->attributes.find(ATTR_STD_RADIUS));
+  }
+
+  return md5.get_hex();
+}
+
+/* Read and Write */
+
+static string bvh_disk_cache_filepath(const string &dir, const string &key)
+{
+  return path_join(dir, key + ".bvh");
+}
+
+/* Temporary files older than this are left behind by processes that did not finish writing. */
+static const std::time_t BVH_DISK_CACHE_TEMP_FILE_AGE = 24 * 60 * 60;
+
+string bvh_disk_cache_prepare(const size_t size_limit)
+{
+  const string dir = path_cache_get("bvh");
+  bvh_disk_cache_prune(dir, size_limit);
+  return dir;
+}
+
+void bvh_disk_cache_prune(const string &dir, const size_t size_limit)
+{
+  if (!path_is_directory(dir)) {
+    return;
+  }
+
+  vector<string> filepaths;
+  if (!OIIO::Filesystem::get_directory_entries(dir, filepaths)) {
+    return;
+  }
+
+  const std::time_t current_time = std::time(nullptr);
+  vector<std::pair<std::time_t, string>> entries;
+  for (const string &filepath : filepaths) {
+    const std::time_t last_time = OIIO::Filesystem::last_write_time(filepath);
+    if (string_endswith(filepath, ".tmp")) {
+      if (current_time - last_time > BVH_DISK_CACHE_TEMP_FILE_AGE) {
+        path_remove(filepath);
+      }
+    }
+    else if (string_endswith(filepath, ".bvh")) {
+      entries.emplace_back(last_time, filepath);
+    }
+  }
+
+  if (size_limit == 0) {
+    return;
+  }
+
+  /* Keep the most recently used entries that fit in the limit. */
+  std::sort(entries.begin(), entries.end(), std::greater<>());
+  size_t total_size = 0;
+  size_t num_removed = 0;
+  for (const std::pair<std::time_t, string> &entry : entries) {
+    total_size += path_file_size(entry.second);
+    if (total_size > size_limit) {
+      path_remove(entry.second);
+      num_removed++;
+    }
+  }
+
+  if (num_removed > 0) {
+    LOG_DEBUG << "Removed " << num_removed << " least recently used BVH cache files from "
+              << dir;
+  }
+}
+
+template<typename T>
+static bool read_array(const vector<uint8_t> &binary,
+                       size_t &offset,
+                       const uint64_t size,
+                       array<T> &data)
+{
+  if (size > (binary.size() - offset) / sizeof(T)) {
+    return false;
+  }
+  data.resize(size);
+  if (size > 0) {
+    memcpy(data.data(), binary.data() + offset, size * sizeof(T));
+  }
+  offset += size * sizeof(T);
+  return true;
+}
+
+template<typename T>
+static void write_array(vector<uint8_t> &binary, size_t &offset, const array<T> &data)
+{
+  if (data.size() > 0) {
+    memcpy(binary.data() + offset, data.data(), data.size() * sizeof(T));
+  }
+  offset += data.size() * sizeof(T);
+}
+
+bool bvh_disk_cache_read(const string &dir, const string &key, PackedBVH &pack)
+{
+  /* Updates the modification time, to remove least recently used entries first. */
+  const string filepath = bvh_disk_cache_filepath(dir, key);
+  if (!path_cache_kernel_exists_and_mark_used(filepath)) {
+    return false;
+  }
+
+  vector<uint8_t> binary;
+  if (!path_read_binary(filepath, binary) || binary.size() < sizeof(BVHDiskCacheHeader)) {
+    return false;
+  }
+
+  BVHDiskCacheHeader header;
+  memcpy(&header, binary.data(), sizeof(header));
+  if (memcmp(header.magic, BVH_DISK_CACHE_MAGIC, sizeof(header.magic)) != 0) {
+    return false;
+  }
+
+  /* Validate all sizes against the file size, so that truncated files are ignored. */
+  size_t offset = sizeof(header);
+  if (!(read_array(binary, offset, header.nodes_size, pack.nodes) &&
+        read_array(binary, offset, header.leaf_nodes_size, pack.leaf_nodes) &&
+        read_array(binary, offset, header.object_node_size, pack.object_node) &&
+        read_array(binary, offset, header.prim_type_size, pack.prim_type) &&
+        read_array(binary, offset, header.prim_index_size, pack.prim_index) &&
+        read_array(binary, offset, header.prim_object_size, pack.prim_object) &&
+        read_array(binary, offset, header.prim_time_size, pack.prim_time) &&
+        offset == binary.size()))
+  {
+    LOG_WARNING << "Ignoring invalid BVH cache file " << filepath;
+    pack = PackedBVH();
+    return false;
+  }
+
+  pack.root_index = header.root_index;
+
+  LOG_DEBUG << "Loaded BVH from cache " << filepath;
+  return true;
+}
+
+void bvh_disk_cache_write(const string &dir, const string &key, const PackedBVH &pack)
+{
+  BVHDiskCacheHeader header = {};
+  memcpy(header.magic, BVH_DISK_CACHE_MAGIC, sizeof(header.magic));
+  header.root_index = pack.root_index;
+  header.nodes_size = pack.nodes.size();
+  header.leaf_nodes_size = pack.leaf_nodes.size();
+  header.object_node_size = pack.object_node.size();
+  header.prim_type_size = pack.prim_type.size();
+  header.prim_index_size = pack.prim_index.size();
+  header.prim_object_size = pack.prim_object.size();
+  header.prim_time_size = pack.prim_time.size();
+
+  vector<uint8_t> binary(sizeof(header) + pack.nodes.size() * sizeof(int4) +
+                         pack.leaf_nodes.size() * sizeof(int4) +
+                         pack.object_node.size() * sizeof(int) +
+                         pack.prim_type.size() * sizeof(int) +
+                         pack.prim_index.size() * sizeof(int) +
+                         pack.prim_object.size() * sizeof(int) +
+                         pack.prim_time.size() * sizeof(float2));
+
+  memcpy(binary.data(), &header, sizeof(header));
+  size_t offset = sizeof(header);
+  write_array(binary, offset, pack.nodes);
+  write_array(binary, offset, pack.leaf_nodes);
+  write_array(binary, offset, pack.object_node);
+  write_array(binary, offset, pack.prim_type);
+  write_array(binary, offset, pack.prim_index);
+  write_array(binary, offset, pack.prim_object);
+  write_array(binary, offset, pack.prim_time);
+
+  /* Write to a temporary file first and then rename it, so that other processes reading the
+   * cache at the same time never see a partially written file. */
+  const string filepath = bvh_disk_cache_filepath(dir, key);
+  const string temp_filepath = string_printf(
+      "%s.%zx.%llx.tmp",
+      filepath.c_str(),
+      std::hash<std::thread::id>()(std::this_thread::get_id()),
+      (unsigned long long)(time_dt() * 1e9));
+
+  if (!path_write_binary(temp_filepath, binary)) {
+    LOG_WARNING << "Failed to write BVH cache file " << temp_filepath;
+    return;
+  }
+
+  if (rename(temp_filepath.c_str(), filepath.c_str()) != 0) {
+    /* Another process may have written the same entry already. */
+    path_remove(temp_filepath);
+    return;
+  }
+
+  LOG_DEBUG << "Saved BVH to cache " << filepath;
+}
+
+CCL_NAMESPACE_END
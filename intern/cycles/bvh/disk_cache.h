@@ -0,0 +1,41 @@
+/* SPDX-FileCopyrightText: 2011-2026 Blender Foundation
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#pragma once
+
+#include "util/string.h"
+
+CCL_NAMESPACE_BEGIN
+
+class BVHParams;
+class Geometry;
+struct PackedBVH;
+
+/* BVH Disk Cache
+ *
+ * Stores the packed BVH2 of individual geometry in the user cache directory, so that the BVH of
+ * geometry that did not change can be reused by later render sessions and other processes, for
+ * example when rendering the frames of an animation. Entries are identified by a hash of the
+ * build parameters and the geometry data the build depends on. */
+
+/* Get the key identifying the BVH of the geometry built with the given parameters. Returns an
+ * empty string if the geometry type is not supported. */
+string bvh_disk_cache_key(const BVHParams &params, const Geometry *geom);
+
+/* Get the cache directory, and remove the least recently used entries until the cache fits in
+ * the size limit in bytes, zero for no limit. Call this before building BVHs in parallel, since
+ * looking up the user cache directory is not thread-safe. */
+string bvh_disk_cache_prepare(const size_t size_limit);
+
+/* Remove temporary files left behind by interrupted writes, and the least recently used entries
+ * until the cache directory fits in the size limit in bytes, zero for no limit. */
+void bvh_disk_cache_prune(const string &dir, const size_t size_limit);
+
+/* Read a cached BVH. Primitive visibility is not stored, and must be packed by the caller. */
+bool bvh_disk_cache_read(const string &dir, const string &key, PackedBVH &pack);
+
+/* Write a BVH to the cache, ignoring any failure. */
+void bvh_disk_cache_write(const string &dir, const string &key, const PackedBVH &pack);
+
+CCL_NAMESPACE_END
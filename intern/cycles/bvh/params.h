@@ -8,6 +8,7 @@
 #pragma once
 
 #include "util/boundbox.h"
+#include "util/string.h"
 #include "util/vector.h"
 
 #include "kernel/types.h"
@@ -90,6 +91,13 @@ class BVHParams {
   /* Use compact acceleration structure (Embree). */
   bool use_compact_structure;
 
+  /* Directory to reuse and store BVH2 builds of single geometry in, no disk cache if empty. */
+  string disk_cache_path;
+
+  /* Bin and partition large ranges of primitives with multiple threads, instead of only
+   * building subtrees in parallel. */
+  bool use_parallel_binning;
+
   /* Split time range to this number of steps and create leaf node for each
    * of this time steps.
    *
@@ -134,6 +142,7 @@ class BVHParams {
     bvh_layout = BVH_LAYOUT_BVH2;
     use_compact_structure = false;
     use_unaligned_nodes = false;
+    use_parallel_binning = true;
 
     num_motion_curve_steps = 0;
     num_motion_triangle_steps = 0;
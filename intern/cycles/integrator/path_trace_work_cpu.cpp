@@ -19,6 +19,8 @@
 #include "scene/scene.h"
 #include "session/buffers.h"
 
+#include "util/algorithm.h"
+#include "util/debug.h"
 #include "util/tbb.h"
 #include "util/time.h"
 
@@ -44,6 +46,9 @@ static inline ThreadKernelGlobalsCPU *kernel_thread_globals_get(
   return &kernel_thread_globals[thread_index];
 }
 
+/* Number of pixels whose paths are traced together in the wavefront mode. */
+static constexpr int64_t wavefront_pixels_num = 64;
+
 PathTraceWorkCPU::PathTraceWorkCPU(Device *device,
                                    Film *film,
                                    DeviceScene *device_scene,
@@ -81,26 +86,55 @@ void PathTraceWorkCPU::render_samples(RenderStatistics &statistics,
     }
   }
 
+  auto pixel_work_tile = [&](const int64_t work_index) {
+    const int y = work_index / image_width;
+    const int x = work_index - y * image_width;
+
+    KernelWorkTile work_tile;
+    work_tile.x = effective_buffer_params_.full_x + x;
+    work_tile.y = effective_buffer_params_.full_y + y;
+    work_tile.w = 1;
+    work_tile.h = 1;
+    work_tile.start_sample = start_sample;
+    work_tile.sample_offset = sample_offset;
+    work_tile.num_samples = 1;
+    work_tile.offset = effective_buffer_params_.offset;
+    work_tile.stride = effective_buffer_params_.stride;
+    return work_tile;
+  };
+
   tbb::task_arena local_arena = local_tbb_arena_create(device_);
   local_arena.execute([&]() {
+    if (use_wavefront()) {
+      const int64_t batches_num = divide_up(total_pixels_num, wavefront_pixels_num);
+      parallel_for(int64_t(0), batches_num, [&](int64_t batch_index) {
+        if (is_cancel_requested()) {
+          return;
+        }
+
+        const int64_t work_start = batch_index * wavefront_pixels_num;
+        const int64_t work_end = std::min(work_start + wavefront_pixels_num, total_pixels_num);
+
+        vector<KernelWorkTile> work_tiles;
+        work_tiles.reserve(work_end - work_start);
+        for (int64_t work_index = work_start; work_index < work_end; work_index++) {
+          work_tiles.push_back(pixel_work_tile(work_index));
+        }
+
+        ThreadKernelGlobalsCPU *kernel_globals = kernel_thread_globals_get(
+            *kernel_thread_globals_);
+
+        render_samples_wavefront(kernel_globals, work_tiles, samples_num);
+      });
+      return;
+    }
+
     parallel_for(int64_t(0), total_pixels_num, [&](int64_t work_index) {
       if (is_cancel_requested()) {
         return;
       }
 
-      const int y = work_index / image_width;
-      const int x = work_index - y * image_width;
-
-      KernelWorkTile work_tile;
-      work_tile.x = effective_buffer_params_.full_x + x;
-      work_tile.y = effective_buffer_params_.full_y + y;
-      work_tile.w = 1;
-      work_tile.h = 1;
-      work_tile.start_sample = start_sample;
-      work_tile.sample_offset = sample_offset;
-      work_tile.num_samples = 1;
-      work_tile.offset = effective_buffer_params_.offset;
-      work_tile.stride = effective_buffer_params_.stride;
+      const KernelWorkTile work_tile = pixel_work_tile(work_index);
 
       ThreadKernelGlobalsCPU *kernel_globals = kernel_thread_globals_get(*kernel_thread_globals_);
 
@@ -195,6 +229,111 @@ void PathTraceWorkCPU::render_samples_full_pipeline(ThreadKernelGlobalsCPU *kern
   }
 }
 
+bool PathTraceWorkCPU::use_wavefront() const
+{
+  if (!DebugFlags().cpu.use_wavefront) {
+    return false;
+  }
+
+  /* Render time is measured per sample of a single pixel, which is not possible when paths of
+   * many pixels are interleaved. */
+  if (device_scene_->data.film.pass_render_time != PASS_UNUSED) {
+    return false;
+  }
+
+#if defined(WITH_PATH_GUIDING)
+  /* Training data is collected per thread for one path at a time. */
+  if (device_scene_->data.integrator.train_guiding) {
+    return false;
+  }
+#endif
+
+  return true;
+}
+
+void PathTraceWorkCPU::render_samples_wavefront(ThreadKernelGlobalsCPU *kernel_globals,
+                                                vector<KernelWorkTile> &work_tiles,
+                                                const int samples_num)
+{
+  const bool has_bake = device_scene_->data.bake.use;
+
+  /* The shadow catcher splits a path into the state that directly follows it. */
+  const int states_per_pixel = device_scene_->data.integrator.has_shadow_catcher ? 2 : 1;
+  vector<IntegratorStateCPU> integrator_states(work_tiles.size() * states_per_pixel);
+  for (IntegratorStateCPU &state : integrator_states) {
+    path_state_init_queues(&state);
+  }
+
+  vector<IntegratorStateCPU *> active_states;
+  active_states.reserve(integrator_states.size());
+
+  float *render_buffer = buffers_->buffer.data();
+
+  for (int sample = 0; sample < samples_num; ++sample) {
+    if (is_cancel_requested()) {
+      break;
+    }
+
+    bool any_path_initialized = false;
+    for (size_t i = 0; i < work_tiles.size(); i++) {
+      KernelWorkTile &work_tile = work_tiles[i];
+      if (work_tile.num_samples == 0) {
+        continue;
+      }
+
+      IntegratorStateCPU *state = &integrator_states[i * states_per_pixel];
+      bool initialized;
+      if (has_bake) {
+        initialized = kernels_.integrator_init_from_bake(
+            kernel_globals, state, &work_tile, render_buffer);
+      }
+      else {
+        initialized = kernels_.integrator_init_from_camera(
+            kernel_globals, state, &work_tile, render_buffer);
+      }
+      if (!initialized) {
+        /* Same as the full pipeline, stop sampling this pixel. */
+        work_tile.num_samples = 0;
+        continue;
+      }
+
+      ++work_tile.start_sample;
+      any_path_initialized = true;
+    }
+
+    if (!any_path_initialized) {
+      break;
+    }
+
+    /* Advance all paths from one surface shading to the next, and shade the surfaces in order
+     * of their shaders, so that consecutive shader evaluations access the same data. */
+    while (true) {
+      active_states.clear();
+      for (IntegratorStateCPU &state : integrator_states) {
+        if (state.path.queued_kernel) {
+          active_states.push_back(&state);
+        }
+      }
+      if (active_states.empty()) {
+        break;
+      }
+
+      std::sort(active_states.begin(),
+                active_states.end(),
+                [](const IntegratorStateCPU *a, const IntegratorStateCPU *b) {
+                  if (a->path.queued_kernel != b->path.queued_kernel) {
+                    return a->path.queued_kernel < b->path.queued_kernel;
+                  }
+                  return a->path.shader_sort_key < b->path.shader_sort_key;
+                });
+
+      for (IntegratorStateCPU *state : active_states) {
+        kernels_.integrator_megakernel_until_shade_surface(kernel_globals, state, render_buffer);
+      }
+    }
+  }
+}
+
 void PathTraceWorkCPU::copy_to_display(PathTraceDisplay *display,
                                        PassMode pass_mode,
                                        const int num_samples)
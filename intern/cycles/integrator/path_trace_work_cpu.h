@@ -76,6 +76,15 @@ class PathTraceWorkCPU : public PathTraceWork {
                                     const KernelWorkTile &work_tile,
                                     const int samples_num);
 
+  /* Render samples of a batch of pixels at once, sorting the paths by shader before every
+   * surface shading. Each work tile covers a single pixel. */
+  void render_samples_wavefront(ThreadKernelGlobalsCPU *kernel_globals,
+                                vector<KernelWorkTile> &work_tiles,
+                                const int samples_num);
+
+  /* Whether the wavefront mode is requested and supported for the current render. */
+  bool use_wavefront() const;
+
   /* CPU kernels. */
   const CPUKernels &kernels_;
 
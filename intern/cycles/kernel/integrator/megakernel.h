@@ -19,10 +19,17 @@
 
 CCL_NAMESPACE_BEGIN
 
-ccl_device void integrator_megakernel(KernelGlobals kg,
-                                      IntegratorState state,
-                                      ccl_global float *ccl_restrict render_buffer)
+/* Execute kernels of the path until it terminates. When stop_at_shade_surface is true, return
+ * early once the path is queued for surface shading again, after at least one path kernel has
+ * been executed. At that point any pending shadow and AO paths have been handled already. */
+ccl_device_forceinline void integrator_megakernel_loop(KernelGlobals kg,
+                                                       IntegratorState state,
+                                                       ccl_global float *ccl_restrict
+                                                           render_buffer,
+                                                       const bool stop_at_shade_surface)
 {
+  bool path_kernel_executed = false;
+
   /* Each kernel indicates the next kernel to execute, so here we simply
    * have to check what that kernel is and execute it. */
   while (true) {
@@ -70,6 +77,13 @@ ccl_device void integrator_megakernel(KernelGlobals kg,
     /* Then handle regular path kernels. */
     const uint32_t queued_kernel = INTEGRATOR_STATE(state, path, queued_kernel);
     if (queued_kernel) {
+      if (stop_at_shade_surface && path_kernel_executed &&
+          queued_kernel == DEVICE_KERNEL_INTEGRATOR_SHADE_SURFACE)
+      {
+        return;
+      }
+      path_kernel_executed = true;
+
       switch (queued_kernel) {
         case DEVICE_KERNEL_INTEGRATOR_INTERSECT_CLOSEST:
           integrator_intersect_closest(kg, state, render_buffer);
@@ -118,4 +132,21 @@ ccl_device void integrator_megakernel(KernelGlobals kg,
   }
 }
 
+ccl_device void integrator_megakernel(KernelGlobals kg,
+                                      IntegratorState state,
+                                      ccl_global float *ccl_restrict render_buffer)
+{
+  integrator_megakernel_loop(kg, state, render_buffer, false);
+}
+
+/* Advance the path up to its next surface shading, so that the caller can sort a batch of paths
+ * by shader before shading them. A path that is queued for surface shading is shaded first. */
+ccl_device void integrator_megakernel_until_shade_surface(KernelGlobals kg,
+                                                          IntegratorState state,
+                                                          ccl_global float *ccl_restrict
+                                                              render_buffer)
+{
+  integrator_megakernel_loop(kg, state, render_buffer, true);
+}
+
 CCL_NAMESPACE_END
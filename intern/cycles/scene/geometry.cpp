@@ -3,6 +3,7 @@
  * SPDX-License-Identifier: Apache-2.0 */
 
 #include "bvh/bvh.h"
+#include "bvh/disk_cache.h"
 
 #include "device/device.h"
 
@@ -1085,6 +1086,12 @@ void GeometryManager::device_update(Device *device,
       }
     });
 
+    string bvh_disk_cache_path;
+    if (scene->params.use_bvh_disk_cache) {
+      /* Resolved once here, since looking up the cache directory is not safe in the tasks. */
+      bvh_disk_cache_path = bvh_disk_cache_prepare(scene->params.bvh_disk_cache_size_limit);
+    }
+
     size_t i = 0;
     size_t num_bvh = 0;
     for (Geometry *geom : scene->geometry) {
@@ -1097,9 +1104,11 @@ void GeometryManager::device_update(Device *device,
         }
 
         /* Note the use of #bvh_task_pool_, see its definition for details. */
-        bvh_task_pool_.push([geom, device, dscene, scene, &progress, i, &num_bvh] {
-          geom->compute_bvh(device, dscene, &scene->params, &progress, i, num_bvh);
-        });
+        bvh_task_pool_.push(
+            [geom, device, dscene, scene, &progress, &bvh_disk_cache_path, i, &num_bvh] {
+              geom->compute_bvh(
+                  device, dscene, &scene->params, &progress, bvh_disk_cache_path, i, num_bvh);
+            });
       }
     }
 
@@ -161,6 +161,7 @@ class Geometry : public Node {
                    DeviceScene *dscene,
                    SceneParams *params,
                    Progress *progress,
+                   const string &bvh_disk_cache_path,
                    const size_t n,
                    size_t total);
 
@@ -2,6 +2,8 @@
  *
  * SPDX-License-Identifier: Apache-2.0 */
 
+#include <algorithm>
+
 #include "bvh/bvh.h"
 #include "bvh/bvh2.h"
 #include "bvh/params.h"
@@ -23,10 +25,29 @@
 
 CCL_NAMESPACE_BEGIN
 
+/* Copy the top level part of the BVH2 data back from the device scene, where it was moved to
+ * after the previous build. */
+template<typename T>
+static bool copy_from_device_scene(array<T> &data,
+                                   device_vector<T> &device_data,
+                                   const size_t size)
+{
+  if (device_data.size() < size) {
+    return false;
+  }
+
+  data.resize(size);
+  if (size > 0) {
+    std::copy_n(device_data.data(), size, data.data());
+  }
+  return true;
+}
+
 void Geometry::compute_bvh(Device *device,
                            DeviceScene *dscene,
                            SceneParams *params,
                            Progress *progress,
+                           const string &bvh_disk_cache_path,
                            const size_t n,
                            const size_t total)
 {
@@ -61,7 +82,12 @@ void Geometry::compute_bvh(Device *device,
     vector<Object *> objects;
     objects.push_back(&object);
 
-    if (bvh && !need_update_rebuild && params->bvh_type == BVH_TYPE_DYNAMIC) {
+    /* Refit when the topology did not change. Final renders only refit BVH2 on request, since
+     * the BVH quality degrades with more deformation. */
+    const bool use_refit = params->bvh_type == BVH_TYPE_DYNAMIC ||
+                           (params->use_bvh_refit && bvh_layout == BVH_LAYOUT_BVH2);
+
+    if (bvh && !need_update_rebuild && use_refit) {
       progress->set_status(msg, "Refitting BVH");
 
       bvh->replace_geometry(geometry, objects);
@@ -82,6 +108,7 @@ void Geometry::compute_bvh(Device *device,
       bparams.num_motion_point_steps = params->num_bvh_time_steps;
       bparams.bvh_type = params->bvh_type;
       bparams.curve_subdivisions = params->curve_subdivisions();
+      bparams.disk_cache_path = bvh_disk_cache_path;
 
       bvh = BVH::create(bparams, geometry, objects, device);
       MEM_GUARDED_CALL(progress, device->build_bvh, bvh.get(), *progress, false);
@@ -115,15 +142,43 @@ void GeometryManager::device_update_bvh(Device *device,
 
   LOG_INFO << "Using " << bvh_layout_name(bparams.bvh_layout) << " layout.";
 
-  const bool can_refit = scene->bvh != nullptr && scene->params.bvh_type == BVH_TYPE_DYNAMIC &&
-                         (bparams.bvh_layout == BVHLayout::BVH_LAYOUT_OPTIX ||
-                          bparams.bvh_layout == BVHLayout::BVH_LAYOUT_METAL);
+  const bool has_bvh2_layout = (bparams.bvh_layout == BVH_LAYOUT_BVH2);
+
+  bool can_refit = scene->bvh != nullptr && scene->params.bvh_type == BVH_TYPE_DYNAMIC &&
+                   (bparams.bvh_layout == BVHLayout::BVH_LAYOUT_OPTIX ||
+                    bparams.bvh_layout == BVHLayout::BVH_LAYOUT_METAL);
 
   BVH *bvh = scene->bvh.get();
   if (bvh == nullptr) {
     scene->bvh = BVH::create(bparams, scene->geometry, scene->objects, device);
     bvh = scene->bvh.get();
   }
+  else if (has_bvh2_layout && bvh->params.bvh_layout == BVH_LAYOUT_BVH2 &&
+           scene->params.use_bvh_refit)
+  {
+    /* The BVH is reset when primitives are added or removed, so for deforming geometry and
+     * moving objects the top level nodes can be refit instead of rebuilt. */
+    BVH2 *bvh2 = static_cast<BVH2 *>(bvh);
+    if (bvh2->can_refit_top_level()) {
+      PackedBVH &pack = bvh2->pack;
+      const size_t num_prims = bvh2->num_top_level_prims;
+      const size_t num_prim_time = (dscene->prim_time.size()) ? num_prims : 0;
+
+      can_refit = copy_from_device_scene(
+                      pack.nodes, dscene->bvh_nodes, bvh2->num_top_level_nodes) &&
+                  copy_from_device_scene(
+                      pack.leaf_nodes, dscene->bvh_leaf_nodes, bvh2->num_top_level_leaf_nodes) &&
+                  copy_from_device_scene(pack.prim_type, dscene->prim_type, num_prims) &&
+                  copy_from_device_scene(pack.prim_index, dscene->prim_index, num_prims) &&
+                  copy_from_device_scene(pack.prim_object, dscene->prim_object, num_prims) &&
+                  copy_from_device_scene(pack.prim_time, dscene->prim_time, num_prim_time);
+      pack.root_index = dscene->data.bvh.root;
+
+      if (!can_refit) {
+        pack = PackedBVH();
+      }
+    }
+  }
 
   device->build_bvh(bvh, progress, can_refit);
 
@@ -131,8 +186,6 @@ void GeometryManager::device_update_bvh(Device *device,
     return;
   }
 
-  const bool has_bvh2_layout = (bparams.bvh_layout == BVH_LAYOUT_BVH2);
-
   PackedBVH pack;
   if (has_bvh2_layout) {
     pack = std::move(static_cast<BVH2 *>(bvh)->pack);
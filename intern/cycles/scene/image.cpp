@@ -219,6 +219,7 @@ ImageManager::ImageManager(const DeviceInfo & /*info*/, const SceneParams &param
   use_texture_cache = params.use_texture_cache;
   auto_texture_cache = params.auto_texture_cache;
   texture_cache_path = params.texture_cache_path;
+  image_cache.set_memory_limit(params.texture_cache_memory_limit);
 }
 
 ImageManager::~ImageManager()
@@ -758,7 +759,7 @@ void ImageManager::device_free(Scene *scene)
   scene->dscene.image_texture_udims.free();
 }
 
-void ImageManager::evict_unused(Device *device, Scene *scene)
+void ImageManager::evict_unused(Device *device, Scene *scene, const bool memory_limit_only)
 {
   if (!DebugFlags().texture_cache.use_eviction) {
     return;
@@ -777,16 +778,23 @@ void ImageManager::evict_unused(Device *device, Scene *scene)
   image_cache.evict_unused(*device,
                            dscene,
                            {dscene.image_textures.data(), dscene.image_textures.size()},
-                           tile_access.data());
+                           tile_access.data(),
+                           memory_limit_only);
 
   /* Reset access state on both host and device, so no more tiles are marked as used.
-   * Any tile not marked as used before the next eviction cycle will be evicted. */
+   * Any tile not marked as used before the next eviction cycle will be evicted. The image cache
+   * keeps tiles used before a memory limit only pass, so they still count for the next cycle. */
   memset(tile_access.data(), KERNEL_TILE_ACCESS_NONE, tile_access.size() * sizeof(uint8_t));
   tile_access.zero_to_device();
   tile_access.clear_modified();
   device_copy_image_textures(device, scene);
 }
 
+bool ImageManager::exceeds_memory_limit() const
+{
+  return DebugFlags().texture_cache.use_eviction && image_cache.exceeds_memory_limit();
+}
+
 void ImageManager::collect_statistics(RenderStats *stats, Scene *scene)
 {
   DeviceScene &dscene = scene->dscene;
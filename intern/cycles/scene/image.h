@@ -173,7 +173,10 @@ class ImageManager {
 
   bool set_animation_frame_update(const int frame);
 
-  void evict_unused(Device *device, Scene *scene);
+  /* Evict unused texture cache tiles. With memory_limit_only, only evict least recently used
+   * tiles to get below the memory limit. */
+  void evict_unused(Device *device, Scene *scene, const bool memory_limit_only = false);
+  bool exceeds_memory_limit() const;
 
   void collect_statistics(RenderStats *stats, Scene *scene);
 
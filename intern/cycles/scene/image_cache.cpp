@@ -116,6 +116,11 @@ void ImageCache::device_free(DeviceScene &dscene)
   dscene.image_texture_tile_descriptors.free();
   dscene.image_texture_tile_access_state.free();
 
+  pool_memory = 0;
+  tile_last_used.clear();
+  tile_used_since_eviction.clear();
+  eviction_cycle = 0;
+
   /* Reset eviction statistics. */
   stats.reset();
 }
@@ -402,6 +407,7 @@ device_image &ImageCache::alloc_tile(Device &device,
     tile_offset = 0;
 
     stats.add_tiled_bytes(img->memory_size());
+    pool_memory += img->memory_size();
 
     auto it_first_free = images_first_free.find(key);
     if (it_first_free == images_first_free.end()) {
@@ -471,6 +477,7 @@ void ImageCache::free_tile(const KernelTileDescriptor tile)
   if (img->occupancy == 0) {
     /* All tiles free, remove the device image entirely. */
     stats.remove_tiled_bytes(img->memory_size());
+    pool_memory -= img->memory_size();
     deferred_updates.erase(images[image_info_id]);
     deferred_gpu_updates.erase(images[image_info_id]);
     images.replace(image_info_id, nullptr);
@@ -541,6 +548,8 @@ void ImageCache::load_image_tiled(DeviceScene &dscene,
     }
 
     stats.resize(tile_descriptors.size());
+    tile_last_used.resize(tile_descriptors.size(), 0);
+    tile_used_since_eviction.resize(tile_descriptors.size(), 0);
 
     KernelTileDescriptor *descr_data = tile_descriptors.data() + tile_descriptor_offset;
 
@@ -613,6 +622,12 @@ KernelTileDescriptor ImageCache::load_tile(Device &device,
   }
 
   if (ok) {
+    {
+      /* Count a newly loaded tile as recently used, so it is not the first to be evicted. */
+      const thread_scoped_lock device_lock(device_mutex);
+      tile_last_used[bit_index] = eviction_cycle;
+    }
+
     /* Mark image for deferred GPU update, after pixels have been loaded to all devices. */
     if (!device.has_unified_image_memory()) {
       const thread_scoped_lock device_lock(device_mutex);
@@ -812,7 +827,8 @@ void ImageCache::collect_statistics(DeviceScene &dscene,
 void ImageCache::evict_unused(const Device &device,
                               DeviceScene &dscene,
                               std::span<KernelImageTexture> image_textures,
-                              const uint8_t *access_state)
+                              const uint8_t *access_state,
+                              const bool memory_limit_only)
 {
   device_vector<KernelTileDescriptor> &tile_descriptors = dscene.image_texture_tile_descriptors;
   if (tile_descriptors.size() == 0) {
@@ -825,6 +841,9 @@ void ImageCache::evict_unused(const Device &device,
   /* Hold the mutex for the entire eviction pass. */
   thread_scoped_lock device_lock(device_mutex);
 
+  /* Tiles used since the last eviction are marked with the new cycle. */
+  eviction_cycle++;
+
   /* Collect unused tiles. */
   struct UnusedTile {
     size_t global_idx;
@@ -842,6 +861,7 @@ void ImageCache::evict_unused(const Device &device,
     KernelTileDescriptor &descriptor = tile_descriptors[global_idx];
     free_tile(descriptor);
     descriptor = KERNEL_TILE_LOAD_NONE;
+    tile_used_since_eviction[global_idx] = 0;
     num_evicted++;
     stats.evict_tile(global_idx);
   };
@@ -860,6 +880,15 @@ void ImageCache::evict_unused(const Device &device,
         continue;
       }
       if (access_state[global_idx] & KERNEL_TILE_ACCESS_USED) {
+        tile_last_used[global_idx] = eviction_cycle;
+        tile_used_since_eviction[global_idx] = 1;
+      }
+      if (memory_limit_only) {
+        continue;
+      }
+      if (tile_used_since_eviction[global_idx]) {
+        /* Used since the last regular eviction, possibly before a memory limit pass. */
+        tile_used_since_eviction[global_idx] = 0;
         num_used++;
         continue;
       }
@@ -902,12 +931,87 @@ void ImageCache::evict_unused(const Device &device,
     }
   }
 
+  /* Evict least recently used tiles until memory usage is below the limit, including tiles
+   * that are still in use. Go somewhat below the limit so this does not happen again right
+   * away for every newly loaded tile. Memory of a tile pool is only freed once all its tiles
+   * are evicted, so whole pools are evicted. */
+  size_t num_over_limit = 0;
+  if (memory_limit > 0 && pool_memory > memory_limit) {
+    vector<vector<size_t>> pool_tiles(images.size());
+    vector<EvictionPool> pools(images.size(), {0, 0});
+    for (const KernelImageTexture &tex : image_textures) {
+      if (tex.tile_descriptor_offset == KERNEL_TILE_LOAD_NONE) {
+        continue;
+      }
+      const size_t base_offset = tex.tile_descriptor_offset + tex.tile_levels;
+      for (int i = 0; i < tex.tile_num; i++) {
+        const size_t global_idx = base_offset + i;
+        const KernelTileDescriptor descriptor = tile_descriptors[global_idx];
+        if (!kernel_tile_descriptor_loaded(descriptor)) {
+          continue;
+        }
+        const uint image_info_id = kernel_tile_descriptor_image_info_id(descriptor);
+        const DeviceImage *img = images[image_info_id];
+        if (!img) {
+          continue;
+        }
+        EvictionPool &pool = pools[image_info_id];
+        pool.memory = img->memory_size();
+        pool.last_used = std::max(pool.last_used, tile_last_used[global_idx]);
+        pool_tiles[image_info_id].push_back(global_idx);
+      }
+    }
+
+    const size_t target_memory = memory_limit - memory_limit / 8;
+    for (const size_t image_info_id : select_pools_to_evict(pools, pool_memory, target_memory)) {
+      for (const size_t global_idx : pool_tiles[image_info_id]) {
+        evict_tile(global_idx);
+        num_over_limit++;
+      }
+    }
+  }
+
   if (num_evicted > 0) {
     dscene.image_texture_tile_descriptors.tag_modified();
     LOG_DEBUG << "Texture cache tile eviction: " << num_evicted << " evicted, " << num_used
               << " used, " << num_preserved << " preserved (" << preserved_bytes / (1024 * 1024)
-              << " MB).";
+              << " MB), " << num_over_limit << " over memory limit.";
+  }
+}
+
+void ImageCache::set_memory_limit(const size_t limit)
+{
+  memory_limit = limit;
+}
+
+bool ImageCache::exceeds_memory_limit() const
+{
+  return memory_limit > 0 && pool_memory > memory_limit;
+}
+
+vector<size_t> ImageCache::select_pools_to_evict(const std::span<const EvictionPool> pools,
+                                                 size_t memory,
+                                                 const size_t target_memory)
+{
+  vector<size_t> order;
+  for (size_t i = 0; i < pools.size(); i++) {
+    if (pools[i].memory > 0) {
+      order.push_back(i);
+    }
+  }
+  std::stable_sort(order.begin(), order.end(), [&](const size_t a, const size_t b) {
+    return pools[a].last_used < pools[b].last_used;
+  });
+
+  vector<size_t> evict;
+  for (const size_t i : order) {
+    if (memory <= target_memory) {
+      break;
+    }
+    evict.push_back(i);
+    memory -= std::min(memory, pools[i].memory);
   }
+  return evict;
 }
 
 size_t ImageCache::memory_size(DeviceScene &dscene) const
@@ -11,6 +11,7 @@
 #include "util/set.h"
 #include "util/unique_ptr_vector.h"
 
+#include <atomic>
 #include <span>
 
 CCL_NAMESPACE_BEGIN
@@ -106,6 +107,22 @@ class ImageCache {
   unordered_set<device_image *> deferred_updates;
   unordered_set<device_image *> deferred_gpu_updates;
 
+  /* Memory limit for tiles in bytes, zero for no limit. */
+  size_t memory_limit = 0;
+
+  /* Memory of the allocated tile pools, including their unoccupied tiles. */
+  std::atomic<size_t> pool_memory = 0;
+
+  /* Eviction cycle in which each tile was last used, to evict least recently used tiles first
+   * when over the memory limit. Indexed the same as the tile descriptors. */
+  vector<uint32_t> tile_last_used;
+  uint32_t eviction_cycle = 0;
+
+  /* Tiles used since the last regular eviction, accumulated over eviction passes that only
+   * enforce the memory limit, so those passes can reset the access state without the regular
+   * pass seeing earlier used tiles as unused. Indexed the same as the tile descriptors. */
+  vector<uint8_t> tile_used_since_eviction;
+
  public:
   ImageCache();
   ~ImageCache();
@@ -160,10 +177,32 @@ class ImageCache {
     return stats;
   }
 
+  /* Evict tiles that were not used since the last eviction, and least recently used tiles
+   * beyond the memory limit. With memory_limit_only, only tiles beyond the memory limit are
+   * evicted. */
   void evict_unused(const Device &device,
                     DeviceScene &dscene,
                     std::span<KernelImageTexture> image_textures,
-                    const uint8_t *access_state);
+                    const uint8_t *access_state,
+                    const bool memory_limit_only = false);
+
+  /* Memory limit for tile pools, zero for no limit. */
+  void set_memory_limit(const size_t limit);
+  bool exceeds_memory_limit() const;
+
+  /* Tile pool considered for eviction when over the memory limit. */
+  struct EvictionPool {
+    /* Allocated memory, zero if there is no pool. */
+    size_t memory;
+    /* Most recent eviction cycle in which any of its tiles was used. */
+    uint32_t last_used;
+  };
+
+  /* Indices of the pools to evict to bring memory down to the target, least recently used
+   * first. */
+  static vector<size_t> select_pools_to_evict(const std::span<const EvictionPool> pools,
+                                              size_t memory,
+                                              const size_t target_memory);
 
   size_t memory_size(DeviceScene &dscene) const;
 
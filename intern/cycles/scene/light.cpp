@@ -493,6 +493,8 @@ LightManager::LightManager()
   last_background_resolution = 0;
 }
 
+LightManager::~LightManager() = default;
+
 bool LightManager::has_background_light(Scene *scene)
 {
   for (Object *object : scene->objects) {
@@ -759,6 +761,9 @@ struct LightTreeFlatten {
 
   /* Map from instance node to its node index. */
   std::unordered_map<LightTreeNode *, int> instances;
+
+  /* Instance and reference nodes modified for flattening the first instance of a mesh. */
+  vector<std::pair<LightTreeNode *, LightTreeNode *>> flattened_instances;
 };
 
 static void light_tree_node_copy_to_device(KernelLightTreeNode &knode,
@@ -856,6 +861,7 @@ static void light_tree_leaf_emitters_copy_and_flatten(LightTreeFlatten &flatten,
           std::swap(instance_node->variant_type, reference_node->variant_type);
         }
         instance_node->type &= ~LIGHT_TREE_INSTANCE;
+        flatten.flattened_instances.emplace_back(instance_node, reference_node);
       }
 
       kemitter.mesh.node_id = light_tree_flatten(
@@ -937,6 +943,23 @@ static void light_tree_emitters_copy_and_flatten(LightTreeFlatten &flatten,
   }
 }
 
+/* Undo the modifications of instance nodes, so the tree can be updated and flattened again. */
+static void light_tree_flatten_restore_instances(LightTreeFlatten &flatten)
+{
+  for (auto it = flatten.flattened_instances.rbegin(); it != flatten.flattened_instances.rend();
+       ++it)
+  {
+    LightTreeNode *instance_node = it->first;
+    LightTreeNode *reference_node = it->second;
+
+    instance_node->type |= LIGHT_TREE_INSTANCE;
+    if (instance_node != reference_node) {
+      std::swap(instance_node->type, reference_node->type);
+      std::swap(instance_node->variant_type, reference_node->variant_type);
+    }
+  }
+}
+
 static std::pair<int, LightTreeMeasure> light_tree_specialize_nodes_flatten(
     const LightTreeFlatten &flatten,
     LightTreeNode *node,
@@ -1059,48 +1082,61 @@ void LightManager::device_update_tree(Device * /*unused*/,
   KernelIntegrator *kintegrator = &dscene->data.integrator;
 
   if (!kintegrator->use_light_tree) {
+    light_tree.reset();
     return;
   }
 
   /* Update light tree. */
   progress.set_status("Updating Lights", "Computing tree");
 
-  /* TODO: For now, we'll start with a smaller number of max lights in a node.
-   * More benchmarking is needed to determine what number works best. */
-  LightTree light_tree(scene, dscene, progress, 8);
-  LightTreeNode *root = light_tree.build(scene, dscene);
+  /* Keep the structure of the previous tree when only light strengths and transforms changed,
+   * or emissive meshes moved. The tree checks that the emitters are still the same. */
+  const bool can_update_tree = light_tree && (update_flags & (MESH_NEED_REBUILD | LIGHT_ADDED |
+                                                             LIGHT_REMOVED)) == 0;
+
+  LightTreeNode *root;
+  if (can_update_tree && light_tree->update(scene, dscene)) {
+    root = light_tree->get_root();
+  }
+  else {
+    /* TODO: For now, we'll start with a smaller number of max lights in a node.
+     * More benchmarking is needed to determine what number works best. */
+    light_tree = make_unique<LightTree>(scene, dscene, progress, 8);
+    root = light_tree->build(scene, dscene);
+  }
   if (progress.get_cancel()) {
+    light_tree.reset();
     return;
   }
 
   /* Create arguments for recursive tree flatten. */
   LightTreeFlatten flatten;
   flatten.scene = scene;
-  flatten.emitters = light_tree.get_emitters();
+  flatten.emitters = light_tree->get_emitters();
   flatten.object_lookup_offset = dscene->object_lookup_offset.data();
   /* We want to create separate arrays corresponding to triangles and lights,
    * which will be used to index back into the light tree for PDF calculations. */
   flatten.light_array = dscene->light_to_tree.alloc(scene->objects.size());
-  flatten.triangle_array = dscene->triangle_to_tree.alloc(light_tree.num_triangles);
+  flatten.triangle_array = dscene->triangle_to_tree.alloc(light_tree->num_triangles);
 
   /* Allocate emitters */
-  const size_t num_emitters = light_tree.num_emitters();
+  const size_t num_emitters = light_tree->num_emitters();
   KernelLightTreeEmitter *kemitters = dscene->light_tree_emitters.alloc(num_emitters);
 
   /* Update integrator state. */
   kintegrator->use_direct_light = num_emitters > 0;
 
   /* Test if light linking is used. */
-  const bool use_light_linking = root && (light_tree.light_link_receiver_used != 1);
+  const bool use_light_linking = root && (light_tree->light_link_receiver_used != 1);
   KernelLightLinkSet *klight_link_sets = dscene->data.light_link_sets;
   memset(klight_link_sets, 0, sizeof(dscene->data.light_link_sets));
 
-  LOG_INFO << "Use light tree with " << num_emitters << " emitters and " << light_tree.num_nodes
+  LOG_INFO << "Use light tree with " << num_emitters << " emitters and " << light_tree->num_nodes
            << " nodes.";
 
   if (!use_light_linking) {
     /* Regular light tree without linking. */
-    KernelLightTreeNode *knodes = dscene->light_tree_nodes.alloc(light_tree.num_nodes);
+    KernelLightTreeNode *knodes = dscene->light_tree_nodes.alloc(light_tree->num_nodes);
 
     if (root) {
       int next_node_index = 0;
@@ -1116,7 +1152,7 @@ void LightManager::device_update_tree(Device * /*unused*/,
     if (root) {
       /* Reserve enough size of all instance subtrees, then shrink back to
        * actual number of nodes used. */
-      light_link_nodes.resize(light_tree.num_nodes);
+      light_link_nodes.resize(light_tree->num_nodes);
       light_tree_emitters_copy_and_flatten(
           flatten, root, light_link_nodes.data(), kemitters, next_node_index);
       light_link_nodes.resize(next_node_index);
@@ -1125,7 +1161,7 @@ void LightManager::device_update_tree(Device * /*unused*/,
     /* Specialized light trees for linking. */
     for (uint64_t tree_index = 0; tree_index < LIGHT_LINK_SET_MAX; tree_index++) {
       const uint64_t tree_mask = uint64_t(1) << tree_index;
-      if (!(light_tree.light_link_receiver_used & tree_mask)) {
+      if (!(light_tree->light_link_receiver_used & tree_mask)) {
         continue;
       }
 
@@ -1142,15 +1178,22 @@ void LightManager::device_update_tree(Device * /*unused*/,
     memcpy(knodes, light_link_nodes.data(), light_link_nodes.size() * sizeof(*knodes));
 
     LOG_INFO << "Specialized light tree for light linking, with "
-             << light_link_nodes.size() - light_tree.num_nodes << " additional nodes.";
+             << light_link_nodes.size() - light_tree->num_nodes << " additional nodes.";
   }
 
+  light_tree_flatten_restore_instances(flatten);
+
   /* Copy arrays to device. */
   dscene->light_tree_nodes.copy_to_device();
   dscene->light_tree_emitters.copy_to_device();
   dscene->light_to_tree.copy_to_device();
   dscene->object_lookup_offset.copy_to_device();
   dscene->triangle_to_tree.copy_to_device();
+
+  /* A final render without persistent data never updates the scene again, so free the tree. */
+  if (scene->params.background && !scene->params.use_persistent_data) {
+    light_tree.reset();
+  }
 }
 
 static void background_cdf(int start,
@@ -1468,7 +1511,9 @@ void LightManager::device_update(Device *device,
   /* Detect which lights are enabled, also determines if we need to update the background. */
   test_enabled_lights(scene);
 
-  device_free(device, dscene, need_update_background);
+  /* Keep the light tree, so it can be refit. */
+  const bool free_light_tree = false;
+  device_free(device, dscene, need_update_background, free_light_tree);
 
   device_update_lights(dscene, scene);
   if (progress.get_cancel()) {
@@ -1503,7 +1548,8 @@ void LightManager::device_update(Device *device,
 
 void LightManager::device_free(Device * /*unused*/,
                                DeviceScene *dscene,
-                               const bool free_background)
+                               const bool free_background,
+                               const bool free_light_tree)
 {
   dscene->light_tree_nodes.free();
   dscene->light_tree_emitters.free();
@@ -1518,6 +1564,10 @@ void LightManager::device_free(Device * /*unused*/,
     dscene->light_background_conditional_cdf.free();
   }
   dscene->ies_lights.free();
+
+  if (free_light_tree) {
+    light_tree.reset();
+  }
 }
 
 void LightManager::tag_update(Scene * /*scene*/, uint32_t flag)
@@ -20,6 +20,7 @@ CCL_NAMESPACE_BEGIN
 
 class Device;
 class DeviceScene;
+class LightTree;
 class Object;
 class Progress;
 class Scene;
@@ -205,6 +206,7 @@ class LightManager {
   bool need_update_background;
 
   LightManager();
+  ~LightManager();
 
   /* IES texture management */
   int add_ies(const string &content, const bool log_parsing_error);
@@ -212,7 +214,10 @@ class LightManager {
   void remove_ies(const int slot);
 
   void device_update(Device *device, DeviceScene *dscene, Scene *scene, Progress &progress);
-  void device_free(Device *device, DeviceScene *dscene, const bool free_background = true);
+  void device_free(Device *device,
+                   DeviceScene *dscene,
+                   const bool free_background = true,
+                   const bool free_light_tree = true);
 
   void tag_update(Scene *scene, const uint32_t flag);
 
@@ -254,6 +259,10 @@ class LightManager {
   bool last_background_enabled;
   int last_background_resolution;
 
+  /* Light tree of the previous update, reused when the emitters did not change. Only kept for
+   * interactive renders and persistent data. */
+  unique_ptr<LightTree> light_tree;
+
   uint32_t update_flags;
 };
 
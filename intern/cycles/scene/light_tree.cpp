@@ -268,10 +268,45 @@ bool LightTree::triangle_usable_as_light(Mesh *mesh, const int prim_id)
 
 void LightTree::add_mesh(Scene *scene, Mesh *mesh, const int object_id)
 {
+  /* Find the emissive triangles first, so the emitters can be created in parallel. */
+  vector<int> prim_ids;
   const size_t mesh_num_triangles = mesh->num_triangles();
   for (size_t i = 0; i < mesh_num_triangles; i++) {
     if (triangle_usable_as_light(mesh, i)) {
-      emitters_.emplace_back(scene, i, object_id);
+      prim_ids.push_back(i);
+    }
+  }
+
+  const size_t start = emitters_.size();
+  emitters_.resize(start + prim_ids.size());
+
+  parallel_for(blocked_range<size_t>(0, prim_ids.size(), 1024),
+               [&](const blocked_range<size_t> &r) {
+                 for (size_t i = r.begin(); i != r.end(); i++) {
+                   emitters_[start + i] = LightTreeEmitter(scene, prim_ids[i], object_id);
+                 }
+               });
+}
+
+void LightTree::transform_mesh_measure(Scene *scene, LightTreeEmitter &emitter)
+{
+  Object *object = scene->objects[emitter.object_id];
+  Mesh *mesh = static_cast<Mesh *>(object->get_geometry());
+
+  /* Transform measure. The measure is only directly transformable if the transformation has
+   * uniform scaling, otherwise recount all the triangles in the mesh with transformation. */
+  /* NOTE: in theory only energy needs recalculating: #bbox is available via `object->bounds`,
+   * transformation of #bcone is possible. However, the computation involves eigendecomposition
+   * and solving a cubic equation (https://doi.org/10.1016/j.nima.2009.11.075 section 3.4), then
+   * the angle is derived from the major axis of the resulted right elliptic cone's base, which
+   * can be an overestimation. */
+  if (!mesh->transform_applied && !emitter.measure.transform(object->get_tfm())) {
+    emitter.measure.reset();
+    size_t const mesh_num_triangles = mesh->num_triangles();
+    for (size_t i = 0; i < mesh_num_triangles; i++) {
+      if (triangle_usable_as_light(mesh, i)) {
+        emitter.measure.add(LightTreeEmitter(scene, i, emitter.object_id, true).measure);
+      }
     }
   }
 }
@@ -291,6 +326,8 @@ LightTree::LightTree(Scene *scene,
    * Therefore, we want to keep track of the light's index on the device.
    * However, we also need the light's index in the scene when we're constructing the tree. */
   int device_light_index = 0;
+  emitter_geometry_.resize(scene->objects.size(), nullptr);
+  emitter_is_distant_.resize(scene->objects.size(), false);
   for (Object *object : scene->objects) {
     if (progress_.get_cancel()) {
       return;
@@ -300,7 +337,10 @@ LightTree::LightTree(Scene *scene,
       /* Regular lights. */
       Light *light = static_cast<Light *>(object->get_geometry());
       if (light->is_enabled) {
+        emitter_geometry_[object->index] = light;
+
         if (light->is_distant_light()) {
+          emitter_is_distant_[object->index] = true;
           distant_lights_.emplace_back(scene, ~device_light_index, object->index);
         }
         else {
@@ -318,6 +358,7 @@ LightTree::LightTree(Scene *scene,
         continue;
       }
 
+      emitter_geometry_[object->index] = object->get_geometry();
       mesh_lights_.emplace_back(object, object->index);
 
       /* Only count unique meshes. */
@@ -340,6 +381,7 @@ LightTreeNode *LightTree::build(Scene *scene, DeviceScene *dscene)
   const int num_mesh_lights = mesh_lights_.size();
   int num_local_lights = local_lights_.size() + num_mesh_lights;
   const int num_distant_lights = distant_lights_.size();
+  num_distant_lights_ = num_distant_lights;
 
   /* Create a node for each mesh light, and keep track of unique mesh lights. */
   std::unordered_map<Mesh *, std::tuple<LightTreeNode *, int, int>> unique_mesh;
@@ -357,6 +399,7 @@ LightTreeNode *LightTree::build(Scene *scene, DeviceScene *dscene)
       const int end = emitters_.size();
 
       unique_mesh[mesh] = std::make_tuple(emitter.root.get(), start, end);
+      mesh_subtrees_.push_back({mesh, emitter.root.get(), start, end, mesh->num_triangles()});
       emitter.root->object_id = emitter.object_id;
     }
     else {
@@ -382,23 +425,7 @@ LightTreeNode *LightTree::build(Scene *scene, DeviceScene *dscene)
 
     LightTreeNode *reference = std::get<0>(unique_mesh.find(mesh)->second);
     emitter.measure = emitter.root->measure = reference->measure;
-
-    /* Transform measure. The measure is only directly transformable if the transformation has
-     * uniform scaling, otherwise recount all the triangles in the mesh with transformation. */
-    /* NOTE: in theory only energy needs recalculating: #bbox is available via `object->bounds`,
-     * transformation of #bcone is possible. However, the computation involves eigendecomposition
-     * and solving a cubic equation (https://doi.org/10.1016/j.nima.2009.11.075 section 3.4), then
-     * the angle is derived from the major axis of the resulted right elliptic cone's base, which
-     * can be an overestimation. */
-    if (!mesh->transform_applied && !emitter.measure.transform(object->get_tfm())) {
-      emitter.measure.reset();
-      size_t const mesh_num_triangles = mesh->num_triangles();
-      for (size_t i = 0; i < mesh_num_triangles; i++) {
-        if (triangle_usable_as_light(mesh, i)) {
-          emitter.measure.add(LightTreeEmitter(scene, i, emitter.object_id, true).measure);
-        }
-      }
-    }
+    transform_mesh_measure(scene, emitter);
   });
 
   for (LightTreeEmitter &emitter : mesh_lights_) {
@@ -448,6 +475,169 @@ LightTreeNode *LightTree::build(Scene *scene, DeviceScene *dscene)
   return root_.get();
 }
 
+bool LightTree::update(Scene *scene, DeviceScene *dscene)
+{
+  if (!root_ || emitter_geometry_.size() != scene->objects.size()) {
+    return false;
+  }
+
+  /* The same objects must be emitters, so that light indices and mesh subtrees still match.
+   * Lights must also stay distant or local, since the distant lights are a separate leaf. */
+  light_link_receiver_used = 1;
+  int num_distant_lights = 0;
+  for (Object *object : scene->objects) {
+    Geometry *geom = object->get_geometry();
+    const Geometry *emitter_geom = nullptr;
+
+    if (geom->is_light()) {
+      const Light *light = static_cast<Light *>(geom);
+      if (light->is_enabled) {
+        emitter_geom = geom;
+        if (light->is_distant_light() != emitter_is_distant_[object->index]) {
+          return false;
+        }
+        if (light->is_distant_light()) {
+          num_distant_lights++;
+        }
+      }
+    }
+    else {
+      light_link_receiver_used |= (uint64_t(1) << object->get_receiver_light_set());
+      if (object->usable_as_light()) {
+        emitter_geom = geom;
+      }
+    }
+
+    if (emitter_geometry_[object->index] != emitter_geom) {
+      return false;
+    }
+  }
+
+  if (num_distant_lights != num_distant_lights_) {
+    return false;
+  }
+
+  /* The same triangles must be emissive. */
+  std::atomic<bool> emitters_changed = false;
+  parallel_for_each(mesh_subtrees_, [&](const MeshSubtree &subtree) {
+    if (subtree.mesh->num_triangles() != subtree.num_triangles) {
+      emitters_changed = true;
+      return;
+    }
+
+    int num_emissive_triangles = 0;
+    for (size_t i = 0; i < subtree.num_triangles; i++) {
+      if (triangle_usable_as_light(subtree.mesh, i)) {
+        num_emissive_triangles++;
+      }
+    }
+    if (num_emissive_triangles != subtree.end - subtree.start) {
+      emitters_changed = true;
+    }
+  });
+
+  if (emitters_changed) {
+    return false;
+  }
+
+  /* Recompute triangle and light emitters. Light set membership must not change, since leaf
+   * nodes are sorted by it. */
+  parallel_for(blocked_range<size_t>(0, emitters_.size(), 1024),
+               [&](const blocked_range<size_t> &r) {
+                 for (size_t i = r.begin(); i != r.end(); i++) {
+                   LightTreeEmitter &emitter = emitters_[i];
+                   Object *object = scene->objects[emitter.object_id];
+
+                   if (emitter.is_mesh()) {
+                     const LightTreeEmitter mesh_emitter(object, emitter.object_id);
+                     if (mesh_emitter.light_set_membership != emitter.light_set_membership) {
+                       emitters_changed = true;
+                     }
+                     emitter.centroid = mesh_emitter.centroid;
+                     continue;
+                   }
+
+                   if (emitter.is_triangle() &&
+                       !triangle_usable_as_light(static_cast<Mesh *>(object->get_geometry()),
+                                                 emitter.prim_id))
+                   {
+                     emitters_changed = true;
+                     continue;
+                   }
+
+                   const LightTreeEmitter new_emitter(scene, emitter.prim_id, emitter.object_id);
+                   if (new_emitter.light_set_membership != emitter.light_set_membership) {
+                     emitters_changed = true;
+                   }
+                   emitter.centroid = new_emitter.centroid;
+                   emitter.measure = new_emitter.measure;
+                 }
+               });
+
+  if (emitters_changed) {
+    return false;
+  }
+
+  /* Refit the subtree of every unique mesh in object space. The map is filled beforehand, so
+   * it is not modified while writing the measures in parallel. */
+  std::unordered_map<Mesh *, LightTreeMeasure> mesh_measures;
+  for (const MeshSubtree &subtree : mesh_subtrees_) {
+    mesh_measures[subtree.mesh] = LightTreeMeasure::empty;
+  }
+  parallel_for_each(mesh_subtrees_, [&](const MeshSubtree &subtree) {
+    mesh_measures.at(subtree.mesh) = refit_node(subtree.root);
+  });
+
+  /* Update mesh emitters from the measure of their mesh. */
+  uint *object_offsets = dscene->object_lookup_offset.alloc(scene->objects.size());
+  parallel_for(blocked_range<size_t>(0, emitters_.size(), 64),
+               [&](const blocked_range<size_t> &r) {
+                 for (size_t i = r.begin(); i != r.end(); i++) {
+                   LightTreeEmitter &emitter = emitters_[i];
+                   if (!emitter.is_mesh()) {
+                     continue;
+                   }
+
+                   Object *object = scene->objects[emitter.object_id];
+                   Mesh *mesh = static_cast<Mesh *>(object->get_geometry());
+
+                   emitter.measure = mesh_measures.at(mesh);
+                   transform_mesh_measure(scene, emitter);
+                   emitter.root->measure = emitter.measure;
+
+                   object_offsets[emitter.object_id] = offset_map_.at(mesh);
+                 }
+               });
+
+  /* Refit the top level tree. */
+  root_->measure = refit_node(root_.get());
+
+  return !progress_.get_cancel();
+}
+
+LightTreeMeasure LightTree::refit_node(LightTreeNode *node)
+{
+  /* Subtrees shared between specialized light linking trees are found again when flattening. */
+  node->light_link.shared_node_index = -1;
+
+  LightTreeMeasure measure = LightTreeMeasure::empty;
+  if (node->is_leaf() || node->is_distant()) {
+    const LightTreeNode::Leaf &leaf = node->get_leaf();
+    for (int i = 0; i < leaf.num_emitters; i++) {
+      measure.add(emitters_[leaf.first_emitter_index + i].measure);
+    }
+  }
+  else {
+    assert(node->is_inner());
+    for (unique_ptr<LightTreeNode> &child : node->get_inner().children) {
+      child->measure = refit_node(child.get());
+      measure.add(child->measure);
+    }
+  }
+
+  return measure;
+}
+
 void LightTree::recursive_build(const Child child,
                                 LightTreeNode *inner,
                                 const int start,
@@ -512,6 +702,43 @@ void LightTree::recursive_build(const Child child,
   }
 }
 
+using LightTreeBuckets = std::array<std::array<LightTreeBucket, LightTreeBucket::num_buckets>, 3>;
+
+/* Place emitters into the buckets of every dimension, where the centroid box is split into
+ * equal partitions. Along dimensions where the centroid box is flat, everything is in the first
+ * bucket. */
+static void fill_buckets(const LightTreeEmitter *emitters,
+                         const int start,
+                         const int end,
+                         const BoundBox &centroid_bbox,
+                         LightTreeBuckets &dim_buckets)
+{
+  for (int dim = 0; dim < 3; dim++) {
+    std::array<LightTreeBucket, LightTreeBucket::num_buckets> &buckets = dim_buckets[dim];
+
+    if (centroid_bbox.size()[dim] == 0.0f) {
+      /* Only the first dimension is used to compute the node measure in that case. */
+      if (dim == 0) {
+        for (int i = start; i < end; i++) {
+          buckets[0].add(emitters[i]);
+        }
+      }
+      continue;
+    }
+
+    const float inv_extent = 1 / (centroid_bbox.size()[dim]);
+    for (int i = start; i < end; i++) {
+      const LightTreeEmitter *emitter = emitters + i;
+
+      int bucket_idx = LightTreeBucket::num_buckets *
+                       (emitter->centroid[dim] - centroid_bbox.min[dim]) * inv_extent;
+      bucket_idx = clamp(bucket_idx, 0, LightTreeBucket::num_buckets - 1);
+
+      buckets[bucket_idx].add(*emitter);
+    }
+  }
+}
+
 bool LightTree::should_split(LightTreeEmitter *emitters,
                              const int start,
                              int &middle,
@@ -532,9 +759,46 @@ bool LightTree::should_split(LightTreeEmitter *emitters,
 
   middle = (start + end) / 2;
 
+  /* Compute the centroid bounds and fill in buckets, in chunks of emitters for large nodes. Chunks
+   * are fixed size so the result does not depend on the number of threads. */
   BoundBox centroid_bbox = BoundBox::empty;
-  for (int i = start; i < end; i++) {
-    centroid_bbox.grow((emitters + i)->centroid);
+  LightTreeBuckets dim_buckets;
+
+  if (num_emitters >= MIN_EMITTERS_PARALLEL_SPLIT) {
+    const int num_chunks = divide_up(num_emitters, MIN_EMITTERS_PER_THREAD);
+    auto chunk_start = [&](const int chunk) { return start + chunk * MIN_EMITTERS_PER_THREAD; };
+    auto chunk_end = [&](const int chunk) {
+      return min(start + (chunk + 1) * MIN_EMITTERS_PER_THREAD, end);
+    };
+
+    vector<BoundBox> chunk_centroid_bbox(num_chunks, BoundBox::empty);
+    parallel_for(0, num_chunks, [&](const int chunk) {
+      for (int i = chunk_start(chunk); i < chunk_end(chunk); i++) {
+        chunk_centroid_bbox[chunk].grow((emitters + i)->centroid);
+      }
+    });
+    for (const BoundBox &bbox : chunk_centroid_bbox) {
+      centroid_bbox.grow(bbox);
+    }
+
+    vector<LightTreeBuckets> chunk_buckets(num_chunks);
+    parallel_for(0, num_chunks, [&](const int chunk) {
+      fill_buckets(
+          emitters, chunk_start(chunk), chunk_end(chunk), centroid_bbox, chunk_buckets[chunk]);
+    });
+    for (const LightTreeBuckets &buckets : chunk_buckets) {
+      for (int dim = 0; dim < 3; dim++) {
+        for (int i = 0; i < LightTreeBucket::num_buckets; i++) {
+          dim_buckets[dim][i] = dim_buckets[dim][i] + buckets[dim][i];
+        }
+      }
+    }
+  }
+  else {
+    for (int i = start; i < end; i++) {
+      centroid_bbox.grow((emitters + i)->centroid);
+    }
+    fill_buckets(emitters, start, end, centroid_bbox, dim_buckets);
   }
 
   const float3 extent = centroid_bbox.size();
@@ -544,7 +808,7 @@ bool LightTree::should_split(LightTreeEmitter *emitters,
   float total_cost = 0.0f;
   float min_cost = FLT_MAX;
   for (int dim = 0; dim < 3; dim++) {
-    std::array<LightTreeBucket, LightTreeBucket::num_buckets> buckets;
+    const std::array<LightTreeBucket, LightTreeBucket::num_buckets> &buckets = dim_buckets[dim];
     float inv_extent;
 
     if (centroid_bbox.size()[dim] == 0.0f) {
@@ -556,24 +820,9 @@ bool LightTree::should_split(LightTreeEmitter *emitters,
 
       /* Degenerate case, everything in the same bucket. */
       inv_extent = FLT_MAX;
-      for (int i = start; i < end; i++) {
-        buckets[0].add(emitters[i]);
-      }
     }
     else {
-      /* Fill in buckets with emitters. */
       inv_extent = 1 / (centroid_bbox.size()[dim]);
-      for (int i = start; i < end; i++) {
-        const LightTreeEmitter *emitter = emitters + i;
-
-        /* Place emitter into the appropriate bucket, where the centroid box is split into equal
-         * partitions. */
-        int bucket_idx = LightTreeBucket::num_buckets *
-                         (emitter->centroid[dim] - centroid_bbox.min[dim]) * inv_extent;
-        bucket_idx = clamp(bucket_idx, 0, LightTreeBucket::num_buckets - 1);
-
-        buckets[bucket_idx].add(*emitter);
-      }
     }
 
     /* Precompute the left bucket measure cumulatively. */
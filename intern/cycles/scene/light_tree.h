@@ -194,6 +194,8 @@ struct LightTreeEmitter {
 
   LightTreeMeasure measure;
 
+  /* Uninitialized, to allocate emitters before constructing them in parallel. */
+  LightTreeEmitter() = default;
   LightTreeEmitter(Object *object, const int object_id); /* Mesh emitter. */
   LightTreeEmitter(Scene *scene,
                    const int prim_id,
@@ -392,6 +394,23 @@ class LightTree {
 
   std::unordered_map<Mesh *, int> offset_map_;
 
+  /* Subtree and range of triangle emitters of every unique mesh. */
+  struct MeshSubtree {
+    Mesh *mesh;
+    LightTreeNode *root;
+    int start;
+    int end;
+    size_t num_triangles;
+  };
+  vector<MeshSubtree> mesh_subtrees_;
+
+  /* Geometry of objects that are emitters, indexed by object. Null for other objects. */
+  vector<const Geometry *> emitter_geometry_;
+  /* Whether the light of an object is distant, indexed by object. Distant and local lights are
+   * in different subtrees, so the tree can only be refit if this did not change. */
+  vector<bool> emitter_is_distant_;
+  int num_distant_lights_ = 0;
+
   Progress &progress_;
 
   uint max_lights_in_leaf_;
@@ -415,6 +434,16 @@ class LightTree {
   /* Returns a pointer to the root node. */
   LightTreeNode *build(Scene *scene, DeviceScene *dscene);
 
+  /* Update the measures of emitters and nodes of a built tree, keeping its structure. This is
+   * possible when light strengths, transforms or emissive mesh positions changed, but not the
+   * emitters themselves. Returns false if the tree must be rebuilt instead. */
+  bool update(Scene *scene, DeviceScene *dscene);
+
+  LightTreeNode *get_root() const
+  {
+    return root_.get();
+  }
+
   /* NOTE: Always use this function to create a new node so the number of nodes is in sync. */
   unique_ptr<LightTreeNode> create_node(const LightTreeMeasure &measure, const uint &bit_trial)
   {
@@ -437,6 +466,8 @@ class LightTree {
   TaskPool task_pool;
   /* Do not spawn a thread if less than this amount of emitters are to be processed. */
   enum { MIN_EMITTERS_PER_THREAD = 4096 };
+  /* Fill the buckets of nodes with at least this amount of emitters in parallel. */
+  enum { MIN_EMITTERS_PARALLEL_SPLIT = 65536 };
 
   void recursive_build(Child child,
                        LightTreeNode *inner,
@@ -459,6 +490,13 @@ class LightTree {
 
   /* Add all the emissive triangles of a mesh to the light tree. */
   void add_mesh(Scene *scene, Mesh *mesh, const int object_id);
+
+  /* Transform the measure of a mesh emitter from object space. */
+  void transform_mesh_measure(Scene *scene, LightTreeEmitter &emitter);
+
+  /* Recompute the measures of the descendants of a node from the emitters, and return the
+   * measure of the node itself. */
+  LightTreeMeasure refit_node(LightTreeNode *node);
 };
 
 CCL_NAMESPACE_END
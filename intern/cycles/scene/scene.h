@@ -81,14 +81,25 @@ class SceneParams {
   float texture_resolution;
   int texture_limit;
 
+  /* Reuse BVHs of unchanged geometry across render sessions through the disk cache. */
+  bool use_bvh_disk_cache = false;
+  /* Maximum size in bytes of the BVH disk cache, zero for no limit. */
+  size_t bvh_disk_cache_size_limit = 0;
+  /* Refit BVH2 instead of rebuilding it when geometry deforms without topology changes. */
+  bool use_bvh_refit = false;
+
   /* Use tx files if they exist. */
   bool use_texture_cache = true;
   /* Auto generate tx files. */
   bool auto_texture_cache = false;
   /* Relative (to the image file) or absolute directory for auto generating tx files. */
   std::string texture_cache_path;
+  /* Maximum memory in bytes for texture cache tiles, zero for no limit. */
+  size_t texture_cache_memory_limit = 0;
 
   bool background;
+  /* Keep render data between final renders, so it can be updated for the next frame. */
+  bool use_persistent_data = false;
 
   SceneParams()
   {
@@ -116,9 +127,14 @@ class SceneParams {
         num_bvh_time_steps == params.num_bvh_time_steps &&
         hair_subdivisions == params.hair_subdivisions && hair_shape == params.hair_shape &&
         texture_resolution == params.texture_resolution && texture_limit == params.texture_limit &&
+        use_bvh_disk_cache == params.use_bvh_disk_cache &&
+        bvh_disk_cache_size_limit == params.bvh_disk_cache_size_limit &&
+        use_bvh_refit == params.use_bvh_refit &&
         use_texture_cache == params.use_texture_cache &&
         auto_texture_cache == params.auto_texture_cache &&
-        texture_cache_path == params.texture_cache_path);
+        texture_cache_path == params.texture_cache_path &&
+        texture_cache_memory_limit == params.texture_cache_memory_limit &&
+        use_persistent_data == params.use_persistent_data);
   }
 
   int curve_subdivisions()
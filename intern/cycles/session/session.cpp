@@ -378,6 +378,11 @@ RenderWork Session::run_update_for_next_iteration()
   if (eviction_manager_.need_eviction(!render_work, switched_to_new_tile)) {
     scene->image_manager->evict_unused(device.get(), scene.get());
   }
+  else if (scene->image_manager->exceeds_memory_limit()) {
+    /* Tiles loaded on demand went over the memory limit since the last eviction. */
+    const bool memory_limit_only = true;
+    scene->image_manager->evict_unused(device.get(), scene.get(), memory_limit_only);
+  }
 
   if (render_work) {
     const scoped_timer update_timer;
@@ -0,0 +1,211 @@
+/* SPDX-FileCopyrightText: 2026 Blender Foundation
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include <gtest/gtest.h>
+
+#include "bvh/bvh2.h"
+#include "bvh/params.h"
+
+#include "scene/mesh.h"
+#include "scene/object.h"
+
+#include "util/progress.h"
+#include "util/task.h"
+#include "util/vector.h"
+
+#include "scene_mesh_test.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+/* Object with a mesh whose triangles are added to the top level BVH. */
+struct TestObject {
+  Mesh mesh;
+  Object object;
+
+  TestObject(const int resolution, const float x_offset, const uint seed)
+  {
+    create_grid_mesh(mesh, resolution, x_offset, seed);
+    mesh.transform_applied = true;
+    object.set_geometry(&mesh);
+    object.compute_bounds(false);
+  }
+};
+
+template<typename T> void expect_arrays_equal(const array<T> &a, const array<T> &b)
+{
+  ASSERT_EQ(a.size(), b.size());
+  EXPECT_EQ(memcmp(a.data(), b.data(), a.size() * sizeof(T)), 0);
+}
+
+void expect_bounds_equal(const BoundBox &a, const BoundBox &b)
+{
+  EXPECT_EQ(a.min.x, b.min.x);
+  EXPECT_EQ(a.min.y, b.min.y);
+  EXPECT_EQ(a.min.z, b.min.z);
+  EXPECT_EQ(a.max.x, b.max.x);
+  EXPECT_EQ(a.max.y, b.max.y);
+  EXPECT_EQ(a.max.z, b.max.z);
+}
+
+BoundBox child_bounds(const int4 *node, const int child)
+{
+  const float *data = reinterpret_cast<const float *>(node + 1);
+  BoundBox bounds = BoundBox::empty;
+  bounds.min = make_float3(data[child], data[4 + child], data[8 + child]);
+  bounds.max = make_float3(data[2 + child], data[6 + child], data[10 + child]);
+  return bounds;
+}
+
+/* Exact bounds and visibility of the primitives in a subtree. */
+void subtree_primitives(const BVH2 &bvh,
+                        const vector<Object *> &objects,
+                        const int idx,
+                        const bool leaf,
+                        BoundBox &r_bounds,
+                        uint &r_visibility)
+{
+  const PackedBVH &pack = bvh.pack;
+  if (leaf) {
+    const int4 data = pack.leaf_nodes[idx];
+    for (int prim = data.x; prim < data.y; prim++) {
+      const Object *ob = objects[pack.prim_object[prim]];
+      const Mesh *mesh = static_cast<const Mesh *>(ob->get_geometry());
+      const int pidx = pack.prim_index[prim];
+      const int prim_offset = bvh.params.top_level ? mesh->prim_offset : 0;
+      mesh->get_triangle(pidx - prim_offset).bounds_grow(mesh->get_position(), r_bounds);
+      r_visibility |= ob->visibility_for_tracing();
+    }
+    return;
+  }
+
+  const int4 *node = &pack.nodes[idx];
+  for (int child = 0; child < 2; child++) {
+    const int c = (child == 0) ? node[0].z : node[0].w;
+    subtree_primitives(bvh, objects, (c < 0) ? -c - 1 : c, c < 0, r_bounds, r_visibility);
+  }
+}
+
+/* Test that the bounds and visibility stored in every inner node match its children, and return
+ * the bounds and visibility of the whole tree. */
+void expect_tight_nodes(const BVH2 &bvh,
+                        const vector<Object *> &objects,
+                        BoundBox &r_bounds,
+                        uint &r_visibility)
+{
+  const PackedBVH &pack = bvh.pack;
+  r_bounds = BoundBox::empty;
+  r_visibility = 0;
+  if (pack.root_index == -1) {
+    subtree_primitives(bvh, objects, 0, true, r_bounds, r_visibility);
+    return;
+  }
+
+  for (size_t idx = 0; idx < pack.nodes.size(); idx += BVH_NODE_SIZE) {
+    const int4 *node = &pack.nodes[idx];
+    const uint node_visibility[2] = {uint(node[0].x), uint(node[0].y)};
+    for (int child = 0; child < 2; child++) {
+      const int c = (child == 0) ? node[0].z : node[0].w;
+      BoundBox bounds = BoundBox::empty;
+      uint visibility = 0;
+      subtree_primitives(bvh, objects, (c < 0) ? -c - 1 : c, c < 0, bounds, visibility);
+
+      const BoundBox stored_bounds = child_bounds(node, child);
+      expect_bounds_equal(stored_bounds, bounds);
+      EXPECT_EQ(node_visibility[child], visibility);
+
+      if (idx == 0) {
+        r_bounds.grow(stored_bounds);
+        r_visibility |= node_visibility[child];
+      }
+    }
+  }
+}
+
+}  // namespace
+
+/* Parallel binning processes large ranges in fixed size chunks, so the tree must not depend on
+ * the number of threads. */
+TEST(BVHBuild, parallel_binning_thread_count)
+{
+  /* Enough triangles for the first levels to be binned in parallel. */
+  TestObject test_object(200, 0.0f, 1);
+  const vector<Geometry *> geometry = {&test_object.mesh};
+  const vector<Object *> objects = {&test_object.object};
+
+  BVHParams params;
+  params.use_parallel_binning = true;
+
+  vector<unique_ptr<BVH2>> bvhs;
+  for (const int num_threads : {1, 3, 8}) {
+    TaskScheduler::init(num_threads);
+    unique_ptr<BVH2> bvh = make_unique<BVH2>(params, geometry, objects);
+    Progress progress;
+    bvh->build(progress, nullptr);
+    TaskScheduler::exit();
+    bvhs.push_back(std::move(bvh));
+  }
+
+  const PackedBVH &pack = bvhs[0]->pack;
+  EXPECT_EQ(pack.prim_index.size(), 200 * 200 * 2);
+  for (size_t i = 1; i < bvhs.size(); i++) {
+    const PackedBVH &other = bvhs[i]->pack;
+    EXPECT_EQ(pack.root_index, other.root_index);
+    expect_arrays_equal(pack.nodes, other.nodes);
+    expect_arrays_equal(pack.leaf_nodes, other.leaf_nodes);
+    expect_arrays_equal(pack.prim_index, other.prim_index);
+    expect_arrays_equal(pack.prim_type, other.prim_type);
+    expect_arrays_equal(pack.prim_object, other.prim_object);
+  }
+}
+
+/* Refitting the top level BVH after deformation and visibility changes gives the same bounds and
+ * visibility as building it again. */
+TEST(BVHBuild, top_level_refit_matches_rebuild)
+{
+  TaskScheduler::init();
+
+  TestObject test_object_a(20, 0.0f, 1);
+  TestObject test_object_b(20, 2.0f, 2);
+  test_object_b.mesh.prim_offset = test_object_a.mesh.num_triangles();
+  test_object_a.object.set_visibility(PATH_RAY_CAMERA);
+  const vector<Geometry *> geometry = {&test_object_a.mesh, &test_object_b.mesh};
+  const vector<Object *> objects = {&test_object_a.object, &test_object_b.object};
+
+  BVHParams params;
+  params.top_level = true;
+  params.use_spatial_split = false;
+
+  BVH2 bvh(params, geometry, objects);
+  Progress progress;
+  bvh.build(progress, nullptr);
+
+  /* Deform the first mesh and move it over the second one, and change the visibility. */
+  create_grid_mesh(test_object_a.mesh, 20, 1.5f, 3);
+  test_object_a.object.compute_bounds(false);
+  test_object_a.object.set_visibility(PATH_RAY_CAMERA | PATH_RAY_SHADOW);
+  test_object_b.object.set_visibility(PATH_RAY_DIFFUSE);
+  ASSERT_TRUE(bvh.can_refit_top_level());
+  bvh.refit(progress);
+
+  BVH2 rebuilt_bvh(params, geometry, objects);
+  rebuilt_bvh.build(progress, nullptr);
+
+  BoundBox refit_bounds;
+  uint refit_visibility;
+  expect_tight_nodes(bvh, objects, refit_bounds, refit_visibility);
+
+  BoundBox rebuilt_bounds;
+  uint rebuilt_visibility;
+  expect_tight_nodes(rebuilt_bvh, objects, rebuilt_bounds, rebuilt_visibility);
+
+  expect_bounds_equal(refit_bounds, rebuilt_bounds);
+  EXPECT_EQ(refit_visibility, rebuilt_visibility);
+  EXPECT_EQ(refit_visibility, uint(PATH_RAY_CAMERA | PATH_RAY_SHADOW | PATH_RAY_DIFFUSE));
+
+  TaskScheduler::exit();
+}
+
+CCL_NAMESPACE_END
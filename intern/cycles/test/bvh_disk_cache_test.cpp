@@ -0,0 +1,237 @@
+/* SPDX-FileCopyrightText: 2026 Blender Foundation
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+
+#include <OpenImageIO/filesystem.h>
+
+#include "bvh/bvh.h"
+#include "bvh/disk_cache.h"
+#include "bvh/params.h"
+
+#include "scene/mesh.h"
+
+#include "util/hash.h"
+#include "util/path.h"
+#include "util/string.h"
+#include "util/time.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+/* Directory for cache files, removed with all its files at the end of the test. */
+class BVHDiskCacheTest : public testing::Test {
+ protected:
+  string dir;
+
+  void SetUp() override
+  {
+    const testing::TestInfo *info = testing::UnitTest::GetInstance()->current_test_info();
+    const std::filesystem::path path = std::filesystem::temp_directory_path() /
+                                       string_printf("cycles_bvh_disk_cache_%s_%llx",
+                                                     info->name(),
+                                                     (unsigned long long)(time_dt() * 1e9));
+    dir = path.string();
+    /* Creates the parent directory of the given file path. */
+    ASSERT_TRUE(path_create_directories(filepath("key")));
+  }
+
+  void TearDown() override
+  {
+    std::error_code error;
+    std::filesystem::remove_all(dir, error);
+  }
+
+  string filepath(const string &key) const
+  {
+    return path_join(dir, key + ".bvh");
+  }
+};
+
+template<typename T> void fill_array(array<T> &data, const size_t size, const uint seed)
+{
+  data.resize(size);
+  uint *words = reinterpret_cast<uint *>(data.data());
+  for (size_t i = 0; i < size * sizeof(T) / sizeof(uint); i++) {
+    words[i] = hash_uint2(uint(i), seed);
+  }
+}
+
+/* Arbitrary data in every stored array, with different sizes. */
+PackedBVH create_test_pack()
+{
+  PackedBVH pack;
+  fill_array(pack.nodes, 40, 1);
+  fill_array(pack.leaf_nodes, 21, 2);
+  fill_array(pack.object_node, 3, 3);
+  fill_array(pack.prim_type, 50, 4);
+  fill_array(pack.prim_index, 50, 5);
+  fill_array(pack.prim_object, 50, 6);
+  fill_array(pack.prim_time, 50, 7);
+  pack.root_index = 7;
+  return pack;
+}
+
+template<typename T> void expect_arrays_equal(const array<T> &a, const array<T> &b)
+{
+  ASSERT_EQ(a.size(), b.size());
+  EXPECT_EQ(memcmp(a.data(), b.data(), a.size() * sizeof(T)), 0);
+}
+
+void set_triangle(Mesh &mesh, const float3 offset)
+{
+  mesh.resize_mesh(3, 1);
+  packed_float3 *P = mesh.get_position_for_write();
+  P[0] = make_float3(0.0f, 0.0f, 0.0f) + offset;
+  P[1] = make_float3(1.0f, 0.0f, 0.0f) + offset;
+  P[2] = make_float3(0.0f, 1.0f, 0.0f) + offset;
+  int *triangles = mesh.get_triangles().data();
+  triangles[0] = 0;
+  triangles[1] = 1;
+  triangles[2] = 2;
+}
+
+}  // namespace
+
+TEST_F(BVHDiskCacheTest, write_read_round_trip)
+{
+  const PackedBVH pack = create_test_pack();
+  bvh_disk_cache_write(dir, "key", pack);
+
+  PackedBVH read_pack;
+  ASSERT_TRUE(bvh_disk_cache_read(dir, "key", read_pack));
+  EXPECT_EQ(read_pack.root_index, pack.root_index);
+  expect_arrays_equal(read_pack.nodes, pack.nodes);
+  expect_arrays_equal(read_pack.leaf_nodes, pack.leaf_nodes);
+  expect_arrays_equal(read_pack.object_node, pack.object_node);
+  expect_arrays_equal(read_pack.prim_type, pack.prim_type);
+  expect_arrays_equal(read_pack.prim_index, pack.prim_index);
+  expect_arrays_equal(read_pack.prim_object, pack.prim_object);
+  expect_arrays_equal(read_pack.prim_time, pack.prim_time);
+
+  /* Missing entries are not found. */
+  EXPECT_FALSE(bvh_disk_cache_read(dir, "other_key", read_pack));
+}
+
+TEST_F(BVHDiskCacheTest, key_depends_on_geometry_and_params)
+{
+  Mesh mesh;
+  set_triangle(mesh, zero_float3());
+  const BVHParams params;
+
+  const string key = bvh_disk_cache_key(params, &mesh);
+  EXPECT_FALSE(key.empty());
+  EXPECT_EQ(bvh_disk_cache_key(params, &mesh), key);
+
+  /* Moving a vertex changes the key. */
+  mesh.get_position_for_write()[1].x = 2.0f;
+  const string moved_key = bvh_disk_cache_key(params, &mesh);
+  EXPECT_NE(moved_key, key);
+
+  /* Same geometry built again gives the same key. */
+  Mesh other_mesh;
+  set_triangle(other_mesh, zero_float3());
+  EXPECT_EQ(bvh_disk_cache_key(params, &other_mesh), key);
+
+  /* Build parameters change the key. */
+  BVHParams split_params;
+  split_params.use_spatial_split = !params.use_spatial_split;
+  EXPECT_NE(bvh_disk_cache_key(split_params, &other_mesh), key);
+
+  BVHParams leaf_params;
+  leaf_params.max_triangle_leaf_size = params.max_triangle_leaf_size + 1;
+  EXPECT_NE(bvh_disk_cache_key(leaf_params, &other_mesh), key);
+}
+
+TEST_F(BVHDiskCacheTest, invalid_files_rejected)
+{
+  const PackedBVH pack = create_test_pack();
+  bvh_disk_cache_write(dir, "key", pack);
+
+  vector<uint8_t> binary;
+  ASSERT_TRUE(path_read_binary(filepath("key"), binary));
+
+  /* Truncated file. */
+  vector<uint8_t> truncated(binary.begin(), binary.end() - sizeof(float2));
+  ASSERT_TRUE(path_write_binary(filepath("truncated"), truncated));
+  PackedBVH read_pack;
+  EXPECT_FALSE(bvh_disk_cache_read(dir, "truncated", read_pack));
+  EXPECT_EQ(read_pack.nodes.size(), 0);
+
+  /* Truncated inside the header. */
+  vector<uint8_t> header_only(binary.begin(), binary.begin() + 12);
+  ASSERT_TRUE(path_write_binary(filepath("header"), header_only));
+  EXPECT_FALSE(bvh_disk_cache_read(dir, "header", read_pack));
+
+  /* Trailing data. */
+  vector<uint8_t> extended = binary;
+  extended.push_back(0);
+  ASSERT_TRUE(path_write_binary(filepath("extended"), extended));
+  EXPECT_FALSE(bvh_disk_cache_read(dir, "extended", read_pack));
+
+  /* Bad magic. */
+  vector<uint8_t> bad_magic = binary;
+  bad_magic[0] ^= 0xff;
+  ASSERT_TRUE(path_write_binary(filepath("magic"), bad_magic));
+  EXPECT_FALSE(bvh_disk_cache_read(dir, "magic", read_pack));
+
+  /* The original file is still valid. */
+  EXPECT_TRUE(bvh_disk_cache_read(dir, "key", read_pack));
+}
+
+TEST_F(BVHDiskCacheTest, prune_least_recently_used)
+{
+  const PackedBVH pack = create_test_pack();
+  const string other_filepath = path_join(dir, "other.txt");
+  ASSERT_TRUE(path_write_binary(other_filepath, vector<uint8_t>(16)));
+  const std::time_t current_time = std::time(nullptr);
+
+  /* Entries used one hour apart, the first one most recently. */
+  const int num_entries = 4;
+  for (int i = 0; i < num_entries; i++) {
+    const string key = string_printf("entry%d", i);
+    bvh_disk_cache_write(dir, key, pack);
+    OIIO::Filesystem::last_write_time(filepath(key), current_time - i * 60 * 60);
+  }
+  const size_t entry_size = path_file_size(filepath("entry0"));
+
+  /* Temporary files of unfinished writes are removed once they are old. */
+  const string old_temp_filepath = filepath("old") + ".1.1.tmp";
+  const string new_temp_filepath = filepath("new") + ".1.1.tmp";
+  ASSERT_TRUE(path_write_binary(old_temp_filepath, vector<uint8_t>(16)));
+  ASSERT_TRUE(path_write_binary(new_temp_filepath, vector<uint8_t>(16)));
+  OIIO::Filesystem::last_write_time(old_temp_filepath, current_time - 48 * 60 * 60);
+
+  /* No limit only removes old temporary files. */
+  bvh_disk_cache_prune(dir, 0);
+  EXPECT_FALSE(path_exists(old_temp_filepath));
+  EXPECT_TRUE(path_exists(new_temp_filepath));
+  for (int i = 0; i < num_entries; i++) {
+    EXPECT_TRUE(path_exists(filepath(string_printf("entry%d", i))));
+  }
+
+  /* Keep the two most recently used entries. */
+  bvh_disk_cache_prune(dir, entry_size * 2 + entry_size / 2);
+  EXPECT_TRUE(path_exists(filepath("entry0")));
+  EXPECT_TRUE(path_exists(filepath("entry1")));
+  EXPECT_FALSE(path_exists(filepath("entry2")));
+  EXPECT_FALSE(path_exists(filepath("entry3")));
+
+  /* Reading an entry marks it as used, so the other one is removed first. */
+  OIIO::Filesystem::last_write_time(filepath("entry0"), current_time - 3 * 60 * 60);
+  PackedBVH read_pack;
+  EXPECT_TRUE(bvh_disk_cache_read(dir, "entry0", read_pack));
+  bvh_disk_cache_prune(dir, entry_size);
+  EXPECT_TRUE(path_exists(filepath("entry0")));
+  EXPECT_FALSE(path_exists(filepath("entry1")));
+
+  /* Other files are left alone. */
+  EXPECT_TRUE(path_exists(new_temp_filepath));
+  EXPECT_TRUE(path_exists(other_filepath));
+}
+
+CCL_NAMESPACE_END
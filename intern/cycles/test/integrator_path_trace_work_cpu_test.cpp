@@ -0,0 +1,191 @@
+/* SPDX-FileCopyrightText: 2026 Blender Foundation
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include <gtest/gtest.h>
+
+#include "device/device.h"
+
+#include "scene/background.h"
+#include "scene/camera.h"
+#include "scene/mesh.h"
+#include "scene/object.h"
+#include "scene/pass.h"
+#include "scene/scene.h"
+#include "scene/shader.h"
+#include "scene/shader_graph.h"
+#include "scene/shader_nodes.h"
+
+#include "session/buffers.h"
+#include "session/output_driver.h"
+#include "session/session.h"
+
+#include "util/debug.h"
+#include "util/vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+constexpr int image_size = 32;
+
+class PixelsOutputDriver : public OutputDriver {
+ public:
+  explicit PixelsOutputDriver(vector<float> &pixels) : pixels_(pixels) {}
+
+  void write_render_tile(const Tile &tile) override
+  {
+    pixels_.resize(size_t(tile.size.x) * tile.size.y * 4);
+    EXPECT_TRUE(tile.get_pass_pixels("combined", 4, pixels_.data()));
+  }
+
+ protected:
+  vector<float> &pixels_;
+};
+
+template<typename T> Shader *create_bsdf_shader(Scene *scene, const float3 color)
+{
+  unique_ptr<ShaderGraph> graph = make_unique<ShaderGraph>();
+  T *bsdf = graph->create_node<T>();
+  bsdf->input("Color")->set(color);
+  graph->connect(bsdf->output("BSDF"), graph->output()->input("Surface"));
+
+  Shader *shader = scene->create_node<Shader>();
+  shader->set_graph(std::move(graph));
+  shader->tag_update(scene);
+  return shader;
+}
+
+/* Slightly tilted quad facing the camera, at the given depth. */
+void set_quad(Mesh *mesh,
+              const int quad_index,
+              const float x_min,
+              const float x_max,
+              const float z,
+              const int shader)
+{
+  const int vert_offset = quad_index * 4;
+  const int tri_offset = quad_index * 2;
+
+  packed_float3 *P = mesh->get_position_for_write() + vert_offset;
+  P[0] = make_float3(x_min, -3.0f, z);
+  P[1] = make_float3(x_max, -3.0f, z);
+  P[2] = make_float3(x_max, 3.0f, z + 1.0f);
+  P[3] = make_float3(x_min, 3.0f, z + 1.0f);
+
+  int *triangles = mesh->get_triangles().data() + tri_offset * 3;
+  const int quad_triangles[6] = {0, 1, 2, 0, 2, 3};
+  for (int i = 0; i < 6; i++) {
+    triangles[i] = vert_offset + quad_triangles[i];
+  }
+  mesh->get_shader()[tri_offset] = shader;
+  mesh->get_shader()[tri_offset + 1] = shader;
+}
+
+/* A few surfaces with different shaders in front of a colored background, so that paths of
+ * neighboring pixels bounce between shaders in different orders. */
+void build_test_scene(Scene *scene)
+{
+  Shader *diffuse = create_bsdf_shader<DiffuseBsdfNode>(scene, make_float3(0.8f, 0.2f, 0.2f));
+  Shader *glossy = create_bsdf_shader<GlossyBsdfNode>(scene, make_float3(0.2f, 0.8f, 0.2f));
+  Shader *gray = create_bsdf_shader<DiffuseBsdfNode>(scene, make_float3(0.5f, 0.5f, 0.5f));
+
+  unique_ptr<ShaderGraph> background_graph = make_unique<ShaderGraph>();
+  BackgroundNode *background = background_graph->create_node<BackgroundNode>();
+  background->input("Color")->set(make_float3(0.4f, 0.6f, 1.0f));
+  background->input("Strength")->set(2.0f);
+  background_graph->connect(background->output("Background"),
+                            background_graph->output()->input("Surface"));
+  scene->default_background->set_graph(std::move(background_graph));
+  scene->default_background->tag_update(scene);
+
+  Mesh *mesh = scene->create_node<Mesh>();
+  array<Node *> used_shaders;
+  used_shaders.push_back_slow(diffuse);
+  used_shaders.push_back_slow(glossy);
+  used_shaders.push_back_slow(gray);
+  mesh->set_used_shaders(used_shaders);
+
+  mesh->resize_mesh(3 * 4, 3 * 2);
+  set_quad(mesh, 0, -3.0f, 0.0f, 5.0f, 0);
+  set_quad(mesh, 1, 0.0f, 3.0f, 4.0f, 1);
+  set_quad(mesh, 2, -20.0f, 20.0f, 12.0f, 2);
+  std::ranges::fill(mesh->get_smooth(), false);
+  mesh->tag_position_modified();
+  mesh->tag_triangles_modified();
+  mesh->tag_shader_modified();
+  mesh->tag_smooth_modified();
+
+  Object *object = scene->create_node<Object>();
+  object->set_geometry(mesh);
+  object->set_tfm(transform_identity());
+
+  Pass *pass = scene->create_node<Pass>();
+  pass->set_name(ustring("combined"));
+  pass->set_type(PASS_COMBINED);
+
+  Camera *camera = scene->camera;
+  camera->set_full_width(image_size);
+  camera->set_full_height(image_size);
+  camera->compute_auto_viewplane();
+  camera->need_flags_update = true;
+}
+
+vector<float> render_test_scene(const bool use_wavefront)
+{
+  DebugFlags().cpu.use_wavefront = use_wavefront;
+
+  vector<DeviceInfo> devices = Device::available_devices(DEVICE_MASK_CPU);
+  EXPECT_FALSE(devices.empty());
+
+  SessionParams session_params;
+  session_params.device = devices.front();
+  session_params.background = true;
+  session_params.samples = 16;
+  session_params.use_auto_tile = false;
+
+  SceneParams scene_params;
+  Session session(session_params, scene_params);
+
+  vector<float> pixels;
+  session.set_output_driver(make_unique<PixelsOutputDriver>(pixels));
+  build_test_scene(session.scene.get());
+
+  BufferParams buffer_params;
+  buffer_params.width = image_size;
+  buffer_params.height = image_size;
+  buffer_params.full_width = image_size;
+  buffer_params.full_height = image_size;
+
+  session.reset(session_params, buffer_params);
+  session.start();
+  session.wait();
+
+  /* Restore the flag from the CYCLES_CPU_WAVEFRONT environment variable. */
+  DebugFlags().cpu.reset();
+
+  return pixels;
+}
+
+}  // namespace
+
+/* The wavefront mode only changes the order in which paths are shaded, every path is still
+ * traced with the same random numbers, so the result has to match the per-pixel pipeline. */
+TEST(PathTraceWorkCPU, wavefront_matches_megakernel)
+{
+  const vector<float> pixels = render_test_scene(false);
+  const vector<float> pixels_wavefront = render_test_scene(true);
+
+  ASSERT_EQ(pixels.size(), size_t(image_size) * image_size * 4);
+  ASSERT_EQ(pixels_wavefront.size(), pixels.size());
+
+  float max_value = 0.0f;
+  for (size_t i = 0; i < pixels.size(); i++) {
+    EXPECT_NEAR(pixels[i], pixels_wavefront[i], 1e-5f) << "Pixel channel " << i;
+    max_value = max(max_value, pixels[i]);
+  }
+  /* Make sure something was rendered. */
+  EXPECT_GT(max_value, 0.0f);
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,42 @@
+/* SPDX-FileCopyrightText: 2026 Blender Foundation
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include <gtest/gtest.h>
+
+#include "scene/image_cache.h"
+
+CCL_NAMESPACE_BEGIN
+
+using EvictionPool = ImageCache::EvictionPool;
+
+TEST(ImageCache, select_pools_to_evict_least_recently_used_first)
+{
+  const vector<EvictionPool> pools = {{100, 5}, {100, 2}, {100, 7}, {100, 1}};
+
+  /* Evict until the remaining memory is within the target. */
+  EXPECT_EQ(ImageCache::select_pools_to_evict(pools, 400, 250), vector<size_t>({3, 1}));
+  EXPECT_EQ(ImageCache::select_pools_to_evict(pools, 400, 100), vector<size_t>({3, 1, 0}));
+  EXPECT_EQ(ImageCache::select_pools_to_evict(pools, 400, 0), vector<size_t>({3, 1, 0, 2}));
+}
+
+TEST(ImageCache, select_pools_to_evict_within_limit)
+{
+  const vector<EvictionPool> pools = {{100, 5}, {100, 2}};
+
+  EXPECT_TRUE(ImageCache::select_pools_to_evict(pools, 200, 200).empty());
+  EXPECT_TRUE(ImageCache::select_pools_to_evict(pools, 200, 300).empty());
+}
+
+TEST(ImageCache, select_pools_to_evict_whole_pools)
+{
+  /* Pools of different sizes count with their full allocated memory, and slots without a
+   * pool are skipped. Pools used in the same cycle keep their order. */
+  const vector<EvictionPool> pools = {{300, 4}, {0, 0}, {50, 4}, {200, 3}};
+
+  EXPECT_EQ(ImageCache::select_pools_to_evict(pools, 550, 500), vector<size_t>({3}));
+  EXPECT_EQ(ImageCache::select_pools_to_evict(pools, 550, 300), vector<size_t>({3, 0}));
+  EXPECT_EQ(ImageCache::select_pools_to_evict(pools, 550, 0), vector<size_t>({3, 0, 2}));
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,275 @@
+/* SPDX-FileCopyrightText: 2026 Blender Foundation
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include <gtest/gtest.h>
+
+#include "device/device.h"
+
+#include "scene/colorspace.h"
+#include "scene/light.h"
+#include "scene/light_tree.h"
+#include "scene/mesh.h"
+#include "scene/object.h"
+#include "scene/scene.h"
+#include "scene/shader.h"
+
+#include "util/progress.h"
+#include "util/stats.h"
+#include "util/task.h"
+#include "util/transform.h"
+
+#include "scene_mesh_test.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+constexpr uint max_lights_in_leaf = 8;
+
+void expect_bounds_equal(const BoundBox &a, const BoundBox &b)
+{
+  EXPECT_EQ(a.min.x, b.min.x);
+  EXPECT_EQ(a.min.y, b.min.y);
+  EXPECT_EQ(a.min.z, b.min.z);
+  EXPECT_EQ(a.max.x, b.max.x);
+  EXPECT_EQ(a.max.y, b.max.y);
+  EXPECT_EQ(a.max.z, b.max.z);
+}
+
+void expect_measures_equal(const LightTreeMeasure &a, const LightTreeMeasure &b)
+{
+  expect_bounds_equal(a.bbox, b.bbox);
+  EXPECT_EQ(a.bcone.axis.x, b.bcone.axis.x);
+  EXPECT_EQ(a.bcone.axis.y, b.bcone.axis.y);
+  EXPECT_EQ(a.bcone.axis.z, b.bcone.axis.z);
+  EXPECT_EQ(a.bcone.theta_o, b.bcone.theta_o);
+  EXPECT_EQ(a.bcone.theta_e, b.bcone.theta_e);
+  EXPECT_EQ(a.energy, b.energy);
+}
+
+/* Measures summed in a different order, where only the energy can differ by rounding. */
+void expect_measures_near(const LightTreeMeasure &a, const LightTreeMeasure &b)
+{
+  expect_bounds_equal(a.bbox, b.bbox);
+  EXPECT_NEAR(a.energy, b.energy, 1e-5f * b.energy);
+}
+
+void expect_trees_equal(const LightTreeNode *a, const LightTreeNode *b)
+{
+  ASSERT_EQ(a->type, b->type);
+  expect_measures_equal(a->measure, b->measure);
+  EXPECT_EQ(a->object_id, b->object_id);
+
+  if (a->is_leaf()) {
+    EXPECT_EQ(a->get_leaf().first_emitter_index, b->get_leaf().first_emitter_index);
+    EXPECT_EQ(a->get_leaf().num_emitters, b->get_leaf().num_emitters);
+  }
+  else if (a->is_inner()) {
+    for (int child = 0; child < 2; child++) {
+      expect_trees_equal(a->get_inner().children[child].get(),
+                         b->get_inner().children[child].get());
+    }
+  }
+}
+
+class LightTreeTest : public testing::Test {
+ protected:
+  Stats stats;
+  Profiler profiler;
+  DeviceInfo device_info;
+  unique_ptr<Device> device_cpu;
+  SceneParams scene_params;
+  unique_ptr<Scene> scene;
+  Progress progress;
+
+  void SetUp() override
+  {
+    ColorSpaceManager::init_fallback_config();
+
+    device_cpu = Device::create(device_info, stats, profiler, true);
+    scene = make_unique<Scene>(scene_params, device_cpu.get());
+  }
+
+  Object *add_object(Geometry *geom, const Transform &tfm)
+  {
+    Object *object = scene->create_node<Object>();
+    object->set_geometry(geom);
+    object->set_tfm(tfm);
+    object->index = scene->objects.size() - 1;
+    return object;
+  }
+
+  template<typename T> T *add_light(const Transform &tfm, const float strength)
+  {
+    T *light = scene->create_node<T>();
+    light->set_strength(make_float3(strength, strength, strength));
+    light->set_is_enabled(true);
+    add_object(light, tfm);
+    return light;
+  }
+
+  /* Emissive object with a grid mesh, see #create_grid_mesh. */
+  Object *add_emissive_grid(const int resolution, const Transform &tfm)
+  {
+    Shader *shader = scene->create_node<Shader>();
+    shader->emission_sampling = EMISSION_SAMPLING_FRONT_BACK;
+    shader->emission_estimate = one_float3();
+
+    Mesh *mesh = scene->create_node<Mesh>();
+    array<Node *> used_shaders;
+    used_shaders.push_back_slow(shader);
+    mesh->set_used_shaders(used_shaders);
+
+    create_grid_mesh(*mesh, resolution, 0.0f, resolution);
+    std::ranges::fill(mesh->get_shader(), 0);
+
+    Object *object = add_object(mesh, tfm);
+    object->compute_bounds(false);
+    return object;
+  }
+};
+
+}  // namespace
+
+/* Refitting the tree after lights and emissive objects moved or changed strength gives the same
+ * measures as building it again. */
+TEST_F(LightTreeTest, refit_matches_rebuild)
+{
+  TaskScheduler::init();
+
+  PointLight *point = add_light<PointLight>(transform_translate(1.0f, 0.0f, 0.0f), 10.0f);
+  Object *point_object = scene->objects.back();
+  SpotLight *spot = add_light<SpotLight>(transform_translate(-2.0f, 1.0f, 3.0f), 5.0f);
+  add_light<AreaLight>(transform_translate(0.0f, 4.0f, 1.0f), 2.0f);
+  SunLight *sun = add_light<SunLight>(transform_identity(), 1.0f);
+  Object *mesh_object = add_emissive_grid(4, transform_translate(0.0f, 0.0f, -1.0f));
+
+  LightTree tree(scene.get(), &scene->dscene, progress, max_lights_in_leaf);
+  ASSERT_NE(tree.build(scene.get(), &scene->dscene), nullptr);
+
+  point->set_strength(make_float3(20.0f, 20.0f, 20.0f));
+  point_object->set_tfm(transform_translate(5.0f, -1.0f, 2.0f));
+  spot->set_strength(make_float3(0.5f, 1.0f, 0.5f));
+  sun->set_strength(make_float3(3.0f, 3.0f, 3.0f));
+  mesh_object->set_tfm(transform_translate(2.0f, 2.0f, 0.0f) * transform_scale(2.0f, 2.0f, 2.0f));
+  mesh_object->compute_bounds(false);
+  ASSERT_TRUE(tree.update(scene.get(), &scene->dscene));
+
+  LightTree rebuilt_tree(scene.get(), &scene->dscene, progress, max_lights_in_leaf);
+  ASSERT_NE(rebuilt_tree.build(scene.get(), &scene->dscene), nullptr);
+
+  /* Emitters can be in a different order, when the new positions lead to different splits. */
+  ASSERT_EQ(tree.num_emitters(), rebuilt_tree.num_emitters());
+  for (size_t i = 0; i < tree.num_emitters(); i++) {
+    const LightTreeEmitter &emitter = tree.get_emitters()[i];
+    const LightTreeEmitter *rebuilt_emitter = nullptr;
+    for (size_t j = 0; j < rebuilt_tree.num_emitters(); j++) {
+      const LightTreeEmitter &other = rebuilt_tree.get_emitters()[j];
+      /* Mesh emitters have no primitive index. */
+      if (other.object_id == emitter.object_id && other.is_mesh() == emitter.is_mesh() &&
+          (emitter.is_mesh() || other.prim_id == emitter.prim_id))
+      {
+        rebuilt_emitter = &other;
+      }
+    }
+    ASSERT_NE(rebuilt_emitter, nullptr);
+
+    EXPECT_EQ(emitter.centroid.x, rebuilt_emitter->centroid.x);
+    EXPECT_EQ(emitter.centroid.y, rebuilt_emitter->centroid.y);
+    EXPECT_EQ(emitter.centroid.z, rebuilt_emitter->centroid.z);
+    if (emitter.is_mesh()) {
+      /* The measure of a mesh is the sum of its triangles, in the order of its subtree. */
+      expect_measures_near(emitter.measure, rebuilt_emitter->measure);
+    }
+    else {
+      expect_measures_equal(emitter.measure, rebuilt_emitter->measure);
+    }
+  }
+
+  const LightTreeNode *root = tree.get_root();
+  const LightTreeNode *rebuilt_root = rebuilt_tree.get_root();
+  expect_measures_near(root->measure, rebuilt_root->measure);
+  for (int child = 0; child < 2; child++) {
+    expect_measures_near(root->get_inner().children[child]->measure,
+                         rebuilt_root->get_inner().children[child]->measure);
+  }
+
+  TaskScheduler::exit();
+}
+
+/* Distant lights are in a separate leaf, so the tree is rebuilt when a light changes between
+ * distant and local. */
+TEST_F(LightTreeTest, light_type_change_requires_rebuild)
+{
+  TaskScheduler::init();
+
+  add_light<PointLight>(transform_translate(1.0f, 0.0f, 0.0f), 10.0f);
+  add_light<SunLight>(transform_identity(), 1.0f);
+  SunLight *sun = add_light<SunLight>(transform_identity(), 2.0f);
+
+  LightTree tree(scene.get(), &scene->dscene, progress, max_lights_in_leaf);
+  ASSERT_NE(tree.build(scene.get(), &scene->dscene), nullptr);
+  EXPECT_EQ(tree.get_root()->get_inner().children[1]->get_leaf().num_emitters, 2);
+
+  sun->set_light_type(LIGHT_POINT);
+  EXPECT_FALSE(tree.update(scene.get(), &scene->dscene));
+
+  LightTree rebuilt_tree(scene.get(), &scene->dscene, progress, max_lights_in_leaf);
+  ASSERT_NE(rebuilt_tree.build(scene.get(), &scene->dscene), nullptr);
+  const LightTreeNode *distant = rebuilt_tree.get_root()->get_inner().children[1].get();
+  EXPECT_TRUE(distant->is_distant());
+  EXPECT_EQ(distant->get_leaf().num_emitters, 1);
+  EXPECT_EQ(distant->get_leaf().first_emitter_index, 2);
+
+  /* Without a type change the same tree can be refit. */
+  LightTree refit_tree(scene.get(), &scene->dscene, progress, max_lights_in_leaf);
+  ASSERT_NE(refit_tree.build(scene.get(), &scene->dscene), nullptr);
+  EXPECT_TRUE(refit_tree.update(scene.get(), &scene->dscene));
+
+  TaskScheduler::exit();
+}
+
+/* Large nodes fill the split buckets in parallel, in fixed size chunks of emitters, so the tree
+ * must not depend on the number of threads. */
+TEST_F(LightTreeTest, parallel_split_thread_count)
+{
+  /* Enough emissive triangles for the first levels of the mesh subtree to be split in
+   * parallel. */
+  add_emissive_grid(190, transform_identity());
+  add_light<PointLight>(transform_translate(1.0f, 0.0f, 0.0f), 10.0f);
+
+  vector<unique_ptr<LightTree>> trees;
+  for (const int num_threads : {1, 3, 8}) {
+    TaskScheduler::init(num_threads);
+    unique_ptr<LightTree> tree = make_unique<LightTree>(
+        scene.get(), &scene->dscene, progress, max_lights_in_leaf);
+    EXPECT_NE(tree->build(scene.get(), &scene->dscene), nullptr);
+    TaskScheduler::exit();
+    trees.push_back(std::move(tree));
+  }
+
+  const LightTree &tree = *trees[0];
+  EXPECT_EQ(tree.num_emitters(), 190 * 190 * 2 + 2);
+  for (size_t i = 1; i < trees.size(); i++) {
+    const LightTree &other = *trees[i];
+    expect_trees_equal(tree.get_root(), other.get_root());
+
+    ASSERT_EQ(tree.num_emitters(), other.num_emitters());
+    for (size_t j = 0; j < tree.num_emitters(); j++) {
+      const LightTreeEmitter &emitter = tree.get_emitters()[j];
+      const LightTreeEmitter &other_emitter = other.get_emitters()[j];
+      EXPECT_EQ(emitter.object_id, other_emitter.object_id);
+      ASSERT_EQ(emitter.is_mesh(), other_emitter.is_mesh());
+      expect_measures_equal(emitter.measure, other_emitter.measure);
+      if (emitter.is_mesh()) {
+        expect_trees_equal(emitter.root.get(), other_emitter.root.get());
+      }
+      else {
+        EXPECT_EQ(emitter.prim_id, other_emitter.prim_id);
+      }
+    }
+  }
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,51 @@
+/* SPDX-FileCopyrightText: 2026 Blender Foundation
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#pragma once
+
+#include "scene/mesh.h"
+
+#include "util/hash.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Grid of `resolution` by `resolution` quads with a noisy height, starting at `x_offset`. */
+inline void create_grid_mesh(Mesh &mesh,
+                             const int resolution,
+                             const float x_offset,
+                             const uint seed)
+{
+  const int verts_per_row = resolution + 1;
+  mesh.resize_mesh(verts_per_row * verts_per_row, resolution * resolution * 2);
+
+  packed_float3 *P = mesh.get_position_for_write();
+  for (int y = 0; y < verts_per_row; y++) {
+    for (int x = 0; x < verts_per_row; x++) {
+      const int i = y * verts_per_row + x;
+      const float height = hash_uint2_to_float(i, seed);
+      P[i] = make_float3(x_offset + float(x) / resolution, float(y) / resolution, height * 0.1f);
+    }
+  }
+
+  int *triangles = mesh.get_triangles().data();
+  for (int y = 0; y < resolution; y++) {
+    for (int x = 0; x < resolution; x++) {
+      const int v0 = y * verts_per_row + x;
+      const int v1 = v0 + 1;
+      const int v2 = v0 + verts_per_row + 1;
+      const int v3 = v0 + verts_per_row;
+      int *quad = triangles + (y * resolution + x) * 6;
+      quad[0] = v0;
+      quad[1] = v1;
+      quad[2] = v2;
+      quad[3] = v0;
+      quad[4] = v2;
+      quad[5] = v3;
+    }
+  }
+
+  mesh.compute_bounds();
+}
+
+CCL_NAMESPACE_END
@@ -32,6 +32,11 @@ void DebugFlags::CPU::reset()
 #undef CHECK_CPU_FLAGS
 
   bvh_layout = BVH_LAYOUT_AUTO;
+
+  use_wavefront = false;
+  if (const char *str = getenv("CYCLES_CPU_WAVEFRONT")) {
+    use_wavefront = (atoi(str) != 0);
+  }
 }
 
 DebugFlags::CUDA::CUDA()
@@ -45,6 +45,10 @@ class DebugFlags {
      * CPUs and GPUs can be selected here instead.
      */
     BVHLayout bvh_layout = BVH_LAYOUT_AUTO;
+
+    /* Render batches of paths in lockstep and sort them by shader before surface shading, to
+     * improve shader and texture cache coherence. */
+    bool use_wavefront = false;
   };
 
   /* Descriptor of CUDA feature-set to be used. */
@@ -93,6 +93,12 @@ void normals_calc_faces(Span<float3> vert_positions,
                         OffsetIndices<int> faces,
                         Span<int> corner_verts,
                         MutableSpan<float3> face_normals);
+/** Same as above, but only calculate the normals of the faces in the mask. */
+void normals_calc_faces(Span<float3> vert_positions,
+                        OffsetIndices<int> faces,
+                        Span<int> corner_verts,
+                        const IndexMask &face_mask,
+                        MutableSpan<float3> face_normals);
 
 /**
  * Calculate vertex normals directly into the result array.
@@ -109,6 +115,14 @@ void normals_calc_verts(Span<float3> vert_positions,
                         GroupedSpan<int> vert_to_face_map,
                         Span<float3> face_normals,
                         MutableSpan<float3> vert_normals);
+/** Same as above, but only calculate the normals of the vertices in the mask. */
+void normals_calc_verts(Span<float3> vert_positions,
+                        OffsetIndices<int> faces,
+                        Span<int> corner_verts,
+                        GroupedSpan<int> vert_to_face_map,
+                        Span<float3> face_normals,
+                        const IndexMask &vert_mask,
+                        MutableSpan<float3> vert_normals);
 
 /** \} */
 
@@ -204,6 +218,21 @@ void normals_calc_corners(Span<float3> vert_positions,
                           Span<short2> custom_normals,
                           CornerNormalSpaceArray *r_fan_spaces,
                           MutableSpan<float3> r_corner_normals);
+/**
+ * Same as above, but only calculate the normals of the corners around the vertices in the mask.
+ * Normal spaces can't be created for a part of the mesh, so there is no #r_fan_spaces argument.
+ */
+void normals_calc_corners(Span<float3> vert_positions,
+                          OffsetIndices<int> faces,
+                          Span<int> corner_verts,
+                          Span<int> corner_edges,
+                          GroupedSpan<int> vert_to_face_map,
+                          Span<float3> face_normals,
+                          Span<bool> sharp_edges,
+                          Span<bool> sharp_faces,
+                          Span<short2> custom_normals,
+                          const IndexMask &vert_mask,
+                          MutableSpan<float3> r_corner_normals);
 
 /**
  * \param sharp_faces: Optional array used to mark specific faces for sharp shading.
@@ -436,6 +436,21 @@ static std::unique_ptr<BVHTree, BVHTreeDeleter> bvhtree_new_common(int elems_num
   return std::unique_ptr<BVHTree, BVHTreeDeleter>(BLI_bvhtree_new(elems_num, 0.0f, 2, 6));
 }
 
+/**
+ * Building from a Morton order is fully parallel, unlike the median split which only threads
+ * the upper levels. It gives slightly less tight branch bounds, so only use it for large inputs.
+ */
+static constexpr int bvhtree_morton_build_threshold = 256 * 1024;
+
+static void bvhtree_balance_common(BVHTree *tree)
+{
+  const int elems_num = BLI_bvhtree_get_len(tree);
+  BLI_bvhtree_balance_ex(tree,
+                         elems_num >= bvhtree_morton_build_threshold ?
+                             BVHTreeBuildMethod::Morton :
+                             BVHTreeBuildMethod::Median);
+}
+
 static std::unique_ptr<BVHTree, BVHTreeDeleter> create_tree_from_verts(
     const Span<float3> positions, const IndexMask &verts_mask)
 {
@@ -445,7 +460,7 @@ static std::unique_ptr<BVHTree, BVHTreeDeleter> create_tree_from_verts(
   }
   verts_mask.foreach_index(
       [&](const int i) { BLI_bvhtree_insert(tree.get(), i, positions[i], 1); });
-  BLI_bvhtree_balance(tree.get());
+  bvhtree_balance_common(tree.get());
   return tree;
 }
 
@@ -470,7 +485,7 @@ static std::unique_ptr<BVHTree, BVHTreeDeleter> create_tree_from_edges(
     copy_v3_v3(co[1], positions[edge[1]]);
     BLI_bvhtree_insert(tree.get(), edge_i, co[0], 2);
   });
-  BLI_bvhtree_balance(tree.get());
+  bvhtree_balance_common(tree.get());
   return tree;
 }
 
@@ -499,7 +514,7 @@ static std::unique_ptr<BVHTree, BVHTreeDeleter> create_tree_from_legacy_faces(
     }
     BLI_bvhtree_insert(tree.get(), i, co[0], faces[i].v4 ? 4 : 3);
   }
-  BLI_bvhtree_balance(tree.get());
+  bvhtree_balance_common(tree.get());
   return tree;
 }
 
@@ -518,7 +533,7 @@ static std::unique_ptr<BVHTree, BVHTreeDeleter> create_tree_from_tris(const Span
     copy_v3_v3(co[2], positions[corner_verts[corner_tris[tri][2]]]);
     BLI_bvhtree_insert(tree.get(), tri, co[0], 3);
   }
-  BLI_bvhtree_balance(tree.get());
+  bvhtree_balance_common(tree.get());
   return tree;
 }
 
@@ -551,7 +566,7 @@ static std::unique_ptr<BVHTree, BVHTreeDeleter> create_tree_from_tris(
       BLI_bvhtree_insert(tree.get(), tri, co[0], 3);
     }
   });
-  BLI_bvhtree_balance(tree.get());
+  bvhtree_balance_common(tree.get());
   return tree;
 }
 
@@ -18,10 +18,12 @@
 #include "BLI_array_utils.hh"
 #include "BLI_bit_vector.hh"
 #include "BLI_enumerable_thread_specific.hh"
+#include "BLI_index_mask.hh"
 #include "BLI_linklist.hh"
 #include "BLI_math_base.hh"
 #include "BLI_math_vector.hh"
 #include "BLI_memarena.hh"
+#include "BLI_sort.hh"
 #include "BLI_span.hh"
 #include "BLI_task.hh"
 #include "BLI_utildefines.hh"
@@ -191,6 +193,45 @@ void normals_calc_faces(const Span<float3> positions,
   });
 }
 
+void normals_calc_faces(const Span<float3> positions,
+                        const OffsetIndices<int> faces,
+                        const Span<int> corner_verts,
+                        const IndexMask &face_mask,
+                        MutableSpan<float3> face_normals)
+{
+  PRF_scope(ProfileCategory::Default);
+  BLI_assert(faces.size() == face_normals.size());
+  face_mask.foreach_index(
+      [&](const int i) {
+        face_normals[i] = normal_calc_ngon(positions, corner_verts.slice(faces[i]));
+      },
+      exec_mode::grain_size(1024));
+}
+
+static float3 vert_normal_calc(const Span<float3> positions,
+                               const OffsetIndices<int> faces,
+                               const Span<int> corner_verts,
+                               const Span<int> vert_faces,
+                               const Span<float3> face_normals,
+                               const int vert)
+{
+  if (vert_faces.is_empty()) {
+    return math::normalize(positions[vert]);
+  }
+
+  float3 vert_normal(0);
+  for (const int face : vert_faces) {
+    const int2 adjacent_verts = face_find_adjacent_verts(faces[face], corner_verts, vert);
+    const float3 dir_prev = math::normalize(positions[adjacent_verts[0]] - positions[vert]);
+    const float3 dir_next = math::normalize(positions[adjacent_verts[1]] - positions[vert]);
+    const float factor = math::safe_acos_approx(math::dot(dir_prev, dir_next));
+
+    vert_normal += face_normals[face] * factor;
+  }
+
+  return math::normalize(vert_normal);
+}
+
 void normals_calc_verts(const Span<float3> vert_positions,
                         const OffsetIndices<int> faces,
                         const Span<int> corner_verts,
@@ -202,27 +243,29 @@ void normals_calc_verts(const Span<float3> vert_positions,
   const Span<float3> positions = vert_positions;
   threading::parallel_for(positions.index_range(), 1024, [&](const IndexRange range) {
     for (const int vert : range) {
-      const Span<int> vert_faces = vert_to_face_map[vert];
-      if (vert_faces.is_empty()) {
-        vert_normals[vert] = math::normalize(positions[vert]);
-        continue;
-      }
-
-      float3 vert_normal(0);
-      for (const int face : vert_faces) {
-        const int2 adjacent_verts = face_find_adjacent_verts(faces[face], corner_verts, vert);
-        const float3 dir_prev = math::normalize(positions[adjacent_verts[0]] - positions[vert]);
-        const float3 dir_next = math::normalize(positions[adjacent_verts[1]] - positions[vert]);
-        const float factor = math::safe_acos_approx(math::dot(dir_prev, dir_next));
-
-        vert_normal += face_normals[face] * factor;
-      }
-
-      vert_normals[vert] = math::normalize(vert_normal);
+      vert_normals[vert] = vert_normal_calc(
+          positions, faces, corner_verts, vert_to_face_map[vert], face_normals, vert);
     }
   });
 }
 
+void normals_calc_verts(const Span<float3> vert_positions,
+                        const OffsetIndices<int> faces,
+                        const Span<int> corner_verts,
+                        const GroupedSpan<int> vert_to_face_map,
+                        const Span<float3> face_normals,
+                        const IndexMask &vert_mask,
+                        MutableSpan<float3> vert_normals)
+{
+  PRF_scope(ProfileCategory::Default);
+  vert_mask.foreach_index(
+      [&](const int vert) {
+        vert_normals[vert] = vert_normal_calc(
+            vert_positions, faces, corner_verts, vert_to_face_map[vert], face_normals, vert);
+      },
+      exec_mode::grain_size(1024));
+}
+
 /** \} */
 
 static void mix_normals_corner_to_vert(const Span<float3> vert_positions,
@@ -514,6 +557,142 @@ Span<float3> Mesh::corner_normals() const
   return this->runtime->corner_normals_cache.data().get_span();
 }
 
+namespace bke::mesh {
+
+/** Update corner normals around the given vertices, matching #Mesh::corner_normals(). */
+static void update_corner_normals(const Mesh &mesh,
+                                  const IndexMask &verts,
+                                  MutableSpan<float3> corner_normals)
+{
+  const OffsetIndices<int> faces = mesh.faces();
+  const Span<int> corner_verts = mesh.corner_verts();
+  const GroupedSpan<int> vert_to_corner_map = mesh.vert_to_corner_map();
+  switch (mesh.normals_domain()) {
+    case MeshNormalDomain::Point: {
+      const Span<float3> vert_normals = mesh.vert_normals();
+      verts.foreach_index(
+          [&](const int vert) {
+            corner_normals.fill_indices(vert_to_corner_map[vert], vert_normals[vert]);
+          },
+          exec_mode::grain_size(1024));
+      break;
+    }
+    case MeshNormalDomain::Face: {
+      const Span<float3> face_normals = mesh.face_normals();
+      const GroupedSpan<int> vert_to_face_map = mesh.vert_to_face_map();
+      verts.foreach_index(
+          [&](const int vert) {
+            for (const int face : vert_to_face_map[vert]) {
+              const int corner = face_find_corner_from_vert(faces[face], corner_verts, vert);
+              corner_normals[corner] = face_normals[face];
+            }
+          },
+          exec_mode::grain_size(1024));
+      break;
+    }
+    case MeshNormalDomain::Corner: {
+      const AttributeAccessor attributes = mesh.attributes();
+      const GAttributeReader custom = attributes.lookup("custom_normal");
+      const VArraySpan sharp_edges = *attributes.lookup<bool>("sharp_edge", AttrDomain::Edge);
+      const VArraySpan sharp_faces = *attributes.lookup<bool>("sharp_face", AttrDomain::Face);
+      normals_calc_corners(mesh.vert_positions(),
+                           faces,
+                           corner_verts,
+                           mesh.corner_edges(),
+                           mesh.vert_to_face_map(),
+                           mesh.face_normals_true(),
+                           sharp_edges,
+                           sharp_faces,
+                           VArraySpan<short2>(custom.varray.typed<short2>()),
+                           verts,
+                           corner_normals);
+      break;
+    }
+  }
+}
+
+/** Sort the indices and remove duplicates, so that they can be used to create an #IndexMask. */
+static Span<int> sort_and_deduplicate(Vector<int> &indices)
+{
+  parallel_sort(indices.begin(), indices.end());
+  indices.resize(std::unique(indices.begin(), indices.end()) - indices.begin());
+  return indices;
+}
+
+}  // namespace bke::mesh
+
+void Mesh::tag_positions_changed(const IndexMask &changed_verts)
+{
+  using namespace blender::bke;
+  MeshRuntime &runtime = *this->runtime;
+  /* Gathering the affected neighborhood only pays off when few vertices changed. Without cached
+   * face normals, there is nothing to update and the normals are computed lazily as usual. */
+  if (this->faces_num == 0 || !runtime.face_normals_true_cache.is_cached() ||
+      changed_verts.size() > this->verts_num / 8)
+  {
+    this->tag_positions_changed();
+    return;
+  }
+  this->tag_positions_changed_no_normals();
+
+  const OffsetIndices<int> faces = this->faces();
+  const Span<int> corner_verts = this->corner_verts();
+  const GroupedSpan<int> vert_to_face_map = this->vert_to_face_map();
+  const Span<float3> positions = this->vert_positions();
+
+  /* The normals of all faces using a changed vertex change. The normals of all vertices and
+   * corners of those faces change as well, since they depend on the face normals and on the
+   * directions of the edges to their neighbors. */
+  Vector<int> affected_faces;
+  changed_verts.foreach_index(
+      [&](const int vert) { affected_faces.extend(vert_to_face_map[vert]); });
+  Vector<int> affected_verts;
+  changed_verts.foreach_index([&](const int vert) { affected_verts.append(vert); });
+  for (const int face : mesh::sort_and_deduplicate(affected_faces)) {
+    affected_verts.extend(corner_verts.slice(faces[face]));
+  }
+  IndexMaskMemory memory;
+  const IndexMask face_mask = IndexMask::from_indices(affected_faces.as_span(), memory);
+  const IndexMask vert_mask = IndexMask::from_indices(mesh::sort_and_deduplicate(affected_verts),
+                                                      memory);
+
+  runtime.face_normals_true_cache.update([&](Vector<float3> &r_data) {
+    mesh::normals_calc_faces(positions, faces, corner_verts, face_mask, r_data);
+  });
+  if (runtime.vert_normals_true_cache.is_cached()) {
+    runtime.vert_normals_true_cache.update([&](Vector<float3> &r_data) {
+      mesh::normals_calc_verts(positions,
+                               faces,
+                               corner_verts,
+                               vert_to_face_map,
+                               runtime.face_normals_true_cache.data(),
+                               vert_mask,
+                               r_data);
+    });
+  }
+  else {
+    runtime.vert_normals_true_cache.tag_dirty();
+  }
+
+  /* The other caches only have to be recomputed if they contain data derived from positions.
+   * When they reference the true normals or custom normals stored as attributes, they stay
+   * valid. */
+  const auto holds_computed_data = [](const SharedCache<NormalsCache> &cache) {
+    return cache.is_cached() && std::holds_alternative<Vector<float3>>(cache.data().data);
+  };
+  if (holds_computed_data(runtime.vert_normals_cache)) {
+    runtime.vert_normals_cache.tag_dirty();
+  }
+  if (holds_computed_data(runtime.face_normals_cache)) {
+    runtime.face_normals_cache.tag_dirty();
+  }
+  if (holds_computed_data(runtime.corner_normals_cache)) {
+    runtime.corner_normals_cache.update([&](NormalsCache &r_data) {
+      mesh::update_corner_normals(*this, vert_mask, std::get<Vector<float3>>(r_data.data));
+    });
+  }
+}
+
 void BKE_lnor_spacearr_init(MLoopNorSpaceArray *lnors_spacearr,
                             const int numLoops,
                             const char data_type)
@@ -1236,32 +1415,27 @@ BLI_NOINLINE static void handle_fan_result_and_custom_normals(
   r_local_space_groups->append({std::move(fan_corners), fan_space});
 }
 
-void normals_calc_corners(const Span<float3> vert_positions,
-                          const OffsetIndices<int> faces,
-                          const Span<int> corner_verts,
-                          const Span<int> corner_edges,
-                          const GroupedSpan<int> vert_to_face_map,
-                          const Span<float3> face_normals,
-                          const Span<bool> sharp_edges,
-                          const Span<bool> sharp_faces,
-                          const Span<short2> custom_normals,
-                          CornerNormalSpaceArray *r_fan_spaces,
-                          MutableSpan<float3> r_corner_normals)
+/**
+ * Calculate the normals of all face corners around the given vertices. Every vertex is processed
+ * separately, so the result only depends on the positions and face normals in the neighborhood of
+ * each vertex.
+ */
+static void calc_corner_normals_for_verts(
+    const Span<float3> vert_positions,
+    const OffsetIndices<int> faces,
+    const Span<int> corner_verts,
+    const Span<int> corner_edges,
+    const GroupedSpan<int> vert_to_face_map,
+    const Span<float3> face_normals,
+    const Span<bool> sharp_edges,
+    const Span<bool> sharp_faces,
+    const Span<short2> custom_normals,
+    const IndexMask &vert_mask,
+    CornerNormalSpaceArray *r_fan_spaces,
+    threading::EnumerableThreadSpecific<Vector<CornerSpaceGroup, 0>> &space_groups,
+    MutableSpan<float3> r_corner_normals)
 {
-  PRF_scope(ProfileCategory::Default);
-  BLI_assert(corner_verts.size() == corner_edges.size());
-  BLI_assert(custom_normals.is_empty() || corner_verts.size() == custom_normals.size());
-  BLI_assert(corner_verts.size() == r_corner_normals.size());
-  BLI_assert(corner_verts.size() == vert_to_face_map.offsets.total_size());
-
-  /* Mesh is not empty, but there are no faces, so no normals. */
-  if (corner_verts.is_empty()) {
-    return;
-  }
-
-  threading::EnumerableThreadSpecific<Vector<CornerSpaceGroup, 0>> space_groups;
-
-  threading::parallel_for(vert_positions.index_range(), 256, [&](const IndexRange range) {
+  threading::parallel_for(vert_mask.index_range(), 256, [&](const IndexRange range) {
     Vector<VertCornerInfo, 16> corner_infos;
     LocalEdgeVectorSet local_edge_by_vert;
     Vector<VertEdgeInfo, 16> edge_infos;
@@ -1272,14 +1446,14 @@ void normals_calc_corners(const Span<float3> vert_positions,
     Vector<CornerSpaceGroup, 0> *local_space_groups = r_fan_spaces ? &space_groups.local() :
                                                                      nullptr;
 
-    for (const int vert : range) {
+    vert_mask.slice(range).foreach_index([&](const int vert) {
       const float3 vert_position = vert_positions[vert];
       const Span<int> vert_faces = vert_to_face_map[vert];
 
       /* Because we're iterating over vertices in order to batch work for their connected face
        * corners, we have to handle loose vertices and vertices not used by faces. */
       if (vert_faces.is_empty()) {
-        continue;
+        return;
       }
 
       corner_infos.resize(vert_faces.size());
@@ -1341,8 +1515,47 @@ void normals_calc_corners(const Span<float3> vert_positions,
         }
       }
       BLI_assert(visited_count == corner_infos.size());
-    }
+    });
   });
+}
+
+void normals_calc_corners(const Span<float3> vert_positions,
+                          const OffsetIndices<int> faces,
+                          const Span<int> corner_verts,
+                          const Span<int> corner_edges,
+                          const GroupedSpan<int> vert_to_face_map,
+                          const Span<float3> face_normals,
+                          const Span<bool> sharp_edges,
+                          const Span<bool> sharp_faces,
+                          const Span<short2> custom_normals,
+                          CornerNormalSpaceArray *r_fan_spaces,
+                          MutableSpan<float3> r_corner_normals)
+{
+  PRF_scope(ProfileCategory::Default);
+  BLI_assert(corner_verts.size() == corner_edges.size());
+  BLI_assert(custom_normals.is_empty() || corner_verts.size() == custom_normals.size());
+  BLI_assert(corner_verts.size() == r_corner_normals.size());
+  BLI_assert(corner_verts.size() == vert_to_face_map.offsets.total_size());
+
+  /* Mesh is not empty, but there are no faces, so no normals. */
+  if (corner_verts.is_empty()) {
+    return;
+  }
+
+  threading::EnumerableThreadSpecific<Vector<CornerSpaceGroup, 0>> space_groups;
+  calc_corner_normals_for_verts(vert_positions,
+                                faces,
+                                corner_verts,
+                                corner_edges,
+                                vert_to_face_map,
+                                face_normals,
+                                sharp_edges,
+                                sharp_faces,
+                                custom_normals,
+                                IndexMask(vert_positions.size()),
+                                r_fan_spaces,
+                                space_groups,
+                                r_corner_normals);
 
   if (!r_fan_spaces) {
     return;
@@ -1392,6 +1605,36 @@ void normals_calc_corners(const Span<float3> vert_positions,
   });
 }
 
+void normals_calc_corners(const Span<float3> vert_positions,
+                          const OffsetIndices<int> faces,
+                          const Span<int> corner_verts,
+                          const Span<int> corner_edges,
+                          const GroupedSpan<int> vert_to_face_map,
+                          const Span<float3> face_normals,
+                          const Span<bool> sharp_edges,
+                          const Span<bool> sharp_faces,
+                          const Span<short2> custom_normals,
+                          const IndexMask &vert_mask,
+                          MutableSpan<float3> r_corner_normals)
+{
+  PRF_scope(ProfileCategory::Default);
+  BLI_assert(corner_verts.size() == r_corner_normals.size());
+  threading::EnumerableThreadSpecific<Vector<CornerSpaceGroup, 0>> space_groups;
+  calc_corner_normals_for_verts(vert_positions,
+                                faces,
+                                corner_verts,
+                                corner_edges,
+                                vert_to_face_map,
+                                face_normals,
+                                sharp_edges,
+                                sharp_faces,
+                                custom_normals,
+                                vert_mask,
+                                nullptr,
+                                space_groups,
+                                r_corner_normals);
+}
+
 #undef INDEX_UNSET
 #undef INDEX_INVALID
 #undef IS_EDGE_SHARP
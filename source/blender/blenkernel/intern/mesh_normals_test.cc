@@ -0,0 +1,103 @@
+/* SPDX-FileCopyrightText: 2025 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "BLI_index_mask.hh"
+
+#include "BKE_attribute.hh"
+#include "BKE_gtest_base.hh"
+#include "BKE_lib_id.hh"
+#include "BKE_mesh.hh"
+
+#include "DNA_mesh_types.h"
+
+#include "testing/testing.h"
+
+namespace blender::bke::tests {
+
+class MeshNormalsTest : public BlenderGTestBase {};
+
+/* Create a grid of quads with a wavy surface so that all normals are different. */
+static Mesh *create_grid_mesh(const int size)
+{
+  const int verts_x = size + 1;
+  Mesh *mesh = BKE_mesh_new_nomain(verts_x * verts_x, 0, size * size, size * size * 4);
+  MutableSpan<float3> positions = mesh->vert_positions_for_write();
+  for (const int y : IndexRange(verts_x)) {
+    for (const int x : IndexRange(verts_x)) {
+      positions[y * verts_x + x] = float3(x, y, std::sin(x * 0.7f) * std::cos(y * 0.5f));
+    }
+  }
+  MutableSpan<int> face_offsets = mesh->face_offsets_for_write();
+  MutableSpan<int> corner_verts = mesh->corner_verts_for_write();
+  for (const int y : IndexRange(size)) {
+    for (const int x : IndexRange(size)) {
+      const int face = y * size + x;
+      const int vert = y * verts_x + x;
+      face_offsets[face] = face * 4;
+      corner_verts[face * 4 + 0] = vert;
+      corner_verts[face * 4 + 1] = vert + 1;
+      corner_verts[face * 4 + 2] = vert + verts_x + 1;
+      corner_verts[face * 4 + 3] = vert + verts_x;
+    }
+  }
+  face_offsets.last() = size * size * 4;
+  mesh_calc_edges(*mesh, false, false);
+  mesh->tag_positions_changed();
+  return mesh;
+}
+
+static void expect_normals_near(const Span<float3> a, const Span<float3> b)
+{
+  ASSERT_EQ(a.size(), b.size());
+  for (const int i : a.index_range()) {
+    EXPECT_V3_NEAR(a[i], b[i], 1e-6f);
+  }
+}
+
+/** Move a few vertices after all normals have been cached and compare with a full update. */
+static void test_partial_normals_update(Mesh &mesh)
+{
+  mesh.face_normals();
+  mesh.vert_normals();
+  mesh.corner_normals();
+
+  const Array<int> changed_verts = {10, 11, 40};
+  MutableSpan<float3> positions = mesh.vert_positions_for_write();
+  for (const int vert : changed_verts) {
+    positions[vert].z += 0.5f;
+  }
+  IndexMaskMemory memory;
+  mesh.tag_positions_changed(IndexMask::from_indices(changed_verts.as_span(), memory));
+
+  Mesh *expected = BKE_mesh_copy_for_eval(mesh);
+  expected->tag_positions_changed();
+
+  expect_normals_near(mesh.face_normals(), expected->face_normals());
+  expect_normals_near(mesh.vert_normals(), expected->vert_normals());
+  expect_normals_near(mesh.corner_normals(), expected->corner_normals());
+
+  BKE_id_free(nullptr, expected);
+}
+
+TEST_F(MeshNormalsTest, PartialUpdateSmooth)
+{
+  Mesh *mesh = create_grid_mesh(8);
+  test_partial_normals_update(*mesh);
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(MeshNormalsTest, PartialUpdateSharpEdges)
+{
+  Mesh *mesh = create_grid_mesh(8);
+  MutableAttributeAccessor attributes = mesh->attributes_for_write();
+  SpanAttributeWriter<bool> sharp_edges = attributes.lookup_or_add_for_write_span<bool>(
+      "sharp_edge", AttrDomain::Edge);
+  sharp_edges.span.take_front(sharp_edges.span.size() / 2).fill(true);
+  sharp_edges.finish();
+  ASSERT_EQ(mesh->normals_domain(), MeshNormalDomain::Corner);
+  test_partial_normals_update(*mesh);
+  BKE_id_free(nullptr, mesh);
+}
+
+}  // namespace blender::bke::tests
@@ -334,6 +334,13 @@ int BLI_access(const char *filepath, int mode) ATTR_WARN_UNUSED_RESULT ATTR_NONN
  */
 int64_t BLI_read(int fd, void *buf, size_t nbytes);
 
+/**
+ * A version of #BLI_read that reads at the given offset and does not use the file position, so
+ * that multiple threads can read from the same file descriptor.
+ * \return the number of bytes read.
+ */
+int64_t BLI_pread(int fd, void *buf, size_t nbytes, int64_t offset);
+
 /**
  * Returns true if the file with the specified name can be written.
  * This implementation uses access(2), which makes the check according
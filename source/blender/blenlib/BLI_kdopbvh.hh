@@ -11,6 +11,7 @@
 #include "BLI_function_ref.hh"
 #include "BLI_hash.hh"
 #include "BLI_math_vector_types.hh"
+#include "BLI_span.hh"
 #include "BLI_sys_types.hh"
 
 namespace blender {
@@ -150,20 +151,40 @@ class BVHTreeDeleter {
  */
 BVHTree *BLI_bvhtree_new(int maxsize, float epsilon, char tree_type, char axis);
 
+/** How #BLI_bvhtree_balance_ex distributes the leafs over the branches of the tree. */
+enum class BVHTreeBuildMethod {
+  /**
+   * Split the leafs of every branch at the median along the largest axis of its bounds.
+   * Only the branches of each level are processed in parallel.
+   */
+  Median,
+  /**
+   * Order the leafs along a Morton curve through their centers, and compute the bounds of the
+   * branches bottom-up. Every step runs in parallel, which makes this much faster for large
+   * trees, at the cost of slightly looser bounds.
+   *
+   * \note Falls back to #Median for 18-DOP trees, which have no axis aligned bounds.
+   */
+  Morton,
+};
+
 /**
  * Construct: first insert points, then call balance.
  */
 void BLI_bvhtree_insert(BVHTree *tree, int index, const float co[3], int numpoints);
 void BLI_bvhtree_balance(BVHTree *tree);
+void BLI_bvhtree_balance_ex(BVHTree *tree, BVHTreeBuildMethod method);
 
 /**
  * Update: first update points/nodes, then call update_tree to refit the bounding volumes.
  * \note call before #BLI_bvhtree_update_tree().
+ * \note Different nodes can be updated from multiple threads at the same time.
  */
 bool BLI_bvhtree_update_node(
     BVHTree *tree, int index, const float co[3], const float co_moving[3], int numpoints);
 /**
  * Call #BLI_bvhtree_update_node() first for every node/point/triangle.
+ * The branches of each level of the tree are refitted in parallel.
  *
  * Note that this does not rebalance the tree, so if the shape of the mesh changes
  * too much, operations on the tree may become suboptimal.
@@ -289,6 +310,23 @@ void BLI_bvhtree_ray_cast_all(const BVHTree *tree,
                               BVHTree_RayCastCallback callback,
                               void *userdata);
 
+/**
+ * Cast many rays without radius at once, like calling #BLI_bvhtree_ray_cast_ex for each of them.
+ * Neighboring rays are traversed together and tested against the bounds of the nodes with SIMD
+ * instructions, so coherent rays (e.g. with similar origins and directions) are the fastest.
+ * Trees without axis aligned bounds (18-DOP) cast every ray separately.
+ *
+ * \param r_hits: Must be initialized with the index and maximum distance of every ray, like the
+ * \a hit argument of #BLI_bvhtree_ray_cast_ex. Rays that don't hit anything are left untouched.
+ */
+void BLI_bvhtree_ray_cast_batch(const BVHTree *tree,
+                                Span<float3> origins,
+                                Span<float3> directions,
+                                MutableSpan<BVHTreeRayHit> r_hits,
+                                BVHTree_RayCastCallback callback,
+                                void *userdata,
+                                int flag = BVH_RAYCAST_DEFAULT);
+
 float BLI_bvhtree_bb_raycast(const float bv[6],
                              const float light_start[3],
                              const float light_end[3],
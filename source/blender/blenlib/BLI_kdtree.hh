@@ -12,10 +12,13 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_array.hh"
+#include "BLI_index_mask.hh"
 #include "BLI_kdtree_types.hh"
 #include "BLI_math_base_c.hh"
 #include "BLI_math_vector.hh"
+#include "BLI_sort.hh"
 #include "BLI_stack.hh"
+#include "BLI_task.hh"
 #include "BLI_vector.hh"
 
 #include "PRF_profile.hh"
@@ -38,6 +41,9 @@ constexpr uint kd_node_unset = (uint(-1));
  */
 constexpr uint kd_node_root_is_init = (uint(-2));
 
+/** Sub-trees with more nodes than this are balanced in parallel tasks. */
+constexpr uint kd_balance_parallel_threshold = 8192;
+
 template<typename CoordT>
 inline typename KDTreeCoordTraits<CoordT>::ValueType axis_get(const CoordT &co, uint axis)
 {
@@ -167,13 +173,18 @@ static uint kdtree_balance(KDTreeNode<CoordT> *nodes, uint nodes_len, uint axis,
     }
   }
 
-  /* Set node and sort sub-nodes. */
+  /* Set node and sort sub-nodes. The sub-trees use disjoint ranges of nodes, so they can be
+   * balanced in parallel. */
   node = &nodes[median];
   node->d = axis;
   axis = (axis + 1) % KDTree<CoordT>::DimsNum;
-  node->left = kdtree_balance(nodes, median, axis, ofs);
-  node->right = kdtree_balance(
-      nodes + median + 1, (nodes_len - (median + 1)), axis, (median + 1) + ofs);
+  threading::parallel_invoke(
+      nodes_len > kd_balance_parallel_threshold,
+      [&]() { node->left = kdtree_balance(nodes, median, axis, ofs); },
+      [&]() {
+        node->right = kdtree_balance(
+            nodes + median + 1, (nodes_len - (median + 1)), axis, (median + 1) + ofs);
+      });
 
   return median + ofs;
 }
@@ -184,10 +195,12 @@ template<typename CoordT> inline void kdtree_balance(KDTree<CoordT> *tree)
 {
   PRF_scope(ProfileCategory::Default);
   if (tree->root != detail::kd_node_root_is_init) {
-    for (uint i = 0; i < tree->nodes_len; i++) {
-      tree->nodes[i].left = detail::kd_node_unset;
-      tree->nodes[i].right = detail::kd_node_unset;
-    }
+    threading::parallel_for(IndexRange(tree->nodes_len), 8192, [&](const IndexRange range) {
+      for (const int64_t i : range) {
+        tree->nodes[i].left = detail::kd_node_unset;
+        tree->nodes[i].right = detail::kd_node_unset;
+      }
+    });
   }
 
   tree->root = detail::kdtree_balance<CoordT>(tree->nodes, tree->nodes_len, 0, 0);
@@ -314,6 +327,99 @@ inline int kdtree_find_nearest(const KDTree<CoordT> *tree,
 
 namespace detail {
 
+/**
+ * Follow the splitting planes of the tree from the root towards \a co, for at most \a depth
+ * levels. Nodes are stored in the order of an in-order traversal of the tree, so coordinates
+ * that end up at nearby nodes are close to each other.
+ */
+template<typename CoordT>
+static uint kdtree_descend(const KDTree<CoordT> *tree, const CoordT &co, const int depth)
+{
+  uint node_index = tree->root;
+  for (int i = 0; i < depth; i++) {
+    const KDTreeNode<CoordT> &node = tree->nodes[node_index];
+    const uint next = axis_get(co, node.d) < axis_get(node.co, node.d) ? node.left : node.right;
+    if (next == kd_node_unset) {
+      break;
+    }
+    node_index = next;
+  }
+  return node_index;
+}
+
+/**
+ * Order the indices in \a mask so that consecutive queries visit mostly the same nodes,
+ * which makes much better use of the CPU caches than the order of the input for large trees.
+ */
+template<typename CoordT>
+static Array<int> kdtree_query_order(const KDTree<CoordT> *tree,
+                                     const Span<CoordT> positions,
+                                     const IndexMask &mask)
+{
+  /* Stop at sub-trees of a few dozen nodes, which easily fit into the cache. */
+  int depth = 0;
+  for (uint len = tree->nodes_len; len > 32; len /= 2) {
+    depth++;
+  }
+  if (depth == 0 || mask.size() < 1024) {
+    /* Sorting doesn't pay off for small trees or few queries. */
+    Array<int> order(mask.size());
+    mask.to_indices<int>(order);
+    return order;
+  }
+
+  Array<std::pair<uint, int>> keys(mask.size());
+  mask.foreach_index(
+      [&](const int i, const int pos) {
+        keys[pos] = {kdtree_descend(tree, positions[i], depth), i};
+      },
+      exec_mode::grain_size(4096));
+  parallel_sort(keys.begin(), keys.end());
+
+  Array<int> order(mask.size());
+  threading::parallel_for(order.index_range(), 4096, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      order[i] = keys[i].second;
+    }
+  });
+  return order;
+}
+
+}  // namespace detail
+
+/**
+ * Find the nearest node for every index in \a mask in parallel, like calling
+ * #kdtree_find_nearest_cb for each of them. The queries are sorted spatially first.
+ *
+ * \param filter_cb: Called with the query index as first argument, followed by the arguments
+ * of the callback of #kdtree_find_nearest_cb. Must be thread-safe.
+ * \param r_indices: The index of the nearest node for each query (-1 if none is found),
+ * indexed like \a positions.
+ */
+template<typename CoordT, typename Filter>
+inline void kdtree_find_nearest_batch_cb(const KDTree<CoordT> *tree,
+                                         const Span<CoordT> positions,
+                                         const IndexMask &mask,
+                                         MutableSpan<int> r_indices,
+                                         Filter &&filter_cb)
+{
+  PRF_scope(ProfileCategory::Default);
+  const Array<int> order = detail::kdtree_query_order<CoordT>(tree, positions, mask);
+  threading::parallel_for(order.index_range(), 1024, [&](const IndexRange range) {
+    for (const int query : order.as_span().slice(range)) {
+      r_indices[query] = kdtree_find_nearest_cb<CoordT>(
+          tree,
+          positions[query],
+          nullptr,
+          [&](const int index, const CoordT &co, const auto dist_sq) {
+            return filter_cb(query, index, co, dist_sq);
+          });
+    }
+  });
+}
+
+namespace detail {
+
 template<typename CoordT>
 static void nearest_ordered_insert(KDTreeNearest<CoordT> *nearest,
                                    uint *nearest_len,
@@ -10,6 +10,7 @@
 
 #include "BLI_math_matrix_types.hh"
 #include "BLI_math_vector_types.hh"
+#include "BLI_span.hh"
 
 namespace blender::noise {
 
@@ -137,6 +138,32 @@ float3 perlin_float3_fractal_distorted(float4 position,
                                        int type,
                                        bool normalize);
 
+/* Batched versions of the 3D functions above. Multiple positions are evaluated at once using SIMD
+ * instructions where available. The results are the same as when evaluating every position
+ * separately. */
+
+void perlin_signed(Span<float3> positions, MutableSpan<float> r_values);
+void perlin_fractal_distorted(Span<float3> positions,
+                              float detail,
+                              float roughness,
+                              float lacunarity,
+                              float offset,
+                              float gain,
+                              float distortion,
+                              int type,
+                              bool normalize,
+                              MutableSpan<float> r_values);
+void perlin_float3_fractal_distorted(Span<float3> positions,
+                                     float detail,
+                                     float roughness,
+                                     float lacunarity,
+                                     float offset,
+                                     float gain,
+                                     float distortion,
+                                     int type,
+                                     bool normalize,
+                                     MutableSpan<float3> r_values);
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -15,6 +15,8 @@
  *
  * - Ray-cast:
  *   #BLI_bvhtree_ray_cast, #BVHRayCastData
+ * - Ray-cast of many rays at once:
+ *   #BLI_bvhtree_ray_cast_batch, #BVHRayPacket
  * - Nearest point on surface:
  *   #BLI_bvhtree_find_nearest, #BVHNearestData
  * - Overlapping 2 trees:
@@ -28,13 +30,19 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_alloca.hh"
+#include "BLI_array.hh"
+#include "BLI_bounds.hh"
 #include "BLI_heap_simple.hh"
 #include "BLI_kdopbvh.hh"
 #include "BLI_math_geom_c.hh"
 #include "BLI_math_vector_types.hh"
+#include "BLI_simd.hh"
+#include "BLI_sort.hh"
 #include "BLI_stack_c.hh"
+#include "BLI_task.hh"
 #include "BLI_task_c.hh"
 #include "BLI_utildefines.hh"
+#include "BLI_vector.hh"
 
 #include "BLI_strict_flags.hh" /* IWYU pragma: keep. Keep last. */
 
@@ -143,6 +151,25 @@ struct BVHRayCastData {
   BVHTreeRayHit hit;
 };
 
+/** Number of rays that are traversed together by #BLI_bvhtree_ray_cast_batch. */
+#define BVH_RAY_PACKET_SIZE 4
+
+struct BVHRayPacket {
+  /* Structure of arrays, so the rays can be tested against a node with SIMD instructions. */
+  float origin[3][BVH_RAY_PACKET_SIZE];
+  float idot_axis[3][BVH_RAY_PACKET_SIZE];
+  /** Distance of the nearest hit so far, negative for unused rays. */
+  float dist[BVH_RAY_PACKET_SIZE];
+
+  /* Passed to the callback. */
+  BVHTreeRay ray[BVH_RAY_PACKET_SIZE];
+#ifdef USE_KDOPBVH_WATERTIGHT
+  IsectRayPrecalc isect_precalc[BVH_RAY_PACKET_SIZE];
+#endif
+
+  int rays_num;
+};
+
 struct BVHNearestProjectedData {
   DistProjectedAABBPrecalc precalc;
   bool closest_axis[3];
@@ -690,6 +717,10 @@ struct BVHDivNodesData {
   int depth;
   int i;
   int first_of_next_level;
+
+  /** When false, the leafs are already in their final order and branch bounds are computed
+   * afterwards, see #bvh_join_branches_bottom_up. */
+  bool use_split;
 };
 
 static void non_recursive_bvh_div_nodes_task_cb(void *__restrict userdata,
@@ -707,28 +738,30 @@ static void non_recursive_bvh_div_nodes_task_cb(void *__restrict userdata,
   int parent_leafs_begin = implicit_leafs_index(data->data, data->depth, parent_level_index);
   int parent_leafs_end = implicit_leafs_index(data->data, data->depth, parent_level_index + 1);
 
-  /* This calculates the bounding box of this branch
-   * and chooses the largest axis as the axis to divide leafs */
-  refit_kdop_hull(data->tree, parent, parent_leafs_begin, parent_leafs_end);
-  split_axis = get_largest_axis(parent->bv);
-
-  /* Save split axis (this can be used on ray-tracing to speedup the query time) */
-  parent->main_axis = split_axis / 2;
-
-  /* Split the children along the split_axis, NOTE: its not needed to sort the whole leafs array
-   * Only to assure that the elements are partitioned on a way that each child takes the elements
-   * it would take in case the whole array was sorted.
-   * Split_leafs takes care of that "sort" problem. */
-  nth_positions[0] = parent_leafs_begin;
-  nth_positions[data->tree_type] = parent_leafs_end;
-  for (k = 1; k < data->tree_type; k++) {
-    const int child_index = j * data->tree_type + data->tree_offset + k;
-    /* child level index */
-    const int child_level_index = child_index - data->first_of_next_level;
-    nth_positions[k] = implicit_leafs_index(data->data, data->depth + 1, child_level_index);
-  }
+  if (data->use_split) {
+    /* This calculates the bounding box of this branch
+     * and chooses the largest axis as the axis to divide leafs */
+    refit_kdop_hull(data->tree, parent, parent_leafs_begin, parent_leafs_end);
+    split_axis = get_largest_axis(parent->bv);
+
+    /* Save split axis (this can be used on ray-tracing to speedup the query time) */
+    parent->main_axis = split_axis / 2;
+
+    /* Split the children along the split_axis, NOTE: its not needed to sort the whole leafs
+     * array Only to assure that the elements are partitioned on a way that each child takes the
+     * elements it would take in case the whole array was sorted.
+     * Split_leafs takes care of that "sort" problem. */
+    nth_positions[0] = parent_leafs_begin;
+    nth_positions[data->tree_type] = parent_leafs_end;
+    for (k = 1; k < data->tree_type; k++) {
+      const int child_index = j * data->tree_type + data->tree_offset + k;
+      /* child level index */
+      const int child_level_index = child_index - data->first_of_next_level;
+      nth_positions[k] = implicit_leafs_index(data->data, data->depth + 1, child_level_index);
+    }
 
-  split_leafs(data->leafs_array, nth_positions, data->tree_type, split_axis);
+    split_leafs(data->leafs_array, nth_positions, data->tree_type, split_axis);
+  }
 
   /* Setup `children` and `node_num` counters
    * Not really needed but currently most of BVH code
@@ -779,7 +812,8 @@ static void non_recursive_bvh_div_nodes_task_cb(void *__restrict userdata,
 static void non_recursive_bvh_div_nodes(const BVHTree *tree,
                                         BVHNode *branches_array,
                                         BVHNode **leafs_array,
-                                        int leafs_num)
+                                        int leafs_num,
+                                        const bool use_split)
 {
   int i;
 
@@ -821,6 +855,7 @@ static void non_recursive_bvh_div_nodes(const BVHTree *tree,
   cb_data.first_of_next_level = 0;
   cb_data.depth = 0;
   cb_data.i = 0;
+  cb_data.use_split = use_split;
 
   /* Loop tree levels (log N) loops */
   for (i = 1, depth = 1; i <= branches_num; i = i * tree_type + tree_offset, depth++) {
@@ -849,6 +884,104 @@ static void non_recursive_bvh_div_nodes(const BVHTree *tree,
   }
 }
 
+/**
+ * Compute the bounds of all branches of an implicit tree from their children, starting at the
+ * deepest level. All branches of a level are independent, so they are processed in parallel.
+ */
+static void bvh_join_branches_bottom_up(BVHTree *tree,
+                                        BVHNode *branches_array,
+                                        const int branches_num,
+                                        const bool update_main_axis)
+{
+  const int tree_type = tree->tree_type;
+  const int tree_offset = 2 - tree->tree_type;
+
+  Vector<int, 32> level_starts;
+  for (int i = 1; i <= branches_num; i = i * tree_type + tree_offset) {
+    level_starts.append(i);
+  }
+
+  for (int level = int(level_starts.size()) - 1; level >= 0; level--) {
+    const int i = level_starts[level];
+    const int i_stop = min_ii(i * tree_type + tree_offset, branches_num + 1);
+    threading::parallel_for(IndexRange::from_begin_end(i, i_stop), 1024, [&](IndexRange range) {
+      for (const int64_t j : range) {
+        BVHNode *node = &branches_array[j];
+        node_join(tree, node);
+        if (update_main_axis) {
+          node->main_axis = char(get_largest_axis(node->bv) / 2);
+        }
+      }
+    });
+  }
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Morton Order Construction
+ * \{ */
+
+/** Spread the lower 21 bits of \a v, so that there are two zero bits after each of them. */
+static uint64_t morton_spread_bits(uint64_t v)
+{
+  v &= 0x1fffff;
+  v = (v | v << 32) & 0x1f00000000ffffull;
+  v = (v | v << 16) & 0x1f0000ff0000ffull;
+  v = (v | v << 8) & 0x100f00f00f00f00full;
+  v = (v | v << 4) & 0x10c30c30c30c30c3ull;
+  v = (v | v << 2) & 0x1249249249249249ull;
+  return v;
+}
+
+/**
+ * Sort the leafs along a Morton curve through the centers of their bounds, so that splitting
+ * the sorted array into consecutive ranges gives spatially coherent branches.
+ */
+static void bvh_sort_leafs_morton(MutableSpan<BVHNode *> leafs)
+{
+  Array<float3> centers(leafs.size());
+  threading::parallel_for(leafs.index_range(), 4096, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      const float *bv = leafs[i]->bv;
+      centers[i] = float3(bv[0] + bv[1], bv[2] + bv[3], bv[4] + bv[5]) * 0.5f;
+    }
+  });
+  const Bounds<float3> bounds = *bounds::min_max(centers.as_span());
+
+  constexpr float grid_max = float((1 << 21) - 1);
+  const float3 size = bounds.max - bounds.min;
+  const float3 scale(size.x > 0.0f ? grid_max / size.x : 0.0f,
+                     size.y > 0.0f ? grid_max / size.y : 0.0f,
+                     size.z > 0.0f ? grid_max / size.z : 0.0f);
+  auto grid_coord = [&](const float value, const float min, const float factor) -> uint64_t {
+    const float coord = (value - min) * factor;
+    /* Also handles NaN values. */
+    return coord >= 0.0f ? uint64_t(std::min(coord, grid_max)) : 0;
+  };
+
+  Array<std::pair<uint64_t, BVHNode *>> sorted_leafs(leafs.size());
+  threading::parallel_for(leafs.index_range(), 4096, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      const float3 &center = centers[i];
+      const uint64_t code = morton_spread_bits(grid_coord(center.x, bounds.min.x, scale.x)) |
+                            (morton_spread_bits(grid_coord(center.y, bounds.min.y, scale.y))
+                             << 1) |
+                            (morton_spread_bits(grid_coord(center.z, bounds.min.z, scale.z))
+                             << 2);
+      sorted_leafs[i] = {code, leafs[i]};
+    }
+  });
+  /* Leafs with the same code are kept in insertion order, so the result is deterministic. */
+  parallel_sort(sorted_leafs.begin(), sorted_leafs.end());
+
+  threading::parallel_for(leafs.index_range(), 4096, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      leafs[i] = sorted_leafs[i].second;
+    }
+  });
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -939,16 +1072,28 @@ void BLI_bvhtree_free(BVHTree *tree)
 }
 
 void BLI_bvhtree_balance(BVHTree *tree)
+{
+  BLI_bvhtree_balance_ex(tree, BVHTreeBuildMethod::Median);
+}
+
+void BLI_bvhtree_balance_ex(BVHTree *tree, const BVHTreeBuildMethod method)
 {
   BVHNode **leafs_array = tree->nodes;
+  BVHNode *branches_array = tree->nodearray + (tree->leaf_num - 1);
 
   /* This function should only be called once
    * (some big bug goes here if its being called more than once per tree) */
   BLI_assert(tree->branch_num == 0);
 
+  /* The Morton order is computed from the bounds along the X, Y and Z axis. */
+  const bool use_morton = method == BVHTreeBuildMethod::Morton && tree->start_axis == 0 &&
+                          tree->leaf_num > 1;
+  if (use_morton) {
+    bvh_sort_leafs_morton({leafs_array, tree->leaf_num});
+  }
+
   /* Build the implicit tree */
-  non_recursive_bvh_div_nodes(
-      tree, tree->nodearray + (tree->leaf_num - 1), leafs_array, tree->leaf_num);
+  non_recursive_bvh_div_nodes(tree, branches_array, leafs_array, tree->leaf_num, !use_morton);
 
   /* current code expects the branches to be linked to the nodes array
    * we perform that linkage here */
@@ -957,6 +1102,10 @@ void BLI_bvhtree_balance(BVHTree *tree)
     tree->nodes[tree->leaf_num + i] = &tree->nodearray[tree->leaf_num + i];
   }
 
+  if (use_morton) {
+    bvh_join_branches_bottom_up(tree, branches_array, tree->branch_num, true);
+  }
+
 #ifdef USE_SKIP_LINKS
   build_skip_links(tree, tree->nodes[tree->leaf_num], nullptr, nullptr);
 #endif
@@ -1026,14 +1175,9 @@ void BLI_bvhtree_update_tree(BVHTree *tree)
 {
   /* Update bottom=>top
    * TRICKY: the way we build the tree all the children have an index greater than the parent
-   * This allows us todo a bottom up update by starting on the bigger numbered branch. */
-
-  BVHNode **root = tree->nodes + tree->leaf_num;
-  BVHNode **index = tree->nodes + tree->leaf_num + tree->branch_num - 1;
-
-  for (; index >= root; index--) {
-    node_join(tree, *index);
-  }
+   * This allows us todo a bottom up update level by level, starting at the deepest one. */
+  bvh_join_branches_bottom_up(
+      tree, tree->nodearray + (tree->leaf_num - 1), tree->branch_num, false);
 }
 int BLI_bvhtree_get_len(const BVHTree *tree)
 {
@@ -2102,6 +2246,196 @@ void BLI_bvhtree_ray_cast_all(const BVHTree *tree,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name BLI_bvhtree_ray_cast_batch
+ *
+ * Rays are traversed in packets of #BVH_RAY_PACKET_SIZE, so the bounds of every visited node
+ * are only loaded once for the whole packet, and are tested against all rays at the same time.
+ *
+ * \{ */
+
+/**
+ * Slab test of all rays of the packet against the bounds along the X, Y and Z axis.
+ * \return A bit mask of the rays that hit the bounds closer than their nearest hit so far.
+ */
+static int ray_packet_nearest_hit(const BVHRayPacket *packet,
+                                  const float bv[6],
+                                  float r_dist[BVH_RAY_PACKET_SIZE])
+{
+#if BLI_HAVE_SSE2
+  __m128 t_near = _mm_setzero_ps();
+  __m128 t_far = _mm_loadu_ps(packet->dist);
+  for (int axis = 0; axis < 3; axis++) {
+    const __m128 origin = _mm_loadu_ps(packet->origin[axis]);
+    const __m128 idot = _mm_loadu_ps(packet->idot_axis[axis]);
+    const __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bv[2 * axis]), origin), idot);
+    const __m128 t2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bv[2 * axis + 1]), origin), idot);
+    t_near = _mm_max_ps(t_near, _mm_min_ps(t1, t2));
+    t_far = _mm_min_ps(t_far, _mm_max_ps(t1, t2));
+  }
+  _mm_storeu_ps(r_dist, t_near);
+  return _mm_movemask_ps(_mm_cmple_ps(t_near, t_far));
+#else
+  int mask = 0;
+  for (int i = 0; i < BVH_RAY_PACKET_SIZE; i++) {
+    float t_near = 0.0f;
+    float t_far = packet->dist[i];
+    for (int axis = 0; axis < 3; axis++) {
+      const float t1 = (bv[2 * axis] - packet->origin[axis][i]) * packet->idot_axis[axis][i];
+      const float t2 = (bv[2 * axis + 1] - packet->origin[axis][i]) * packet->idot_axis[axis][i];
+      t_near = std::max(t_near, std::min(t1, t2));
+      t_far = std::min(t_far, std::max(t1, t2));
+    }
+    r_dist[i] = t_near;
+    if (t_near <= t_far) {
+      mask |= 1 << i;
+    }
+  }
+  return mask;
+#endif
+}
+
+static void ray_packet_init(BVHRayPacket *packet,
+                            const Span<float3> origins,
+                            const Span<float3> directions,
+                            const Span<BVHTreeRayHit> hits,
+                            const int flag)
+{
+  packet->rays_num = int(origins.size());
+  for (int i = 0; i < BVH_RAY_PACKET_SIZE; i++) {
+    if (i >= packet->rays_num) {
+      /* Unused rays never hit anything. */
+      for (int axis = 0; axis < 3; axis++) {
+        packet->origin[axis][i] = 0.0f;
+        packet->idot_axis[axis][i] = 0.0f;
+      }
+      packet->dist[i] = -1.0f;
+      continue;
+    }
+
+    BLI_ASSERT_UNIT_V3(directions[i]);
+    BVHTreeRay &ray = packet->ray[i];
+    copy_v3_v3(ray.origin, origins[i]);
+    copy_v3_v3(ray.direction, directions[i]);
+    ray.radius = 0.0f;
+    for (int axis = 0; axis < 3; axis++) {
+      packet->origin[axis][i] = ray.origin[axis];
+      packet->idot_axis[axis][i] = fabsf(ray.direction[axis]) < FLT_EPSILON ?
+                                       FLT_MAX :
+                                       1.0f / ray.direction[axis];
+    }
+    packet->dist[i] = hits[i].dist;
+
+#ifdef USE_KDOPBVH_WATERTIGHT
+    if (flag & BVH_RAYCAST_WATERTIGHT) {
+      isect_ray_tri_watertight_v3_precalc(&packet->isect_precalc[i], ray.direction);
+      ray.isect_precalc = &packet->isect_precalc[i];
+    }
+    else {
+      ray.isect_precalc = nullptr;
+    }
+#else
+    UNUSED_VARS(flag);
+#endif
+  }
+}
+
+static void ray_packet_traverse(BVHRayPacket *packet,
+                                const BVHNode *root,
+                                MutableSpan<BVHTreeRayHit> hits,
+                                BVHTree_RayCastCallback callback,
+                                void *userdata,
+                                Vector<const BVHNode *, 128> &stack)
+{
+  float dist[BVH_RAY_PACKET_SIZE];
+
+  stack.append(root);
+  while (!stack.is_empty()) {
+    const BVHNode *node = stack.pop_last();
+    const int mask = ray_packet_nearest_hit(packet, node->bv, dist);
+    if (mask == 0) {
+      continue;
+    }
+
+    if (node->node_num == 0) {
+      for (int i = 0; i < packet->rays_num; i++) {
+        if ((mask & (1 << i)) == 0) {
+          continue;
+        }
+        BVHTreeRayHit &hit = hits[i];
+        if (callback) {
+          callback(userdata, node->index, &packet->ray[i], &hit);
+        }
+        else {
+          hit.index = node->index;
+          hit.dist = dist[i];
+          madd_v3_v3v3fl(hit.co, packet->ray[i].origin, packet->ray[i].direction, dist[i]);
+        }
+        packet->dist[i] = hit.dist;
+      }
+    }
+    else {
+      /* Pick the order in which children are visited from the direction of the first ray that
+       * hit the node. The stack is last in first out, so the children are pushed in reverse. */
+      int first_ray = 0;
+      while ((mask & (1 << first_ray)) == 0) {
+        first_ray++;
+      }
+      const bool forward = node->main_axis < 3 &&
+                           packet->idot_axis[int(node->main_axis)][first_ray] > 0.0f;
+      if (forward) {
+        for (int i = node->node_num - 1; i >= 0; i--) {
+          stack.append(node->children[i]);
+        }
+      }
+      else {
+        for (int i = 0; i != node->node_num; i++) {
+          stack.append(node->children[i]);
+        }
+      }
+    }
+  }
+}
+
+void BLI_bvhtree_ray_cast_batch(const BVHTree *tree,
+                                const Span<float3> origins,
+                                const Span<float3> directions,
+                                MutableSpan<BVHTreeRayHit> r_hits,
+                                BVHTree_RayCastCallback callback,
+                                void *userdata,
+                                const int flag)
+{
+  BLI_assert(origins.size() == directions.size());
+  BLI_assert(origins.size() == r_hits.size());
+
+  if (tree->start_axis != 0) {
+    /* The slab test of packets needs the bounds along the X, Y and Z axis, which are not stored
+     * for trees without them (i.e. 18-DOP). */
+    for (const int64_t i : origins.index_range()) {
+      BLI_bvhtree_ray_cast_ex(
+          tree, origins[i], directions[i], 0.0f, &r_hits[i], callback, userdata, flag);
+    }
+    return;
+  }
+
+  const BVHNode *root = tree->nodes[tree->leaf_num];
+  if (root == nullptr) {
+    return;
+  }
+
+  Vector<const BVHNode *, 128> stack;
+  for (int64_t start = 0; start < origins.size(); start += BVH_RAY_PACKET_SIZE) {
+    const IndexRange range = IndexRange::from_begin_end(
+        start, std::min<int64_t>(start + BVH_RAY_PACKET_SIZE, origins.size()));
+    BVHRayPacket packet;
+    ray_packet_init(
+        &packet, origins.slice(range), directions.slice(range), r_hits.slice(range), flag);
+    ray_packet_traverse(&packet, root, r_hits.slice(range), callback, userdata, stack);
+  }
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name BLI_bvhtree_range_query
  *
@@ -145,6 +145,58 @@ int64_t BLI_read(int fd, void *buf, size_t nbytes)
   }
 }
 
+int64_t BLI_pread(int fd, void *buf, size_t nbytes, int64_t offset)
+{
+  int64_t nbytes_read_total = 0;
+  while (nbytes > 0) {
+#ifdef WIN32
+    /* Reading with an explicit offset is thread-safe, even though it also moves the file
+     * position of synchronous handles. */
+    const HANDLE handle = HANDLE(_get_osfhandle(fd));
+    OVERLAPPED overlapped = {};
+    overlapped.Offset = DWORD(uint64_t(offset));
+    overlapped.OffsetHigh = DWORD(uint64_t(offset) >> 32);
+    DWORD nbytes_read_win = 0;
+    int64_t nbytes_read = -1;
+    if (ReadFile(handle,
+                 buf,
+                 DWORD(std::min<size_t>(nbytes, INT_MAX)),
+                 &nbytes_read_win,
+                 &overlapped))
+    {
+      nbytes_read = nbytes_read_win;
+    }
+    else if (GetLastError() == ERROR_HANDLE_EOF) {
+      nbytes_read = 0;
+    }
+#else
+    const int64_t nbytes_read = pread(fd, buf, nbytes, off_t(offset));
+#endif
+    if (nbytes_read == 0) {
+      /* EOF. */
+      return nbytes_read_total;
+    }
+    if (nbytes_read < 0) {
+      /* Error. */
+      return nbytes_read;
+    }
+    if (nbytes_read > nbytes) [[unlikely]] {
+      BLI_assert_unreachable();
+      if (errno == 0) {
+        errno = EIO;
+      }
+      return -1;
+    }
+
+    /* Fewer bytes were read than were requested. */
+    buf = static_cast<void *>((static_cast<char *>(buf)) + nbytes_read);
+    nbytes_read_total += nbytes_read;
+    offset += nbytes_read;
+    nbytes -= nbytes_read;
+  }
+  return nbytes_read_total;
+}
+
 bool BLI_file_external_operation_supported(const char *filepath, FileExternalOperation operation)
 {
 #ifdef WIN32
@@ -7,16 +7,26 @@
  */
 
 #include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <zstd.h>
 
+#include "BLI_enumerable_thread_specific.hh"
 #include "BLI_fileops.hh"
 #include "BLI_filereader.hh"
+#include "BLI_task.hh"
+#include "BLI_threads.hh"
 
 #include "MEM_guardedalloc.h"
 
 namespace blender {
 
+/**
+ * Maximum number of frames that are decoded at once when the file is read sequentially.
+ * Blender writes frames of 1 MB, so this bounds the memory used by the read-ahead window.
+ */
+#define ZSTD_READ_AHEAD_FRAMES_MAX 32
+
 struct ZstdReader {
   FileReader reader;
 
@@ -31,8 +41,23 @@ struct ZstdReader {
     size_t *compressed_ofs;
     size_t *uncompressed_ofs;
 
+    /**
+     * Uncompressed content of the frames `[cached_frame, cached_frame + cached_frames_num)`,
+     * stored contiguously. When reading sequentially, upcoming frames are decoded in parallel
+     * so that #FileReader::read can be served from this window without waiting on zstd.
+     */
     char *cached_content;
+    size_t cached_content_size;
     int cached_frame;
+    int cached_frames_num;
+
+    /** Number of frames decoded at once on sequential access, one disables read-ahead. */
+    int read_ahead_frames_num;
+    /** Compressed input of the frames being decoded, reused between windows. */
+    char *compressed_content;
+    size_t compressed_content_size;
+    /** Decompression contexts for the worker threads, created lazily. */
+    threading::EnumerableThreadSpecific<ZSTD_DCtx *> *thread_ctx;
   } seek;
 };
 
@@ -128,6 +153,12 @@ static bool zstd_read_seek_table(ZstdReader *zstd)
   }
 
   zstd->seek.cached_frame = -1;
+  zstd->seek.cached_frames_num = 0;
+  zstd->seek.read_ahead_frames_num = std::clamp(
+      std::min(BLI_system_thread_count(), int(frames_num)), 1, ZSTD_READ_AHEAD_FRAMES_MAX);
+  if (zstd->seek.read_ahead_frames_num > 1) {
+    zstd->seek.thread_ctx = MEM_new<threading::EnumerableThreadSpecific<ZSTD_DCtx *>>(__func__);
+  }
 
   return true;
 }
@@ -155,42 +186,115 @@ static int zstd_frame_from_pos(ZstdReader *zstd, size_t pos)
   return low;
 }
 
-/* Ensure that the currently loaded frame is the correct one. */
-static const char *zstd_ensure_cache(ZstdReader *zstd, int frame)
+/* Grow a buffer owned by the reader, discarding its content. */
+static char *zstd_buffer_ensure(char **buffer, size_t *buffer_size, size_t size)
 {
-  if (zstd->seek.cached_frame == frame) {
-    /* Cached frame matches, so just return it. */
-    return zstd->seek.cached_content;
+  if (*buffer_size < size) {
+    MEM_SAFE_DELETE(*buffer);
+    *buffer = MEM_new_array_uninitialized<char>(size, __func__);
+    *buffer_size = size;
   }
+  return *buffer;
+}
 
-  /* Cached frame doesn't match, so discard it and cache the wanted one instead. */
-  MEM_SAFE_DELETE(zstd->seek.cached_content);
+static bool zstd_decompress_frame(ZSTD_DCtx *ctx,
+                                  char *uncompressed_data,
+                                  size_t uncompressed_size,
+                                  const char *compressed_data,
+                                  size_t compressed_size)
+{
+  size_t res = ZSTD_decompressDCtx(
+      ctx, uncompressed_data, uncompressed_size, compressed_data, compressed_size);
+  return !ZSTD_isError(res) && res >= uncompressed_size;
+}
 
-  size_t compressed_size = zstd->seek.compressed_ofs[frame + 1] - zstd->seek.compressed_ofs[frame];
-  size_t uncompressed_size = zstd->seek.uncompressed_ofs[frame + 1] -
-                             zstd->seek.uncompressed_ofs[frame];
+/* Decode the frames `[frame_start, frame_start + frames_num)` into the cache. */
+static bool zstd_decode_frames(ZstdReader *zstd, int frame_start, int frames_num)
+{
+  const int frame_end = frame_start + frames_num;
+  const size_t *compressed_ofs = zstd->seek.compressed_ofs;
+  const size_t *uncompressed_ofs = zstd->seek.uncompressed_ofs;
+
+  /* The base reader is not thread-safe, so the compressed data of all frames is read at once
+   * (frames are stored contiguously) and only the decompression happens in parallel. */
+  size_t compressed_size = compressed_ofs[frame_end] - compressed_ofs[frame_start];
+  size_t uncompressed_size = uncompressed_ofs[frame_end] - uncompressed_ofs[frame_start];
+
+  char *compressed_data = zstd_buffer_ensure(
+      &zstd->seek.compressed_content, &zstd->seek.compressed_content_size, compressed_size);
+  char *uncompressed_data = zstd_buffer_ensure(
+      &zstd->seek.cached_content, &zstd->seek.cached_content_size, uncompressed_size);
+  /* The cache content is overwritten from here on. */
+  zstd->seek.cached_frame = -1;
+  zstd->seek.cached_frames_num = 0;
 
-  char *uncompressed_data = MEM_new_array_uninitialized<char>(uncompressed_size, __func__);
-  char *compressed_data = MEM_new_array_uninitialized<char>(compressed_size, __func__);
-  if (zstd->base->seek(zstd->base, zstd->seek.compressed_ofs[frame], SEEK_SET) < 0 ||
+  if (zstd->base->seek(zstd->base, compressed_ofs[frame_start], SEEK_SET) < 0 ||
       zstd->base->read(zstd->base, compressed_data, compressed_size) < compressed_size)
   {
-    MEM_delete(compressed_data);
-    MEM_delete(uncompressed_data);
-    return nullptr;
+    return false;
   }
 
-  size_t res = ZSTD_decompressDCtx(
-      zstd->ctx, uncompressed_data, uncompressed_size, compressed_data, compressed_size);
-  MEM_delete(compressed_data);
-  if (ZSTD_isError(res) || res < uncompressed_size) {
-    MEM_delete(uncompressed_data);
-    return nullptr;
+  auto decode_frame = [&](ZSTD_DCtx *ctx, int frame) {
+    return zstd_decompress_frame(
+        ctx,
+        uncompressed_data + (uncompressed_ofs[frame] - uncompressed_ofs[frame_start]),
+        uncompressed_ofs[frame + 1] - uncompressed_ofs[frame],
+        compressed_data + (compressed_ofs[frame] - compressed_ofs[frame_start]),
+        compressed_ofs[frame + 1] - compressed_ofs[frame]);
+  };
+
+  if (frames_num == 1) {
+    if (!decode_frame(zstd->ctx, frame_start)) {
+      return false;
+    }
+  }
+  else {
+    std::atomic<bool> success = true;
+    threading::parallel_for(IndexRange(frame_start, frames_num), 1, [&](IndexRange range) {
+      ZSTD_DCtx *&ctx = zstd->seek.thread_ctx->local();
+      if (ctx == nullptr) {
+        ctx = ZSTD_createDCtx();
+      }
+      for (const int frame : range) {
+        if (!decode_frame(ctx, frame)) {
+          success = false;
+          return;
+        }
+      }
+    });
+    if (!success) {
+      return false;
+    }
+  }
+
+  zstd->seek.cached_frame = frame_start;
+  zstd->seek.cached_frames_num = frames_num;
+  return true;
+}
+
+/* Ensure that the given frame is loaded, returning a pointer to its uncompressed content. */
+static const char *zstd_ensure_cache(ZstdReader *zstd, int frame)
+{
+  const int cached_frame = zstd->seek.cached_frame;
+  const int cached_frame_end = cached_frame + zstd->seek.cached_frames_num;
+  if (frame >= cached_frame && frame < cached_frame_end) {
+    /* Cached frames contain the wanted one, so just return it. */
+    return zstd->seek.cached_content +
+           (zstd->seek.uncompressed_ofs[frame] - zstd->seek.uncompressed_ofs[cached_frame]);
   }
 
-  zstd->seek.cached_frame = frame;
-  zstd->seek.cached_content = uncompressed_data;
-  return uncompressed_data;
+  /* Only read ahead when the stream is consumed sequentially. Random access, e.g. reading
+   * #BHead data on demand, would otherwise decode many frames that are never used. */
+  const bool is_sequential = (frame == cached_frame_end) || (cached_frame == -1 && frame == 0);
+  const int frames_num = is_sequential ?
+                             std::min(zstd->seek.read_ahead_frames_num,
+                                      zstd->seek.frames_num - frame) :
+                             1;
+
+  if (!zstd_decode_frames(zstd, frame, frames_num)) {
+    return nullptr;
+  }
+  return zstd->seek.cached_content;
 }
 
 static int64_t zstd_read_seekable(FileReader *reader, void *buffer, size_t size)
@@ -287,6 +391,15 @@ static void zstd_close(FileReader *reader)
     if (zstd->seek.cached_content) {
       MEM_delete(zstd->seek.cached_content);
     }
+    if (zstd->seek.compressed_content) {
+      MEM_delete(zstd->seek.compressed_content);
+    }
+    if (zstd->seek.thread_ctx) {
+      for (ZSTD_DCtx *ctx : *zstd->seek.thread_ctx) {
+        ZSTD_freeDCtx(ctx);
+      }
+      MEM_delete(zstd->seek.thread_ctx);
+    }
   }
   else {
     MEM_delete(static_cast<const std::byte *>(zstd->in_buf.src));
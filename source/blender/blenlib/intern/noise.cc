@@ -9,6 +9,7 @@
  */
 
 #include <algorithm>
+#include <array>
 #include <cfloat>
 #include <cmath>
 #include <cstdint>
@@ -18,6 +19,7 @@
 #include "BLI_math_matrix_types.hh"
 #include "BLI_math_vector.hh"
 #include "BLI_noise.hh"
+#include "BLI_simd.hh"
 #include "BLI_utildefines.hh"
 
 /* Some noise functions integer overflow as part of expected operation. */
@@ -1123,6 +1125,568 @@ float3 perlin_float3_fractal_distorted(float4 position,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Batched Perlin Noise
+ *
+ * Evaluate 3D perlin noise for many positions at once. With SSE2, four positions are processed
+ * in parallel. The results are the same as those of the single-position functions above, so both
+ * can be mixed freely.
+ * \{ */
+
+#if BLI_HAVE_SSE2
+
+template<int k> BLI_INLINE __m128i hash_bit_rotate_sse(const __m128i x)
+{
+  return _mm_or_si128(_mm_slli_epi32(x, k), _mm_srli_epi32(x, 32 - k));
+}
+
+BLI_INLINE void hash_bit_final_sse(__m128i &a, __m128i &b, __m128i &c)
+{
+  c = _mm_xor_si128(c, b);
+  c = _mm_sub_epi32(c, hash_bit_rotate_sse<14>(b));
+  a = _mm_xor_si128(a, c);
+  a = _mm_sub_epi32(a, hash_bit_rotate_sse<11>(c));
+  b = _mm_xor_si128(b, a);
+  b = _mm_sub_epi32(b, hash_bit_rotate_sse<25>(a));
+  c = _mm_xor_si128(c, b);
+  c = _mm_sub_epi32(c, hash_bit_rotate_sse<16>(b));
+  a = _mm_xor_si128(a, c);
+  a = _mm_sub_epi32(a, hash_bit_rotate_sse<4>(c));
+  b = _mm_xor_si128(b, a);
+  b = _mm_sub_epi32(b, hash_bit_rotate_sse<14>(a));
+  c = _mm_xor_si128(c, b);
+  c = _mm_sub_epi32(c, hash_bit_rotate_sse<24>(b));
+}
+
+/* Same as #hash(uint32_t kx, uint32_t ky, uint32_t kz). */
+BLI_INLINE __m128i hash_sse(const __m128i kx, const __m128i ky, const __m128i kz)
+{
+  const __m128i init = _mm_set1_epi32(int(0xdeadbeef + (3 << 2) + 13));
+  __m128i a = _mm_add_epi32(init, kx);
+  __m128i b = _mm_add_epi32(init, ky);
+  __m128i c = _mm_add_epi32(init, kz);
+  hash_bit_final_sse(a, b, c);
+  return c;
+}
+
+BLI_INLINE __m128 select_sse(const __m128i mask, const __m128 a, const __m128 b)
+{
+  const __m128 mask_ps = _mm_castsi128_ps(mask);
+  return _mm_or_ps(_mm_and_ps(mask_ps, a), _mm_andnot_ps(mask_ps, b));
+}
+
+/* Same as #negate_if, but the condition has to be a single bit that is shifted to the sign bit. */
+template<int bit> BLI_INLINE __m128 negate_if_sse(const __m128 value, const __m128i hash)
+{
+  const __m128i sign = _mm_slli_epi32(_mm_and_si128(hash, _mm_set1_epi32(1 << bit)), 31 - bit);
+  return _mm_xor_ps(value, _mm_castsi128_ps(sign));
+}
+
+/* Same as #noise_grad(uint32_t hash, float x, float y, float z). */
+BLI_INLINE __m128 noise_grad_sse(const __m128i hash,
+                                 const __m128 x,
+                                 const __m128 y,
+                                 const __m128 z)
+{
+  const __m128i h = _mm_and_si128(hash, _mm_set1_epi32(15));
+  const __m128 u = select_sse(_mm_cmplt_epi32(h, _mm_set1_epi32(8)), x, y);
+  const __m128i h_is_12_or_14 = _mm_or_si128(_mm_cmpeq_epi32(h, _mm_set1_epi32(12)),
+                                             _mm_cmpeq_epi32(h, _mm_set1_epi32(14)));
+  const __m128 vt = select_sse(h_is_12_or_14, x, z);
+  const __m128 v = select_sse(_mm_cmplt_epi32(h, _mm_set1_epi32(4)), y, vt);
+  return _mm_add_ps(negate_if_sse<0>(u, h), negate_if_sse<1>(v, h));
+}
+
+BLI_INLINE __m128 floor_sse(const __m128 x)
+{
+#  if BLI_HAVE_SSE4
+  return _mm_floor_ps(x);
+#  else
+  /* Only valid for values that fit into a 32-bit integer, which is checked by the caller. */
+  const __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+  const __m128 correction = _mm_and_ps(_mm_cmpgt_ps(truncated, x), _mm_set1_ps(1.0f));
+  return _mm_sub_ps(truncated, correction);
+#  endif
+}
+
+/* Same as #floor_fraction. */
+BLI_INLINE __m128 floor_fraction_sse(const __m128 x, __m128i &r_i)
+{
+  const __m128 x_floor = floor_sse(x);
+  r_i = _mm_cvttps_epi32(x_floor);
+  return _mm_sub_ps(x, x_floor);
+}
+
+/* Same as #fade. The polynomial is evaluated with double precision like in the scalar version. */
+BLI_INLINE __m128 fade_sse(const __m128 t)
+{
+  const __m128 t3 = _mm_mul_ps(_mm_mul_ps(t, t), t);
+  const auto fade_pd = [](const __m128d t, const __m128d t3) {
+    const __m128d poly = _mm_add_pd(
+        _mm_mul_pd(t, _mm_sub_pd(_mm_mul_pd(t, _mm_set1_pd(6.0)), _mm_set1_pd(15.0))),
+        _mm_set1_pd(10.0));
+    return _mm_cvtpd_ps(_mm_mul_pd(t3, poly));
+  };
+  const __m128 low = fade_pd(_mm_cvtps_pd(t), _mm_cvtps_pd(t3));
+  const __m128 high = fade_pd(_mm_cvtps_pd(_mm_movehl_ps(t, t)),
+                              _mm_cvtps_pd(_mm_movehl_ps(t3, t3)));
+  return _mm_movelh_ps(low, high);
+}
+
+/* Same as #perlin_noise(float3 position). */
+BLI_INLINE __m128 perlin_noise_sse(const __m128 x, const __m128 y, const __m128 z)
+{
+  __m128i X, Y, Z;
+  const __m128 fx = floor_fraction_sse(x, X);
+  const __m128 fy = floor_fraction_sse(y, Y);
+  const __m128 fz = floor_fraction_sse(z, Z);
+
+  const __m128 u = fade_sse(fx);
+  const __m128 v = fade_sse(fy);
+  const __m128 w = fade_sse(fz);
+
+  const __m128i one_i = _mm_set1_epi32(1);
+  const __m128i X1 = _mm_add_epi32(X, one_i);
+  const __m128i Y1 = _mm_add_epi32(Y, one_i);
+  const __m128i Z1 = _mm_add_epi32(Z, one_i);
+
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 fx1 = _mm_sub_ps(fx, one);
+  const __m128 fy1 = _mm_sub_ps(fy, one);
+  const __m128 fz1 = _mm_sub_ps(fz, one);
+
+  const __m128 v0 = noise_grad_sse(hash_sse(X, Y, Z), fx, fy, fz);
+  const __m128 v1 = noise_grad_sse(hash_sse(X1, Y, Z), fx1, fy, fz);
+  const __m128 v2 = noise_grad_sse(hash_sse(X, Y1, Z), fx, fy1, fz);
+  const __m128 v3 = noise_grad_sse(hash_sse(X1, Y1, Z), fx1, fy1, fz);
+  const __m128 v4 = noise_grad_sse(hash_sse(X, Y, Z1), fx, fy, fz1);
+  const __m128 v5 = noise_grad_sse(hash_sse(X1, Y, Z1), fx1, fy, fz1);
+  const __m128 v6 = noise_grad_sse(hash_sse(X, Y1, Z1), fx, fy1, fz1);
+  const __m128 v7 = noise_grad_sse(hash_sse(X1, Y1, Z1), fx1, fy1, fz1);
+
+  /* Trilinear interpolation in the same order as the scalar #mix. */
+  const __m128 u1 = _mm_sub_ps(one, u);
+  const __m128 v_1 = _mm_sub_ps(one, v);
+  const __m128 w1 = _mm_sub_ps(one, w);
+  const auto lerp_x = [&](const __m128 a, const __m128 b) {
+    return _mm_add_ps(_mm_mul_ps(a, u1), _mm_mul_ps(b, u));
+  };
+  const __m128 bottom = _mm_add_ps(_mm_mul_ps(v_1, lerp_x(v0, v1)),
+                                   _mm_mul_ps(v, lerp_x(v2, v3)));
+  const __m128 top = _mm_add_ps(_mm_mul_ps(v_1, lerp_x(v4, v5)), _mm_mul_ps(v, lerp_x(v6, v7)));
+  return _mm_add_ps(_mm_mul_ps(w1, bottom), _mm_mul_ps(w, top));
+}
+
+#endif
+
+void perlin_signed(const Span<float3> positions, MutableSpan<float> r_values)
+{
+  BLI_assert(positions.size() == r_values.size());
+  int64_t i = 0;
+#if BLI_HAVE_SSE2
+  const __m128 sign_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  const __m128 period = _mm_set1_ps(100000.0f);
+  for (; i + 4 <= positions.size(); i += 4) {
+    const float3 *p = positions.data() + i;
+    const __m128 x = _mm_setr_ps(p[0].x, p[1].x, p[2].x, p[3].x);
+    const __m128 y = _mm_setr_ps(p[0].y, p[1].y, p[2].y, p[3].y);
+    const __m128 z = _mm_setr_ps(p[0].z, p[1].z, p[2].z, p[3].z);
+    /* Positions within the period are not changed by the modulo and precision correction in the
+     * scalar version. All other positions (including NaN) are rare and use the scalar code. */
+    const __m128 out_of_period = _mm_or_ps(
+        _mm_or_ps(_mm_cmpnlt_ps(_mm_and_ps(x, sign_mask), period),
+                  _mm_cmpnlt_ps(_mm_and_ps(y, sign_mask), period)),
+        _mm_cmpnlt_ps(_mm_and_ps(z, sign_mask), period));
+    if (_mm_movemask_ps(out_of_period) != 0) {
+      for (const int j : IndexRange(4)) {
+        r_values[i + j] = perlin_signed(p[j]);
+      }
+      continue;
+    }
+    const __m128 result = _mm_mul_ps(perlin_noise_sse(x, y, z), _mm_set1_ps(0.9820f));
+    _mm_storeu_ps(r_values.data() + i, result);
+  }
+#endif
+  for (; i < positions.size(); i++) {
+    r_values[i] = perlin_signed(positions[i]);
+  }
+}
+
+/* Positions are evaluated in chunks so that temporary buffers can be allocated on the stack. */
+static constexpr int64_t perlin_batch_size = 256;
+
+/* Evaluates `perlin_signed(factor * positions[i])` for all positions. */
+static void perlin_signed_scaled(const Span<float3> positions,
+                                 const float factor,
+                                 MutableSpan<float3> tmp_positions,
+                                 MutableSpan<float> r_values)
+{
+  for (const int64_t i : positions.index_range()) {
+    tmp_positions[i] = factor * positions[i];
+  }
+  perlin_signed(tmp_positions.take_front(positions.size()), r_values);
+}
+
+static void perlin_fbm_batch(const Span<float3> positions,
+                             const float detail,
+                             const float roughness,
+                             const float lacunarity,
+                             const bool normalize,
+                             MutableSpan<float> r_values)
+{
+  std::array<float3, perlin_batch_size> tmp_buffer;
+  const MutableSpan<float3> tmp_positions = tmp_buffer;
+  std::array<float, perlin_batch_size> noise_buffer;
+  const MutableSpan<float> noise = MutableSpan(noise_buffer).take_front(positions.size());
+  MutableSpan<float> sum = r_values;
+
+  float fscale = 1.0f;
+  float amp = 1.0f;
+  float maxamp = 0.0f;
+  sum.fill(0.0f);
+
+  for (int i = 0; i <= int(detail); i++) {
+    perlin_signed_scaled(positions, fscale, tmp_positions, noise);
+    for (const int64_t j : sum.index_range()) {
+      sum[j] += noise[j] * amp;
+    }
+    maxamp += amp;
+    amp *= roughness;
+    fscale *= lacunarity;
+  }
+  float rmd = detail - std::floor(detail);
+  if (rmd != 0.0f) {
+    perlin_signed_scaled(positions, fscale, tmp_positions, noise);
+    for (const int64_t j : sum.index_range()) {
+      float sum2 = sum[j] + noise[j] * amp;
+      r_values[j] = normalize ? mix(0.5f * sum[j] / maxamp + 0.5f,
+                                    0.5f * sum2 / (maxamp + amp) + 0.5f,
+                                    rmd) :
+                                mix(sum[j], sum2, rmd);
+    }
+    return;
+  }
+  if (normalize) {
+    for (const int64_t j : sum.index_range()) {
+      r_values[j] = 0.5f * sum[j] / maxamp + 0.5f;
+    }
+  }
+}
+
+static void perlin_multi_fractal_batch(const Span<float3> positions,
+                                       const float detail,
+                                       const float roughness,
+                                       const float lacunarity,
+                                       MutableSpan<float> r_values)
+{
+  std::array<float3, perlin_batch_size> p_buffer;
+  std::array<float, perlin_batch_size> noise_buffer;
+  const MutableSpan<float3> p = MutableSpan(p_buffer).take_front(positions.size());
+  const MutableSpan<float> noise = MutableSpan(noise_buffer).take_front(positions.size());
+  MutableSpan<float> value = r_values;
+  p.copy_from(positions);
+
+  float pwr = 1.0f;
+  value.fill(1.0f);
+
+  for (int i = 0; i <= int(detail); i++) {
+    perlin_signed(p, noise);
+    for (const int64_t j : value.index_range()) {
+      value[j] *= (pwr * noise[j] + 1.0f);
+      p[j] *= lacunarity;
+    }
+    pwr *= roughness;
+  }
+
+  const float rmd = detail - floorf(detail);
+  if (rmd != 0.0f) {
+    perlin_signed(p, noise);
+    for (const int64_t j : value.index_range()) {
+      value[j] *= (rmd * pwr * noise[j] + 1.0f);
+    }
+  }
+}
+
+static void perlin_hetero_terrain_batch(const Span<float3> positions,
+                                        const float detail,
+                                        const float roughness,
+                                        const float lacunarity,
+                                        const float offset,
+                                        MutableSpan<float> r_values)
+{
+  std::array<float3, perlin_batch_size> p_buffer;
+  std::array<float, perlin_batch_size> noise_buffer;
+  const MutableSpan<float3> p = MutableSpan(p_buffer).take_front(positions.size());
+  const MutableSpan<float> noise = MutableSpan(noise_buffer).take_front(positions.size());
+  MutableSpan<float> value = r_values;
+  p.copy_from(positions);
+
+  float pwr = roughness;
+
+  /* First unscaled octave of function; later octaves are scaled. */
+  perlin_signed(p, noise);
+  for (const int64_t j : value.index_range()) {
+    value[j] = offset + noise[j];
+    p[j] *= lacunarity;
+  }
+
+  for (int i = 1; i <= int(detail); i++) {
+    perlin_signed(p, noise);
+    for (const int64_t j : value.index_range()) {
+      float increment = (noise[j] + offset) * pwr * value[j];
+      value[j] += increment;
+      p[j] *= lacunarity;
+    }
+    pwr *= roughness;
+  }
+
+  const float rmd = detail - floorf(detail);
+  if (rmd != 0.0f) {
+    perlin_signed(p, noise);
+    for (const int64_t j : value.index_range()) {
+      float increment = (noise[j] + offset) * pwr * value[j];
+      value[j] += rmd * increment;
+    }
+  }
+}
+
+static void perlin_hybrid_multi_fractal_batch(const Span<float3> positions,
+                                              const float detail,
+                                              const float roughness,
+                                              const float lacunarity,
+                                              const float offset,
+                                              const float gain,
+                                              MutableSpan<float> r_values)
+{
+  std::array<float3, perlin_batch_size> p_buffer;
+  std::array<float, perlin_batch_size> noise_buffer;
+  std::array<float, perlin_batch_size> weight_buffer;
+  const MutableSpan<float3> p = MutableSpan(p_buffer).take_front(positions.size());
+  const MutableSpan<float> noise = MutableSpan(noise_buffer).take_front(positions.size());
+  const MutableSpan<float> weight = MutableSpan(weight_buffer).take_front(positions.size());
+  MutableSpan<float> value = r_values;
+  p.copy_from(positions);
+
+  /* Unlike the other fractals, the number of octaves depends on the position. Positions whose
+   * weight dropped below the threshold are still evaluated but don't change anymore. */
+  float pwr = 1.0f;
+  value.fill(0.0f);
+  weight.fill(1.0f);
+
+  const auto any_active = [&]() {
+    return std::any_of(weight.begin(), weight.end(), [](const float w) { return w > 0.001f; });
+  };
+
+  for (int i = 0; i <= int(detail) && any_active(); i++) {
+    perlin_signed(p, noise);
+    for (const int64_t j : value.index_range()) {
+      if (weight[j] > 0.001f) {
+        weight[j] = std::min(weight[j], 1.0f);
+        float signal = (noise[j] + offset) * pwr;
+        value[j] += weight[j] * signal;
+        weight[j] *= gain * signal;
+      }
+      p[j] *= lacunarity;
+    }
+    pwr *= roughness;
+  }
+
+  const float rmd = detail - floorf(detail);
+  if ((rmd != 0.0f) && any_active()) {
+    perlin_signed(p, noise);
+    for (const int64_t j : value.index_range()) {
+      if (weight[j] > 0.001f) {
+        float signal = (noise[j] + offset) * pwr;
+        value[j] += rmd * std::min(weight[j], 1.0f) * signal;
+      }
+    }
+  }
+}
+
+static void perlin_ridged_multi_fractal_batch(const Span<float3> positions,
+                                              const float detail,
+                                              const float roughness,
+                                              const float lacunarity,
+                                              const float offset,
+                                              const float gain,
+                                              MutableSpan<float> r_values)
+{
+  std::array<float3, perlin_batch_size> p_buffer;
+  std::array<float, perlin_batch_size> noise_buffer;
+  std::array<float, perlin_batch_size> signal_buffer;
+  const MutableSpan<float3> p = MutableSpan(p_buffer).take_front(positions.size());
+  const MutableSpan<float> noise = MutableSpan(noise_buffer).take_front(positions.size());
+  const MutableSpan<float> signal = MutableSpan(signal_buffer).take_front(positions.size());
+  MutableSpan<float> value = r_values;
+  p.copy_from(positions);
+
+  float pwr = roughness;
+
+  perlin_signed(p, noise);
+  for (const int64_t j : value.index_range()) {
+    signal[j] = offset - std::abs(noise[j]);
+    signal[j] *= signal[j];
+    value[j] = signal[j];
+  }
+
+  for (int i = 1; i <= int(detail); i++) {
+    for (const int64_t j : value.index_range()) {
+      p[j] *= lacunarity;
+    }
+    perlin_signed(p, noise);
+    for (const int64_t j : value.index_range()) {
+      const float weight = std::clamp(signal[j] * gain, 0.0f, 1.0f);
+      signal[j] = offset - std::abs(noise[j]);
+      signal[j] *= signal[j];
+      signal[j] *= weight;
+      value[j] += signal[j] * pwr;
+    }
+    pwr *= roughness;
+  }
+}
+
+static void perlin_select_batch(const Span<float3> positions,
+                                const float detail,
+                                const float roughness,
+                                const float lacunarity,
+                                const float offset,
+                                const float gain,
+                                const int type,
+                                const bool normalize,
+                                MutableSpan<float> r_values)
+{
+  switch (type) {
+    case NOISE_SHD_PERLIN_MULTIFRACTAL: {
+      perlin_multi_fractal_batch(positions, detail, roughness, lacunarity, r_values);
+      break;
+    }
+    case NOISE_SHD_PERLIN_FBM: {
+      perlin_fbm_batch(positions, detail, roughness, lacunarity, normalize, r_values);
+      break;
+    }
+    case NOISE_SHD_PERLIN_HYBRID_MULTIFRACTAL: {
+      perlin_hybrid_multi_fractal_batch(
+          positions, detail, roughness, lacunarity, offset, gain, r_values);
+      break;
+    }
+    case NOISE_SHD_PERLIN_RIDGED_MULTIFRACTAL: {
+      perlin_ridged_multi_fractal_batch(
+          positions, detail, roughness, lacunarity, offset, gain, r_values);
+      break;
+    }
+    case NOISE_SHD_PERLIN_HETERO_TERRAIN: {
+      perlin_hetero_terrain_batch(positions, detail, roughness, lacunarity, offset, r_values);
+      break;
+    }
+    default: {
+      r_values.fill(0.0f);
+      break;
+    }
+  }
+}
+
+/* Same as #perlin_distortion(float3 position, float strength), applied to all positions. */
+static void perlin_distortion_batch(const Span<float3> positions,
+                                    const float strength,
+                                    MutableSpan<float3> r_distorted)
+{
+  r_distorted.copy_from(positions);
+  if (strength == 0.0f) {
+    return;
+  }
+  std::array<float3, perlin_batch_size> tmp_buffer;
+  std::array<float, perlin_batch_size> noise_buffer;
+  const MutableSpan<float3> tmp = MutableSpan(tmp_buffer).take_front(positions.size());
+  const MutableSpan<float> noise = MutableSpan(noise_buffer).take_front(positions.size());
+  for (const int axis : IndexRange(3)) {
+    const float3 offset = random_float3_offset(float(axis));
+    for (const int64_t i : positions.index_range()) {
+      tmp[i] = positions[i] + offset;
+    }
+    perlin_signed(tmp, noise);
+    for (const int64_t i : positions.index_range()) {
+      r_distorted[i][axis] += noise[i] * strength;
+    }
+  }
+}
+
+void perlin_fractal_distorted(const Span<float3> positions,
+                              const float detail,
+                              const float roughness,
+                              const float lacunarity,
+                              const float offset,
+                              const float gain,
+                              const float distortion,
+                              const int type,
+                              const bool normalize,
+                              MutableSpan<float> r_values)
+{
+  BLI_assert(positions.size() == r_values.size());
+  std::array<float3, perlin_batch_size> distorted_buffer;
+  for (int64_t start = 0; start < positions.size(); start += perlin_batch_size) {
+    const IndexRange range(start, std::min(perlin_batch_size, positions.size() - start));
+    const MutableSpan<float3> distorted = MutableSpan(distorted_buffer).take_front(range.size());
+    perlin_distortion_batch(positions.slice(range), distortion, distorted);
+    perlin_select_batch(distorted,
+                        detail,
+                        roughness,
+                        lacunarity,
+                        offset,
+                        gain,
+                        type,
+                        normalize,
+                        r_values.slice(range));
+  }
+}
+
+void perlin_float3_fractal_distorted(const Span<float3> positions,
+                                     const float detail,
+                                     const float roughness,
+                                     const float lacunarity,
+                                     const float offset,
+                                     const float gain,
+                                     const float distortion,
+                                     const int type,
+                                     const bool normalize,
+                                     MutableSpan<float3> r_values)
+{
+  BLI_assert(positions.size() == r_values.size());
+  std::array<float3, perlin_batch_size> distorted_buffer;
+  std::array<float3, perlin_batch_size> shifted_buffer;
+  std::array<float, perlin_batch_size> component_buffer;
+  for (int64_t start = 0; start < positions.size(); start += perlin_batch_size) {
+    const IndexRange range(start, std::min(perlin_batch_size, positions.size() - start));
+    const MutableSpan<float3> distorted = MutableSpan(distorted_buffer).take_front(range.size());
+    const MutableSpan<float3> shifted = MutableSpan(shifted_buffer).take_front(range.size());
+    const MutableSpan<float> component = MutableSpan(component_buffer).take_front(range.size());
+    MutableSpan<float3> values = r_values.slice(range);
+    perlin_distortion_batch(positions.slice(range), distortion, distorted);
+    for (const int axis : IndexRange(3)) {
+      /* The first component is evaluated without an offset, matching the scalar version. */
+      if (axis > 0) {
+        const float3 axis_offset = random_float3_offset(float(axis + 2));
+        for (const int64_t i : range.index_range()) {
+          shifted[i] = distorted[i] + axis_offset;
+        }
+      }
+      perlin_select_batch(axis == 0 ? distorted : shifted,
+                          detail,
+                          roughness,
+                          lacunarity,
+                          offset,
+                          gain,
+                          type,
+                          normalize,
+                          component);
+      for (const int64_t i : range.index_range()) {
+        values[i][axis] = component[i];
+      }
+    }
+  }
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Voronoi Noise
  *
@@ -8,9 +8,12 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_array.hh"
 #include "BLI_compiler_attrs.hh"
 #include "BLI_kdopbvh.hh"
+#include "BLI_math_vector.hh"
 #include "BLI_math_vector_c.hh"
+#include "BLI_math_vector_types.hh"
 #include "BLI_rand_c.hh"
 
 namespace blender {
@@ -71,7 +74,12 @@ static void optimal_check_callback(void *userdata,
  * Use rounding to ensure very close nodes don't cause the wrong node to be found as nearest.
  */
 static void find_nearest_points_test(
-    int points_len, float scale, int round, int random_seed, bool optimal = false)
+    int points_len,
+    float scale,
+    int round,
+    int random_seed,
+    bool optimal = false,
+    BVHTreeBuildMethod build_method = BVHTreeBuildMethod::Median)
 {
   RNG *rng = BLI_rng_new(random_seed);
   BVHTree *tree = BLI_bvhtree_new(points_len, 0.0, 8, 8);
@@ -83,7 +91,7 @@ static void find_nearest_points_test(
     rng_v3_round(points[i], 3, rng, round, scale);
     BLI_bvhtree_insert(tree, i, points[i], 1);
   }
-  BLI_bvhtree_balance(tree);
+  BLI_bvhtree_balance_ex(tree, build_method);
 
   /* first find each point */
   BVHTree_NearestPointCallback callback = optimal ? optimal_check_callback : nullptr;
@@ -137,4 +145,100 @@ TEST(kdopbvh, OptimalFindNearest_500)
   find_nearest_points_test(500, 1.0, 1000, 12, true);
 }
 
+TEST(kdopbvh, FindNearest_Morton_2)
+{
+  find_nearest_points_test(2, 1.0, 1000, 123, false, BVHTreeBuildMethod::Morton);
+}
+TEST(kdopbvh, FindNearest_Morton_500)
+{
+  find_nearest_points_test(500, 1.0, 1000, 12, false, BVHTreeBuildMethod::Morton);
+}
+TEST(kdopbvh, OptimalFindNearest_Morton_500)
+{
+  find_nearest_points_test(500, 1.0, 1000, 12, true, BVHTreeBuildMethod::Morton);
+}
+
+static void ray_cast_batch_test(const int tree_type, const int axis)
+{
+  const int boxes_len = 1000;
+  const int rays_len = 1001;
+  RNG *rng = BLI_rng_new(7);
+  BVHTree *tree = BLI_bvhtree_new(boxes_len, 0.0, tree_type, axis);
+  for (int i = 0; i < boxes_len; i++) {
+    float3 corners[2];
+    rng_v3_round(corners[0], 3, rng, 1000, 1.0f);
+    corners[1] = corners[0] + float3(0.01f + BLI_rng_get_float(rng) * 0.1f);
+    BLI_bvhtree_insert(tree, i, corners[0], 2);
+  }
+  BLI_bvhtree_balance(tree);
+
+  Array<float3> origins(rays_len);
+  Array<float3> directions(rays_len);
+  Array<BVHTreeRayHit> hits(rays_len);
+  for (int i = 0; i < rays_len; i++) {
+    rng_v3_round(origins[i], 2, rng, 1000, 1.0f);
+    origins[i].z = 5.0f;
+    directions[i] = math::normalize(
+        float3(BLI_rng_get_float(rng) - 0.5f, BLI_rng_get_float(rng) - 0.5f, -5.0f));
+    hits[i].index = -1;
+    hits[i].dist = BVH_RAYCAST_DIST_MAX;
+  }
+  BLI_bvhtree_ray_cast_batch(tree, origins, directions, hits, nullptr, nullptr);
+
+  for (int i = 0; i < rays_len; i++) {
+    BVHTreeRayHit hit;
+    hit.index = -1;
+    hit.dist = BVH_RAYCAST_DIST_MAX;
+    BLI_bvhtree_ray_cast(tree, origins[i], directions[i], 0.0f, &hit, nullptr, nullptr);
+    EXPECT_EQ(hits[i].index, hit.index);
+    if (hit.index != -1) {
+      EXPECT_FLOAT_EQ(hits[i].dist, hit.dist);
+    }
+  }
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+}
+
+TEST(kdopbvh, RayCastBatch)
+{
+  ray_cast_batch_test(2, 6);
+}
+TEST(kdopbvh, RayCastBatch_14DOP)
+{
+  ray_cast_batch_test(4, 14);
+}
+TEST(kdopbvh, RayCastBatch_18DOP)
+{
+  ray_cast_batch_test(4, 18);
+}
+
+TEST(kdopbvh, Refit)
+{
+  const int points_len = 500;
+  RNG *rng = BLI_rng_new(42);
+  BVHTree *tree = BLI_bvhtree_new(points_len, 0.0, 4, 6);
+
+  Array<float3> points(points_len);
+  for (int i = 0; i < points_len; i++) {
+    rng_v3_round(points[i], 3, rng, 1000, 1.0f);
+    BLI_bvhtree_insert(tree, i, points[i], 1);
+  }
+  BLI_bvhtree_balance(tree);
+
+  /* Move all points far away, the tree topology stays the same. */
+  for (int i = 0; i < points_len; i++) {
+    points[i] += float3(10.0f, -5.0f, 2.0f);
+    BLI_bvhtree_update_node(tree, i, points[i], nullptr, 1);
+  }
+  BLI_bvhtree_update_tree(tree);
+
+  for (int i = 0; i < points_len; i++) {
+    const int j = BLI_bvhtree_find_nearest(tree, points[i], nullptr, nullptr, nullptr);
+    EXPECT_GE(j, 0);
+    EXPECT_EQ(points[i], points[j]);
+  }
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+}
+
 }  // namespace blender
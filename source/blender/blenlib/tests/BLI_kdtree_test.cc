@@ -0,0 +1,137 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_array.hh"
+#include "BLI_index_mask.hh"
+#include "BLI_kdtree.hh"
+#include "BLI_math_vector.hh"
+#include "BLI_rand.hh"
+
+namespace blender::tests {
+
+static Array<float3> random_positions(const int size, const uint32_t seed)
+{
+  RandomNumberGenerator rng(seed);
+  Array<float3> positions(size);
+  for (float3 &position : positions) {
+    position = float3(rng.get_float(), rng.get_float(), rng.get_float()) * 10.0f;
+  }
+  return positions;
+}
+
+static KDTree<float3> *build_tree(const Span<float3> positions)
+{
+  KDTree<float3> *tree = kdtree_new<float3>(uint(positions.size()));
+  for (const int i : positions.index_range()) {
+    kdtree_insert<float3>(tree, i, positions[i]);
+  }
+  kdtree_balance<float3>(tree);
+  return tree;
+}
+
+/** Nearest position by brute force, skipping \a skip_index. */
+static int find_nearest_brute_force(const Span<float3> positions,
+                                    const float3 &co,
+                                    const int skip_index = -1)
+{
+  int nearest = -1;
+  float nearest_dist_sq = FLT_MAX;
+  for (const int i : positions.index_range()) {
+    const float dist_sq = math::distance_squared(positions[i], co);
+    if (i != skip_index && dist_sq < nearest_dist_sq) {
+      nearest = i;
+      nearest_dist_sq = dist_sq;
+    }
+  }
+  return nearest;
+}
+
+/* Large enough for the sub-trees to be balanced in parallel. */
+static constexpr int large_tree_size = 100000;
+
+TEST(kdtree, BalanceParallelFindNearest)
+{
+  const Array<float3> positions = random_positions(large_tree_size, 1);
+  const Array<float3> queries = random_positions(1000, 2);
+  KDTree<float3> *tree = build_tree(positions);
+
+  for (const float3 &query : queries) {
+    KDTreeNearest<float3> nearest;
+    const int index = kdtree_find_nearest<float3>(tree, query, &nearest);
+    EXPECT_EQ(index, find_nearest_brute_force(positions, query));
+    EXPECT_EQ(nearest.index, index);
+    EXPECT_FLOAT_EQ(nearest.dist, math::distance(positions[index], query));
+  }
+  kdtree_free<float3>(tree);
+}
+
+TEST(kdtree, BalanceParallelRangeSearch)
+{
+  const Array<float3> positions = random_positions(large_tree_size, 3);
+  const Array<float3> queries = random_positions(100, 4);
+  KDTree<float3> *tree = build_tree(positions);
+
+  const float range = 0.5f;
+  for (const float3 &query : queries) {
+    Vector<int> found;
+    kdtree_range_search_cb<float3>(
+        tree, query, range, [&](const int index, const float3 & /*co*/, float /*dist_sq*/) {
+          found.append(index);
+          return true;
+        });
+    std::sort(found.begin(), found.end());
+
+    Vector<int> expected;
+    for (const int i : positions.index_range()) {
+      if (math::distance_squared(positions[i], query) <= range * range) {
+        expected.append(i);
+      }
+    }
+    EXPECT_EQ_SPAN<int>(expected, found);
+  }
+  kdtree_free<float3>(tree);
+}
+
+TEST(kdtree, FindNearestBatch)
+{
+  const Array<float3> positions = random_positions(large_tree_size, 5);
+  KDTree<float3> *tree = build_tree(positions);
+
+  /* Find the nearest other point of every second point, like the Index of Nearest node. */
+  IndexMaskMemory memory;
+  const IndexMask mask = IndexMask::from_predicate(
+      positions.index_range(), memory, [](const int i) { return i % 2 == 0; });
+  Array<int> indices(positions.size(), -2);
+  kdtree_find_nearest_batch_cb<float3>(
+      tree,
+      positions,
+      mask,
+      indices,
+      [](const int query, const int index, const float3 & /*co*/, const float /*dist_sq*/) {
+        return query == index ? 0 : 1;
+      });
+
+  for (const int i : positions.index_range()) {
+    if (!mask.contains(i)) {
+      EXPECT_EQ(indices[i], -2);
+      continue;
+    }
+    const int expected = kdtree_find_nearest_cb<float3>(
+        tree,
+        positions[i],
+        nullptr,
+        [&](const int index, const float3 & /*co*/, const float /*dist_sq*/) {
+          return index == i ? 0 : 1;
+        });
+    EXPECT_EQ(indices[i], expected);
+    if (i % 1000 == 0) {
+      EXPECT_EQ(indices[i], find_nearest_brute_force(positions, positions[i], i));
+    }
+  }
+  kdtree_free<float3>(tree);
+}
+
+}  // namespace blender::tests
@@ -0,0 +1,67 @@
+/* SPDX-FileCopyrightText: 2025 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_array.hh"
+#include "BLI_noise.hh"
+#include "BLI_rand.hh"
+
+namespace blender::noise::tests {
+
+/* The batched functions may only differ from the scalar ones when the compiler contracts
+ * floating point operations differently. */
+static constexpr float batch_tolerance = 1e-5f;
+
+static Array<float3> random_positions(const int64_t size)
+{
+  RandomNumberGenerator rng(42);
+  Array<float3> positions(size);
+  for (float3 &position : positions) {
+    position = (float3(rng.get_float(), rng.get_float(), rng.get_float()) - 0.5f) * 200.0f;
+  }
+  /* Positions outside of the repetition period use the scalar code path. */
+  positions[5] = float3(250000.0f, 1.0f, -2.0f);
+  positions[6] = float3(-3.0f, 0.0f, -0.0f);
+  positions[7] = float3(2000000.0f, 5.0f, 5.0f);
+  return positions;
+}
+
+TEST(noise, PerlinSignedBatch)
+{
+  /* Not a multiple of the SIMD width to also test the remainder. */
+  const Array<float3> positions = random_positions(1003);
+  Array<float> values(positions.size());
+  perlin_signed(positions, values);
+  for (const int64_t i : positions.index_range()) {
+    EXPECT_NEAR(values[i], perlin_signed(positions[i]), batch_tolerance);
+  }
+}
+
+TEST(noise, PerlinFractalDistortedBatch)
+{
+  const Array<float3> positions = random_positions(1003);
+  Array<float> values(positions.size());
+  Array<float3> colors(positions.size());
+  for (const int type : IndexRange(5)) {
+    for (const float detail : {0.0f, 2.0f, 3.7f}) {
+      for (const float distortion : {0.0f, 1.3f}) {
+        perlin_fractal_distorted(
+            positions, detail, 0.6f, 2.1f, 0.7f, 1.5f, distortion, type, true, values);
+        perlin_float3_fractal_distorted(
+            positions, detail, 0.6f, 2.1f, 0.7f, 1.5f, distortion, type, true, colors);
+        for (const int64_t i : positions.index_range()) {
+          const float expected_value = perlin_fractal_distorted(
+              positions[i], detail, 0.6f, 2.1f, 0.7f, 1.5f, distortion, type, true);
+          const float3 expected_color = perlin_float3_fractal_distorted(
+              positions[i], detail, 0.6f, 2.1f, 0.7f, 1.5f, distortion, type, true);
+          EXPECT_NEAR(values[i], expected_value, batch_tolerance);
+          EXPECT_V3_NEAR(colors[i], expected_color, batch_tolerance);
+        }
+      }
+    }
+  }
+}
+
+}  // namespace blender::noise::tests
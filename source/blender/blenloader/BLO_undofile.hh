@@ -31,12 +31,25 @@ struct MemFileSharedStorage {
   ~MemFileSharedStorage();
 };
 
+/**
+ * The content of #MemFileChunk buffers, shared by all chunks with the same content in any undo
+ * step. Defined in `undofile.cc`.
+ */
+struct MemFileChunkData;
+/**
+ * Owns the #MemFileChunkData of all memfiles that were written with each other as reference,
+ * i.e. all memfile undo steps of an undo stack. Defined in `undofile.cc`.
+ */
+struct MemFileChunkStorage;
+
 struct MemFileChunk {
   void *next, *prev;
   const char *buf;
   /** Size in bytes. */
   size_t size;
-  /** When true, this chunk doesn't own the memory, it's shared with a previous #MemFileChunk */
+  /** The shared owner of #buf, each chunk is a user of it. */
+  MemFileChunkData *data;
+  /** When true, this chunk is identical to the matching #MemFileChunk of the previous step. */
   bool is_identical;
   /** When true, this chunk is also identical to the one in the next step (used by undo code to
    * detect unchanged IDs).
@@ -55,6 +68,8 @@ struct MemFile {
    * without making a copy. This is faster and requires less memory.
    */
   MemFileSharedStorage *shared_storage;
+  /** Shared with the other memfiles of the undo stack, freed with the last one. */
+  MemFileChunkStorage *chunk_storage;
 };
 
 struct MemFileWriteData {
@@ -101,6 +116,10 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
  */
 /* **************** support for memory-write, for undo buffers *************** */
 
+/**
+ * Data of freed chunks that is still used by other memfiles is counted in the size of the oldest
+ * one using it, so the size of other memfiles can change.
+ */
 void BLO_memfile_free(MemFile *memfile);
 /**
  * Result is that 'first' is being freed.
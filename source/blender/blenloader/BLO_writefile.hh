@@ -38,6 +38,14 @@ enum eBLO_WritePathRemap {
   BLO_WRITE_PATH_REMAP_ABSOLUTE = 3,
 };
 
+/** Statistics of a written file, see #BlendFileWriteParams::r_stats. */
+struct BlendFileWriteStats {
+  /** Number of compressed frames, not counting the frame index. */
+  int frames_num = 0;
+  /** Number of compressed frames copied from the overwritten file instead of compressed. */
+  int frames_reused_num = 0;
+};
+
 /** Similar to #BlendFileReadParams. */
 struct BlendFileWriteParams {
   eBLO_WritePathRemap remap_mode = {};
@@ -49,6 +57,8 @@ struct BlendFileWriteParams {
   /** This is writing a copy/paste buffer, not a regular blendfile. */
   uint is_copypaste_buffer : 1 = false;
   const BlendThumbnail *thumb = nullptr;
+  /** Optional, filled in when writing the file succeeded. */
+  BlendFileWriteStats *r_stats = nullptr;
 };
 
 /**
@@ -16,7 +16,6 @@
 #include "BLI_ghash.hh"
 #include "BLI_linklist.hh"
 #include "BLI_path_utils.hh" /* Only for assertions. */
-#include "BLI_set.hh"
 #include "BLI_string.hh"
 #include "BLI_utildefines.hh"
 
@@ -124,26 +123,20 @@ LinkNode *BLO_blendhandle_get_datablock_names(BlendHandle *bh,
 {
   FileData *fd = reinterpret_cast<FileData *>(bh);
   LinkNode *names = nullptr;
-  BHead *bhead;
   int tot = 0;
 
-  for (bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
-    if (bhead->code == ofblocktype) {
-      const char *idname;
-      short idflag;
-      AssetMetaData *asset_meta_data;
-      if (!blendhandle_load_id_data_and_validate(
-              fd, bhead, use_assets_only, idname, idflag, asset_meta_data, nullptr))
-      {
-        continue;
-      }
-
-      BLI_linklist_prepend(&names, BLI_strdup(idname + 2));
-      tot++;
-    }
-    else if (bhead->code == BLO_CODE_ENDB) {
-      break;
+  for (BHead *bhead : blo_bhead_id_index_ensure(fd).bheads_by_code.lookup(ofblocktype)) {
+    const char *idname;
+    short idflag;
+    AssetMetaData *asset_meta_data;
+    if (!blendhandle_load_id_data_and_validate(
+            fd, bhead, use_assets_only, idname, idflag, asset_meta_data, nullptr))
+    {
+      continue;
     }
+
+    BLI_linklist_prepend(&names, BLI_strdup(idname + 2));
+    tot++;
   }
 
   *r_tot_names = tot;
@@ -157,69 +150,58 @@ LinkNode *BLO_blendhandle_get_datablock_info(BlendHandle *bh,
 {
   FileData *fd = reinterpret_cast<FileData *>(bh);
   LinkNode *infos = nullptr;
-  BHead *bhead;
   int tot = 0;
 
   const bool is_library = (ofblocktype == ID_LI);
 
   const int sdna_nr_preview_image = DNA_struct_find_with_alias(fd->filesdna.get(), "PreviewImage");
 
-  for (bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
-    if (bhead->code == BLO_CODE_ENDB) {
-      break;
+  for (BHead *id_bhead : blo_bhead_id_index_ensure(fd).bheads_by_code.lookup(ofblocktype)) {
+    const char *idname;
+    short idflag;
+    AssetMetaData *asset_meta_data;
+    BLODataBlockInfo::Library library_data;
+    if (!blendhandle_load_id_data_and_validate(fd,
+                                               id_bhead,
+                                               use_assets_only,
+                                               idname,
+                                               idflag,
+                                               asset_meta_data,
+                                               is_library ? &library_data : nullptr))
+    {
+      continue;
     }
-    if (bhead->code == ofblocktype) {
-      BHead *id_bhead = bhead;
-
-      const char *idname;
-      short idflag;
-      AssetMetaData *asset_meta_data;
-      BLODataBlockInfo::Library library_data;
-      if (!blendhandle_load_id_data_and_validate(fd,
-                                                 id_bhead,
-                                                 use_assets_only,
-                                                 idname,
-                                                 idflag,
-                                                 asset_meta_data,
-                                                 is_library ? &library_data : nullptr))
-      {
-        continue;
-      }
 
-      const char *name = idname + 2;
-      BLODataBlockInfo *info = MEM_new<BLODataBlockInfo>(__func__);
+    const char *name = idname + 2;
+    BLODataBlockInfo *info = MEM_new<BLODataBlockInfo>(__func__);
 
-      if (is_library) {
-        info->library_data = library_data;
-      }
+    if (is_library) {
+      info->library_data = library_data;
+    }
 
-      /* Lastly, read asset data from the following blocks. */
-      if (asset_meta_data) {
-        bhead = blo_read_asset_data_block(fd, bhead, &asset_meta_data);
-        /* blo_read_asset_data_block() reads all DATA heads and already advances bhead to the
-         * next non-DATA one. Go back, so the loop doesn't skip the non-DATA head. */
-        bhead = blo_bhead_prev(fd, bhead);
-      }
+    /* Lastly, read asset data from the following blocks. */
+    if (asset_meta_data) {
+      blo_read_asset_data_block(fd, id_bhead, &asset_meta_data);
+    }
 
-      STRNCPY(info->name, name);
-      info->asset_data = asset_meta_data;
-      info->free_asset_data = true;
-
-      bool has_preview = false;
-      /* See if we can find a preview in the data of this ID. */
-      for (BHead *data_bhead = blo_bhead_next(fd, id_bhead); data_bhead->code == BLO_CODE_DATA;
-           data_bhead = blo_bhead_next(fd, data_bhead))
-      {
-        if (data_bhead->SDNAnr == sdna_nr_preview_image) {
-          has_preview = true;
-          break;
-        }
-      }
-      info->no_preview_found = !has_preview;
+    STRNCPY(info->name, name);
+    info->asset_data = asset_meta_data;
+    info->free_asset_data = true;
 
-      BLI_linklist_prepend(&infos, info);
-      tot++;
+    bool has_preview = false;
+    /* See if we can find a preview in the data of this ID. */
+    for (BHead *data_bhead = blo_bhead_next(fd, id_bhead); data_bhead->code == BLO_CODE_DATA;
+         data_bhead = blo_bhead_next(fd, data_bhead))
+    {
+      if (data_bhead->SDNAnr == sdna_nr_preview_image) {
+        has_preview = true;
+        break;
+      }
     }
+    info->no_preview_found = !has_preview;
+
+    BLI_linklist_prepend(&infos, info);
+    tot++;
   }
 
   *r_tot_info_items = tot;
@@ -275,37 +257,36 @@ PreviewImage *BLO_blendhandle_get_preview_for_id(BlendHandle *bh,
                                                  const char *name)
 {
   FileData *fd = reinterpret_cast<FileData *>(bh);
-  bool looking = false;
   const int sdna_preview_image = DNA_struct_find_with_alias(fd->filesdna.get(), "PreviewImage");
 
-  for (BHead *bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
-    if (bhead->code == BLO_CODE_DATA) {
-      if (looking && bhead->SDNAnr == sdna_preview_image) {
-        PreviewImage *preview_from_file = static_cast<PreviewImage *>(
-            BLO_library_read_struct(fd, bhead, "PreviewImage"));
-
-        if (preview_from_file == nullptr) {
-          break;
-        }
-
-        PreviewImage *result = MEM_dupalloc(preview_from_file);
-        result->runtime = MEM_new<bke::PreviewImageRuntime>(__func__);
-        bhead = blo_blendhandle_read_preview_rects(fd, bhead, result, preview_from_file);
-        MEM_delete(preview_from_file);
-        return result;
-      }
+  for (BHead *id_bhead : blo_bhead_id_index_ensure(fd).bheads_by_code.lookup(ofblocktype)) {
+    const char *idname = blo_bhead_id_name(fd, id_bhead);
+    if (!idname || !STREQ(&idname[2], name)) {
+      continue;
     }
-    else if (looking || bhead->code == BLO_CODE_ENDB) {
-      /* We were looking for a preview image, but didn't find any belonging to block. So it doesn't
-       * exist. */
-      break;
-    }
-    else if (bhead->code == ofblocktype) {
-      const char *idname = blo_bhead_id_name(fd, bhead);
-      if (idname && STREQ(&idname[2], name)) {
-        looking = true;
+
+    for (BHead *bhead = blo_bhead_next(fd, id_bhead); bhead && bhead->code == BLO_CODE_DATA;
+         bhead = blo_bhead_next(fd, bhead))
+    {
+      if (bhead->SDNAnr != sdna_preview_image) {
+        continue;
+      }
+      PreviewImage *preview_from_file = static_cast<PreviewImage *>(
+          BLO_library_read_struct(fd, bhead, "PreviewImage"));
+
+      if (preview_from_file == nullptr) {
+        break;
       }
+
+      PreviewImage *result = MEM_dupalloc(preview_from_file);
+      result->runtime = MEM_new<bke::PreviewImageRuntime>(__func__);
+      bhead = blo_blendhandle_read_preview_rects(fd, bhead, result, preview_from_file);
+      MEM_delete(preview_from_file);
+      return result;
     }
+    /* We found the block we were looking for, but it has no preview image, so it doesn't
+     * exist. */
+    break;
   }
 
   return nullptr;
@@ -314,22 +295,11 @@ PreviewImage *BLO_blendhandle_get_preview_for_id(BlendHandle *bh,
 LinkNode *BLO_blendhandle_get_linkable_groups(BlendHandle *bh)
 {
   FileData *fd = reinterpret_cast<FileData *>(bh);
-  Set<const char *> gathered;
   LinkNode *names = nullptr;
-  BHead *bhead;
 
-  for (bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
-    if (bhead->code == BLO_CODE_ENDB) {
-      break;
-    }
-    if (BKE_idtype_idcode_is_valid(bhead->code)) {
-      if (BKE_idtype_idcode_is_linkable(bhead->code)) {
-        const char *str = BKE_idtype_idcode_to_name(bhead->code);
-
-        if (gathered.add(str)) {
-          BLI_linklist_prepend(&names, BLI_strdup(str));
-        }
-      }
+  for (const int code : blo_bhead_id_index_ensure(fd).codes) {
+    if (BKE_idtype_idcode_is_linkable(code)) {
+      BLI_linklist_prepend(&names, BLI_strdup(BKE_idtype_idcode_to_name(code)));
     }
   }
 
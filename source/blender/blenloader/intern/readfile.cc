@@ -62,9 +62,11 @@
 #include "BLI_string_ref.hh"
 #include "BLI_string_utf8.hh"
 #include "BLI_string_utils.hh"
+#include "BLI_task.hh"
 #include "BLI_threads.hh"
 #include "BLI_time.hh"
 #include "BLI_utildefines.hh"
+#include "BLI_vector.hh"
 
 #include "BLT_translation.hh"
 
@@ -558,6 +560,28 @@ static void read_file_bhead_idname_map_create(FileData *fd)
   }
 }
 
+const FileData::BHeadIDIndex &blo_bhead_id_index_ensure(FileData *fd)
+{
+  if (fd->bhead_id_index) {
+    return *fd->bhead_id_index;
+  }
+
+  FileData::BHeadIDIndex &index = fd->bhead_id_index.emplace();
+  for (BHead *bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
+    if (bhead->code == BLO_CODE_ENDB) {
+      break;
+    }
+    if (!blo_bhead_is_id_valid_type(bhead)) {
+      continue;
+    }
+    if (index.bheads_by_code.lookup(bhead->code).is_empty()) {
+      index.codes.append(bhead->code);
+    }
+    index.bheads_by_code.add(bhead->code, bhead);
+  }
+  return index;
+}
+
 void blo_readfile_invalidate(FileData *fd, Main *bmain, const char *message)
 {
   /* Tag given `bmain`, and 'root 'local' main one (in case given one is a library one) as invalid.
@@ -1808,102 +1832,159 @@ static const char *get_alloc_name(FileData *fd,
 #endif
 }
 
-static void *read_struct(FileData *fd, BHead *bh, const char *blockname, const int id_type_index)
-{
-  void *temp = nullptr;
+/**
+ * A block whose file data has been validated and loaded, but not converted to the current SDNA
+ * yet. Reading is split in these two steps so that the conversion, which does not access the file
+ * nor any other mutable state of the #FileData, can run in parallel for all data of an ID.
+ */
+struct ReadStructTask {
+  BHead *bh = nullptr;
+#ifdef USE_BHEAD_READ_ON_DEMAND
+  /** The #BHead passed to #read_struct_prepare, differs from #bh when its data was read. */
+  BHead *bh_orig = nullptr;
+#endif
+  const char *alloc_name = nullptr;
+  /** Whether #read_struct_finish still has to create #data from the #BHead content. */
+  bool needs_conversion = false;
+  void *data = nullptr;
+};
 
-  if (bh->len) {
+/**
+ * Validate the block and make its data available. Must be called from the thread reading the
+ * file. Returns false if the file is corrupt.
+ */
+static bool read_struct_prepare(FileData *fd,
+                                BHead *bh,
+                                const char *blockname,
+                                const int id_type_index,
+                                ReadStructTask &r_task)
+{
+  r_task.bh = bh;
 #ifdef USE_BHEAD_READ_ON_DEMAND
-    BHead *bh_orig = bh;
+  r_task.bh_orig = bh;
 #endif
 
-    /* A corrupt file could reference a struct index outside the file's SDNA, used below to index
-     * the compare-flags, reconstruction & alignment tables. */
-    if (bh->SDNAnr < 0 || bh->SDNAnr >= fd->filesdna->structs.size()) [[unlikely]] {
-      fd->flags &= ~FD_FLAGS_FILE_OK;
-      if (fd->bmain) {
-        blo_readfile_invalidate(fd, fd->bmain, "Corrupt .blend file, invalid block struct index");
-      }
-      return nullptr;
+  if (!bh->len) {
+    return true;
+  }
+
+  /* A corrupt file could reference a struct index outside the file's SDNA, used below to index
+   * the compare-flags, reconstruction & alignment tables. */
+  if (bh->SDNAnr < 0 || bh->SDNAnr >= fd->filesdna->structs.size()) [[unlikely]] {
+    fd->flags &= ~FD_FLAGS_FILE_OK;
+    if (fd->bmain) {
+      blo_readfile_invalidate(fd, fd->bmain, "Corrupt .blend file, invalid block struct index");
     }
+    return false;
+  }
 
-    /* Endianness switch is based on file DNA.
-     *
-     * NOTE: raw data (aka #SDNA_RAW_DATA_STRUCT_INDEX #SDNAnr) is not handled here, it's up to
-     * the calling code to manage this. */
-    BLI_assert((fd->flags & FD_FLAGS_SWITCH_ENDIAN) == 0);
-    BLI_STATIC_ASSERT(SDNA_RAW_DATA_STRUCT_INDEX == 0, "'raw data' SDNA struct index should be 0")
-    if (bh->SDNAnr > SDNA_RAW_DATA_STRUCT_INDEX && (fd->flags & FD_FLAGS_SWITCH_ENDIAN)) {
+  /* Endianness switch is based on file DNA.
+   *
+   * NOTE: raw data (aka #SDNA_RAW_DATA_STRUCT_INDEX #SDNAnr) is not handled here, it's up to
+   * the calling code to manage this. */
+  BLI_assert((fd->flags & FD_FLAGS_SWITCH_ENDIAN) == 0);
+  BLI_STATIC_ASSERT(SDNA_RAW_DATA_STRUCT_INDEX == 0, "'raw data' SDNA struct index should be 0")
+  if (bh->SDNAnr > SDNA_RAW_DATA_STRUCT_INDEX && (fd->flags & FD_FLAGS_SWITCH_ENDIAN)) {
 #ifdef USE_BHEAD_READ_ON_DEMAND
-      if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
-        bh = blo_bhead_read_full(fd, bh);
-        if (bh == nullptr) [[unlikely]] {
-          fd->flags &= ~FD_FLAGS_FILE_OK;
-          return nullptr;
-        }
+    if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
+      bh = blo_bhead_read_full(fd, bh);
+      if (bh == nullptr) [[unlikely]] {
+        fd->flags &= ~FD_FLAGS_FILE_OK;
+        return false;
       }
-#endif
+      r_task.bh = bh;
     }
-
-    if (fd->compflags[bh->SDNAnr] != SDNA_CMP_REMOVED) {
-      const char *alloc_name = get_alloc_name(fd, bh, blockname, id_type_index);
-      if (fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL) {
-        /* The block must be large enough to hold the number of structs it claims, otherwise
-         * reconstruction (which strides the block by the file struct size) reads past its end.
-         * Written as a division to avoid overflow in `nr * struct_size`. */
-        const int64_t old_struct_size = DNA_struct_size(fd->filesdna.get(), bh->SDNAnr);
-        if (bh->nr < 0 || (old_struct_size != 0 && bh->nr > bh->len / old_struct_size))
-            [[unlikely]]
-        {
-          fd->flags &= ~FD_FLAGS_FILE_OK;
-          if (fd->bmain) {
-            blo_readfile_invalidate(fd, fd->bmain, "Corrupt .blend file, invalid block count");
-          }
-          return nullptr;
-        }
-#ifdef USE_BHEAD_READ_ON_DEMAND
-        if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
-          bh = blo_bhead_read_full(fd, bh);
-          if (bh == nullptr) [[unlikely]] {
-            fd->flags &= ~FD_FLAGS_FILE_OK;
-            return nullptr;
-          }
-        }
 #endif
-        temp = DNA_struct_reconstruct(
-            fd->reconstruct_info, bh->SDNAnr, bh->nr, (bh + 1), alloc_name);
+  }
+
+  if (fd->compflags[bh->SDNAnr] == SDNA_CMP_REMOVED) {
+    return true;
+  }
+
+  r_task.alloc_name = get_alloc_name(fd, bh, blockname, id_type_index);
+  if (fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL) {
+    /* The block must be large enough to hold the number of structs it claims, otherwise
+     * reconstruction (which strides the block by the file struct size) reads past its end.
+     * Written as a division to avoid overflow in `nr * struct_size`. */
+    const int64_t old_struct_size = DNA_struct_size(fd->filesdna.get(), bh->SDNAnr);
+    if (bh->nr < 0 || (old_struct_size != 0 && bh->nr > bh->len / old_struct_size)) [[unlikely]]
+    {
+      fd->flags &= ~FD_FLAGS_FILE_OK;
+      if (fd->bmain) {
+        blo_readfile_invalidate(fd, fd->bmain, "Corrupt .blend file, invalid block count");
       }
-      else {
-        /* SDNA_CMP_EQUAL */
-        const int alignment = DNA_struct_alignment(fd->filesdna.get(), bh->SDNAnr);
-        temp = MEM_new_uninitialized_aligned(bh->len, alignment, alloc_name);
+      return false;
+    }
 #ifdef USE_BHEAD_READ_ON_DEMAND
-        if (BHEADN_FROM_BHEAD(bh)->has_data) {
-          memcpy(temp, (bh + 1), bh->len);
-        }
-        else {
-          /* Instead of allocating the bhead, then copying it,
-           * read the data from the file directly into the memory. */
-          if (!blo_bhead_read_data(fd, bh, temp)) [[unlikely]] {
-            fd->flags &= ~FD_FLAGS_FILE_OK;
-            MEM_delete_void(temp);
-            temp = nullptr;
-          }
-        }
-#else
-        memcpy(temp, (bh + 1), bh->len);
-#endif
+    if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
+      bh = blo_bhead_read_full(fd, bh);
+      if (bh == nullptr) [[unlikely]] {
+        fd->flags &= ~FD_FLAGS_FILE_OK;
+        return false;
       }
+      r_task.bh = bh;
     }
+#endif
+    r_task.needs_conversion = true;
+    return true;
+  }
 
+  /* SDNA_CMP_EQUAL */
 #ifdef USE_BHEAD_READ_ON_DEMAND
-    if (bh_orig != bh) {
-      MEM_delete(BHEADN_FROM_BHEAD(bh));
+  if (!BHEADN_FROM_BHEAD(bh)->has_data) {
+    /* Instead of allocating the bhead, then copying it,
+     * read the data from the file directly into the memory. */
+    const int alignment = DNA_struct_alignment(fd->filesdna.get(), bh->SDNAnr);
+    r_task.data = MEM_new_uninitialized_aligned(bh->len, alignment, r_task.alloc_name);
+    if (!blo_bhead_read_data(fd, bh, r_task.data)) [[unlikely]] {
+      fd->flags &= ~FD_FLAGS_FILE_OK;
+      MEM_delete_void(r_task.data);
+      r_task.data = nullptr;
     }
+    return true;
+  }
 #endif
+  r_task.needs_conversion = true;
+  return true;
+}
+
+/**
+ * Convert the data prepared by #read_struct_prepare into the current SDNA layout.
+ * This is thread-safe, as long as each task is handled by a single thread.
+ */
+static void read_struct_finish(const FileData *fd, ReadStructTask &task)
+{
+  BHead *bh = task.bh;
+  if (task.needs_conversion) {
+    if (fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL) {
+      task.data = DNA_struct_reconstruct(
+          fd->reconstruct_info, bh->SDNAnr, bh->nr, (bh + 1), task.alloc_name);
+    }
+    else {
+      /* SDNA_CMP_EQUAL */
+      const int alignment = DNA_struct_alignment(fd->filesdna.get(), bh->SDNAnr);
+      task.data = MEM_new_uninitialized_aligned(bh->len, alignment, task.alloc_name);
+      memcpy(task.data, (bh + 1), bh->len);
+    }
+    task.needs_conversion = false;
   }
 
-  return temp;
+#ifdef USE_BHEAD_READ_ON_DEMAND
+  if (task.bh_orig != bh) {
+    MEM_delete(BHEADN_FROM_BHEAD(bh));
+    task.bh = task.bh_orig;
+  }
+#endif
+}
+
+static void *read_struct(FileData *fd, BHead *bh, const char *blockname, const int id_type_index)
+{
+  ReadStructTask task;
+  if (!read_struct_prepare(fd, bh, blockname, id_type_index, task)) {
+    return nullptr;
+  }
+  read_struct_finish(fd, task);
+  return task.data;
 }
 
 static ID *read_id_struct(FileData *fd, BHead *bh, const char *blockname, const int id_type_index)
@@ -2803,21 +2884,45 @@ static BHead *read_data_into_datamap(FileData *fd,
                                      const char *allocname,
                                      const int id_type_index)
 {
+  /* File access has to happen in order on this thread, but converting the blocks to the current
+   * SDNA is independent for each of them, which matters for IDs with many or large blocks. */
+  Vector<ReadStructTask> tasks;
+  int64_t tasks_size = 0;
+
   bhead = blo_bhead_next(fd, bhead);
 
   while (bhead && bhead->code == BLO_CODE_DATA) {
-    void *data = read_struct(fd, bhead, allocname, id_type_index);
-    if (data) {
-      const bool is_new = oldnewmap_insert(fd->datamap, bhead->old, data, 0);
+    ReadStructTask task;
+    if (read_struct_prepare(fd, bhead, allocname, id_type_index, task)) {
+      tasks_size += bhead->len;
+      tasks.append(task);
+    }
+
+    bhead = blo_bhead_next(fd, bhead);
+  }
+
+  threading::parallel_for(
+      tasks.index_range(),
+      256 * 1024,
+      [&](const IndexRange range) {
+        for (const int64_t i : range) {
+          read_struct_finish(fd, tasks[i]);
+        }
+      },
+      threading::individual_task_sizes(
+          [&](const int64_t i) { return int64_t(tasks[i].bh->len); }, tasks_size));
+
+  /* Insert in file order, so that errors are reported the same way as when reading serially. */
+  for (const ReadStructTask &task : tasks) {
+    if (task.data) {
+      const bool is_new = oldnewmap_insert(fd->datamap, task.bh->old, task.data, 0);
       if (!is_new) {
         CLOG_ERROR(&LOG,
                    "Blendfile corruption: Invalid, or multiple `bhead` with same old address "
                    "value (%p) for a given ID.",
-                   bhead->old);
+                   task.bh->old);
       }
     }
-
-    bhead = blo_bhead_next(fd, bhead);
   }
 
   return bhead;
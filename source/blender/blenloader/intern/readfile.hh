@@ -20,6 +20,8 @@
 #include "BLI_fileops.hh"
 #include "BLI_filereader.hh"
 #include "BLI_map.hh"
+#include "BLI_multi_value_map.hh"
+#include "BLI_vector.hh"
 
 #include "DNA_sdna_types.h"
 #include "DNA_space_types.h"
@@ -168,6 +170,14 @@ struct FileData {
 
   std::optional<Map<StringRefNull, BHead *>> bhead_idname_map;
 
+  /** Index of the ID blocks in the file, see #blo_bhead_id_index_ensure. */
+  struct BHeadIDIndex {
+    /** ID codes in the order in which they first appear in the file. */
+    Vector<int> codes;
+    MultiValueMap<int, BHead *> bheads_by_code;
+  };
+  std::optional<BHeadIDIndex> bhead_id_index;
+
   /**
    * The root (main, local) Main.
    * The Main that will own Library IDs.
@@ -258,6 +268,11 @@ void blo_cache_storage_end(FileData *fd) ATTR_NONNULL(1);
 void blo_filedata_free(FileData *fd) ATTR_NONNULL(1);
 
 BHead *blo_bhead_first(FileData *fd) ATTR_NONNULL(1);
+/**
+ * Build #FileData::bhead_id_index if it does not exist yet, so that the ID blocks of a given type
+ * can be found without scanning (and reading) all blocks of the file again for each query.
+ */
+const FileData::BHeadIDIndex &blo_bhead_id_index_ensure(FileData *fd) ATTR_NONNULL(1);
 BHead *blo_bhead_next(FileData *fd, BHead *thisblock) ATTR_NONNULL(1);
 BHead *blo_bhead_prev(FileData *fd, BHead *thisblock) ATTR_NONNULL(1, 2);
 
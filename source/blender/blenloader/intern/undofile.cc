@@ -10,6 +10,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <fcntl.h>
+#include <xxhash.h>
 
 /* open/close */
 #ifndef _WIN32
@@ -24,6 +25,9 @@
 
 #include "BLI_implicit_sharing.hh"
 #include "BLI_listbase.hh"
+#include "BLI_map.hh"
+#include "BLI_set.hh"
+#include "BLI_vector.hh"
 
 #include "BLO_readfile.hh"
 #include "BLO_undofile.hh"
@@ -38,15 +42,159 @@
 
 namespace blender {
 
+/* -------------------------------------------------------------------- */
+/** \name Content Addressed Chunk Storage
+ *
+ * Chunk buffers are stored once per content for all undo steps, so that data that was written
+ * before in any step (e.g. because an ID was reordered, or changed back to a previous state) does
+ * not take more memory.
+ * \{ */
+
+struct MemFileChunkKey {
+  uint64_t hash_low;
+  uint64_t hash_high;
+  size_t size;
+
+  uint64_t hash() const
+  {
+    return hash_low;
+  }
+
+  friend bool operator==(const MemFileChunkKey &a, const MemFileChunkKey &b)
+  {
+    return a.hash_low == b.hash_low && a.hash_high == b.hash_high && a.size == b.size;
+  }
+};
+
+struct MemFileChunkData {
+  MemFileChunkKey key;
+  char *buf;
+  /** Number of #MemFileChunk using this data. */
+  int users;
+  /**
+   * The memfile whose size includes this data. That is the oldest memfile using it, so that the
+   * data is counted exactly once while any undo step uses it.
+   */
+  MemFile *owner;
+  /** False in the (unlikely) case of a hash collision with different content. */
+  bool is_in_storage;
+};
+
+struct MemFileChunkStorage {
+  Map<MemFileChunkKey, MemFileChunkData *> data_by_key;
+  /** The memfiles using this storage, from oldest to newest. */
+  Vector<MemFile *> memfiles;
+};
+
+/**
+ * Use the storage of the reference memfile, so that all memfile undo steps of an undo stack
+ * share it. The storage is freed with the last memfile using it.
+ */
+static void memfile_chunk_storage_init(MemFile *memfile, MemFile *reference_memfile)
+{
+  if (memfile->chunk_storage != nullptr) {
+    return;
+  }
+  if (reference_memfile != nullptr && reference_memfile->chunk_storage != nullptr) {
+    memfile->chunk_storage = reference_memfile->chunk_storage;
+  }
+  else {
+    memfile->chunk_storage = MEM_new<MemFileChunkStorage>(__func__);
+  }
+  memfile->chunk_storage->memfiles.append(memfile);
+}
+
+static MemFileChunkData *memfile_chunk_data_ensure(MemFile *memfile,
+                                                   const char *buf,
+                                                   const size_t size)
+{
+  MemFileChunkStorage &storage = *memfile->chunk_storage;
+  const XXH128_hash_t hash = XXH3_128bits(buf, size);
+  const MemFileChunkKey key = {hash.low64, hash.high64, size};
+
+  MemFileChunkData *data = storage.data_by_key.lookup_default(key, nullptr);
+  if (data != nullptr) {
+    if (memcmp(data->buf, buf, size) == 0) {
+      data->users++;
+      return data;
+    }
+  }
+
+  data = MEM_new<MemFileChunkData>(__func__);
+  data->key = key;
+  data->buf = MEM_new_array_uninitialized<char>(size, "Chunk buffer");
+  memcpy(data->buf, buf, size);
+  data->users = 1;
+  data->owner = memfile;
+  data->is_in_storage = storage.data_by_key.add(key, data);
+  memfile->size += size;
+  return data;
+}
+
+static void memfile_chunk_data_free(MemFileChunkStorage &storage, MemFileChunkData *data)
+{
+  BLI_assert(data->users == 0);
+  if (data->is_in_storage) {
+    storage.data_by_key.remove(data->key);
+  }
+  MEM_delete(data->buf);
+  MEM_delete(data);
+}
+
+/**
+ * Data that is still used after its owner is freed is counted in the size of the next oldest
+ * memfile using it instead.
+ */
+static void memfile_chunk_data_owners_update(MemFileChunkStorage &storage,
+                                             Set<MemFileChunkData *> &orphan_data)
+{
+  for (MemFile *memfile : storage.memfiles) {
+    if (orphan_data.is_empty()) {
+      break;
+    }
+    for (MemFileChunk &chunk : memfile->chunks) {
+      if (orphan_data.remove(chunk.data)) {
+        chunk.data->owner = memfile;
+        memfile->size += chunk.size;
+      }
+    }
+  }
+  BLI_assert(orphan_data.is_empty());
+}
+
+/** \} */
+
 /* **************** support for memory-write, for undo buffers *************** */
 
 void BLO_memfile_free(MemFile *memfile)
 {
-  while (MemFileChunk *chunk = static_cast<MemFileChunk *>(BLI_pophead(&memfile->chunks))) {
-    if (chunk->is_identical == false) {
-      MEM_delete(chunk->buf);
+  if (MemFileChunkStorage *storage = memfile->chunk_storage) {
+    storage->memfiles.remove(storage->memfiles.first_index_of(memfile));
+
+    /* The same data may be used by multiple chunks, so only free it after all are removed. */
+    Set<MemFileChunkData *> chunks_data;
+    while (MemFileChunk *chunk = static_cast<MemFileChunk *>(BLI_pophead(&memfile->chunks))) {
+      chunk->data->users--;
+      chunks_data.add(chunk->data);
+      MEM_delete(chunk);
+    }
+    Set<MemFileChunkData *> orphan_data;
+    for (MemFileChunkData *data : chunks_data) {
+      if (data->users == 0) {
+        memfile_chunk_data_free(*storage, data);
+      }
+      else if (data->owner == memfile) {
+        data->owner = nullptr;
+        orphan_data.add(data);
+      }
     }
-    MEM_delete(chunk);
+    memfile_chunk_data_owners_update(*storage, orphan_data);
+
+    if (storage->memfiles.is_empty()) {
+      BLI_assert(storage->data_by_key.is_empty());
+      MEM_delete(storage);
+    }
+    memfile->chunk_storage = nullptr;
   }
   MEM_SAFE_DELETE(memfile->shared_storage);
   memfile->size = 0;
@@ -62,29 +210,20 @@ MemFileSharedStorage::~MemFileSharedStorage()
 
 void BLO_memfile_merge(MemFile *first, MemFile *second)
 {
-  /* We use this mapping to store the memory buffers from second memfile chunks which are not owned
-   * by it (i.e. shared with some previous memory steps). */
-  Map<const char *, MemFileChunk *> buffer_to_second_memchunk;
-
-  /* First, detect all memchunks in second memfile that are not owned by it. */
+  /* Chunk data is reference counted, so it stays alive as long as the second memfile uses it.
+   * However, chunks of the second memfile that were identical to chunks changed in the first
+   * memfile are not identical to the step before the first memfile, so tag them as changed. */
+  Map<const MemFileChunkData *, MemFileChunk *> data_to_second_memchunk;
   for (MemFileChunk &sc : second->chunks) {
     if (sc.is_identical) {
-      buffer_to_second_memchunk.add(sc.buf, &sc);
+      data_to_second_memchunk.add(sc.data, &sc);
     }
   }
-
-  /* Now, check all chunks from first memfile (the one we are removing), and if a memchunk owned by
-   * it is also used by the second memfile, transfer the ownership. */
   for (MemFileChunk &fc : first->chunks) {
     if (!fc.is_identical) {
-      if (MemFileChunk *sc = buffer_to_second_memchunk.lookup_default(fc.buf, nullptr)) {
-        BLI_assert(sc->is_identical);
+      if (MemFileChunk *sc = data_to_second_memchunk.lookup_default(fc.data, nullptr)) {
         sc->is_identical = false;
-        fc.is_identical = true;
       }
-      /* Note that if the second memfile does not use that chunk, we assume that the first one
-       * fully owns it without sharing it with any other memfile, and hence it should be freed with
-       * it. */
     }
   }
 
@@ -104,6 +243,7 @@ void BLO_memfile_write_init(WriteData *wd,
                             MemFile *reference_memfile)
 {
   wd->use_memfile = true;
+  memfile_chunk_storage_init(written_memfile, reference_memfile);
 
   mem_data->written_memfile = written_memfile;
   mem_data->reference_memfile = reference_memfile;
@@ -140,6 +280,7 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
   MemFileChunk *curchunk = MEM_new_uninitialized<MemFileChunk>("MemFileChunk");
   curchunk->size = size;
   curchunk->buf = nullptr;
+  curchunk->data = nullptr;
   curchunk->is_identical = false;
   /* This is unsafe in the sense that an app handler or other code that does not
    * perform an undo push may make changes after the last undo push that
@@ -154,6 +295,8 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
     if (compchunk->size == curchunk->size) {
       if (memcmp(compchunk->buf, buf, size) == 0) {
         curchunk->buf = compchunk->buf;
+        curchunk->data = compchunk->data;
+        curchunk->data->users++;
         curchunk->is_identical = true;
         compchunk->is_identical_future = true;
       }
@@ -161,12 +304,10 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
     *compchunk_step = static_cast<MemFileChunk *>(compchunk->next);
   }
 
-  /* not equal... */
+  /* Not equal, but the same content may still exist in another step. */
   if (curchunk->buf == nullptr) {
-    char *buf_new = MEM_new_array_uninitialized<char>(size, "Chunk buffer");
-    memcpy(buf_new, buf, size);
-    curchunk->buf = buf_new;
-    memfile->size += size;
+    curchunk->data = memfile_chunk_data_ensure(memfile, buf, size);
+    curchunk->buf = curchunk->data->buf;
   }
 }
 
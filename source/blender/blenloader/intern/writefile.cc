@@ -59,6 +59,7 @@
  *   - #BLENDER_USERPREF_FILE (on UNIX `~/.config/blender/X.X/config/userpref.blend`).
  */
 
+#include <atomic>
 #include <cerrno>
 #include <climits>
 #include <condition_variable>
@@ -97,6 +98,7 @@
 #include "DNA_userdef_types.h"
 #include "DNA_windowmanager_types.h"
 
+#include "BLI_array.hh"
 #include "BLI_endian_defines.hh"
 #include "BLI_fileops.hh"
 #include "BLI_implicit_sharing.hh"
@@ -107,6 +109,7 @@
 #include "BLI_path_utils.hh"
 #include "BLI_set.hh"
 #include "BLI_string.hh"
+#include "BLI_task.hh"
 #include "BLI_task_c.hh"
 #include "BLI_threads.hh"
 #include "BLI_time.hh"
@@ -168,6 +171,17 @@ namespace blender {
 
 #define ZSTD_COMPRESSION_LEVEL 3
 
+/**
+ * Size of serialized IDs that may wait for preceding IDs to be written, before no more IDs are
+ * serialized, see #write_ids_parallel.
+ */
+#define WRITE_ID_PENDING_MAX_SIZE (1 << 26) /* 64mb */
+/**
+ * Buffered data is written as a separate chunk after an ID once it reaches this size, so that
+ * compressed frames start at the same data when saving again, see #ZstdWriteWrap.
+ */
+#define WRITE_ID_FLUSH_MIN_SIZE (1 << 18) /* 256kb */
+
 static CLG_LogRef LOG = {"blend.writefile"};
 static CLG_LogRef LOG_UNDO = {"undo"};
 
@@ -178,12 +192,53 @@ static CLG_LogRef LOG_UNDO = {"undo"};
 /** \name Internal Write Wrapper's (Abstracts Compression)
  * \{ */
 
+/**
+ * Identifies the uncompressed content of a zstd frame, so that compressed frames of the
+ * previously saved file can be reused for unchanged data.
+ */
+struct ZstdFrameKey {
+  uint64_t hash_low;
+  uint64_t hash_high;
+  uint32_t uncompressed_size;
+
+  uint64_t hash() const
+  {
+    return hash_low;
+  }
+
+  friend bool operator==(const ZstdFrameKey &a, const ZstdFrameKey &b)
+  {
+    return a.hash_low == b.hash_low && a.hash_high == b.hash_high &&
+           a.uncompressed_size == b.uncompressed_size;
+  }
+};
+
 struct ZstdFrame {
   ZstdFrame *next, *prev;
 
   uint32_t compressed_size;
   uint32_t uncompressed_size;
+  ZstdFrameKey key;
+  /** Hash of the compressed data, to detect changes of the file before it is reused. */
+  uint64_t compressed_hash;
+};
+
+/**
+ * Entry of the frame index, a skippable frame written after all data frames. It identifies the
+ * content of the frames, so that the next save of the file can reuse them.
+ */
+struct ZstdFrameIndexEntry {
+  uint64_t hash_low;
+  uint64_t hash_high;
+  uint32_t uncompressed_size;
+  uint32_t compressed_size;
+  uint64_t compressed_hash;
 };
+static_assert(sizeof(ZstdFrameIndexEntry) == 32, "ZstdFrameIndexEntry expected size mismatch");
+
+/** Magic number of the skippable frame containing the frame index. */
+#define ZSTD_FRAME_INDEX_MAGIC 0x184D2A5B
+#define ZSTD_FRAME_INDEX_VERSION 1
 
 class WriteWrap {
  public:
@@ -229,6 +284,11 @@ bool RawWriteWrap::write(const void *buf, size_t buf_len)
 
 class ZstdWriteWrap : public WriteWrap {
   struct ZstdWriteBlockTask;
+  struct ReferenceFrame {
+    int64_t offset;
+    uint32_t compressed_size;
+    uint64_t compressed_hash;
+  };
 
   WriteWrap &base_wrap;
 
@@ -238,22 +298,44 @@ class ZstdWriteWrap : public WriteWrap {
   std::condition_variable condition;
   int next_frame = 0;
   int num_frames = 0;
+  int num_reused_frames = 0;
 
   ListBaseT<ZstdFrame> frames = {};
 
+  /**
+   * Previously saved version of the file that is being written, its frames are reused for
+   * unchanged data. Read-only while compressing.
+   */
+  const char *reference_filepath = nullptr;
+  int reference_file = -1;
+  Map<ZstdFrameKey, ReferenceFrame> reference_frames;
+
   bool write_error = false;
 
  public:
-  ZstdWriteWrap(WriteWrap &base_wrap) : base_wrap(base_wrap) {}
+  ZstdWriteWrap(WriteWrap &base_wrap, const char *reference_filepath = nullptr)
+      : base_wrap(base_wrap), reference_filepath(reference_filepath)
+  {
+  }
 
   bool open(const char *filepath) override;
   bool close() override;
   bool write(const void *buf, size_t buf_len) override;
 
+  void stats_get(BlendFileWriteStats &r_stats) const
+  {
+    r_stats.frames_num = num_frames;
+    r_stats.frames_reused_num = num_reused_frames;
+  }
+
  private:
   static void compress_task_run(TaskPool *pool, void *taskdata);
   void write_u32_le(uint32_t val);
+  void write_frame_index();
   void write_seekable_frames();
+  void reference_file_open();
+  bool reference_frames_read(int file);
+  bool reference_frame_read(const ZstdFrameKey &key, void **r_buf, size_t *r_size);
 };
 
 struct ZstdWriteWrap::ZstdWriteBlockTask {
@@ -268,10 +350,17 @@ void ZstdWriteWrap::compress_task_run(TaskPool * /*pool*/, void *taskdata)
   ZstdWriteBlockTask *task = static_cast<ZstdWriteBlockTask *>(taskdata);
   ZstdWriteWrap *ww = task->ww;
 
-  size_t out_buf_len = ZSTD_compressBound(task->size);
-  void *out_buf = MEM_new_uninitialized(out_buf_len, "Zstd out buffer");
-  size_t out_size = ZSTD_compress(
-      out_buf, out_buf_len, task->data, task->size, ZSTD_COMPRESSION_LEVEL);
+  const XXH128_hash_t hash = XXH3_128bits(task->data, task->size);
+  const ZstdFrameKey key = {hash.low64, hash.high64, uint32_t(task->size)};
+
+  void *out_buf;
+  size_t out_size;
+  const bool reused = ww->reference_frame_read(key, &out_buf, &out_size);
+  if (!reused) {
+    size_t out_buf_len = ZSTD_compressBound(task->size);
+    out_buf = MEM_new_uninitialized(out_buf_len, "Zstd out buffer");
+    out_size = ZSTD_compress(out_buf, out_buf_len, task->data, task->size, ZSTD_COMPRESSION_LEVEL);
+  }
   MEM_delete_void(task->data);
 
   std::unique_lock lock{ww->mutex};
@@ -283,7 +372,12 @@ void ZstdWriteWrap::compress_task_run(TaskPool * /*pool*/, void *taskdata)
     ZstdFrame *frameinfo = MEM_new_uninitialized<ZstdFrame>("zstd frameinfo");
     frameinfo->uncompressed_size = task->size;
     frameinfo->compressed_size = out_size;
+    frameinfo->key = key;
+    frameinfo->compressed_hash = XXH3_64bits(out_buf, out_size);
     BLI_addtail(&ww->frames, frameinfo);
+    if (reused) {
+      ww->num_reused_frames++;
+    }
   }
   else {
     ww->write_error = true;
@@ -300,11 +394,133 @@ bool ZstdWriteWrap::open(const char *filepath)
     return false;
   }
 
+  if (reference_filepath) {
+    reference_file_open();
+  }
+
   pool = BLI_task_pool_create_background(nullptr, TASK_PRIORITY_HIGH);
 
   return true;
 }
 
+void ZstdWriteWrap::reference_file_open()
+{
+  const int file = BLI_open(reference_filepath, O_BINARY | O_RDONLY, 0);
+  if (file == -1) {
+    return;
+  }
+  if (!reference_frames_read(file)) {
+    reference_frames.clear();
+    ::close(file);
+    return;
+  }
+  reference_file = file;
+}
+
+/**
+ * Read the frame index of a file written by #write_frame_index. Files without it, e.g. written by
+ * older versions or external tools, are not used.
+ */
+bool ZstdWriteWrap::reference_frames_read(const int file)
+{
+  const int64_t file_size = int64_t(BLI_file_descriptor_size(file));
+
+  /* Seek table footer: number of frames, option flags and magic number. */
+  uint8_t footer[9];
+  const int64_t footer_size = sizeof(footer);
+  if (file_size < footer_size ||
+      BLI_pread(file, footer, footer_size, file_size - footer_size) != footer_size)
+  {
+    return false;
+  }
+  uint32_t seek_frames_num;
+  uint32_t footer_magic;
+  memcpy(&seek_frames_num, footer, 4);
+  memcpy(&footer_magic, footer + 5, 4);
+  if (footer_magic != 0x8F92EAB1 || footer[4] != 0 || seek_frames_num == 0) {
+    return false;
+  }
+
+  /* The seek table, where the frame index is the last frame. */
+  const int64_t seek_table_size = 8 + int64_t(seek_frames_num) * 8 + 9;
+  if (seek_table_size > file_size) {
+    return false;
+  }
+  Array<uint32_t> seek_table(2 + int64_t(seek_frames_num) * 2);
+  const int64_t seek_table_read_size = seek_table.size() * 4;
+  if (BLI_pread(file, seek_table.data(), seek_table_read_size, file_size - seek_table_size) !=
+          seek_table_read_size ||
+      seek_table[0] != 0x184D2A5E || seek_table[1] != seek_table_size - 8)
+  {
+    return false;
+  }
+  const int64_t frames_num = int64_t(seek_frames_num) - 1;
+  int64_t index_offset = 0;
+  for (const int64_t i : IndexRange(frames_num)) {
+    index_offset += seek_table[2 + i * 2];
+  }
+  const uint32_t index_frame_size = seek_table[2 + frames_num * 2];
+  const int64_t index_content_size = 4 + 4 + frames_num * sizeof(ZstdFrameIndexEntry) + 8;
+  if (seek_table[3 + frames_num * 2] != 0 || index_frame_size != 8 + index_content_size ||
+      index_offset + index_frame_size + seek_table_size != file_size)
+  {
+    return false;
+  }
+
+  Array<uint8_t> index(index_frame_size);
+  if (BLI_pread(file, index.data(), index.size(), index_offset) != index.size()) {
+    return false;
+  }
+  uint32_t header[4];
+  memcpy(header, index.data(), sizeof(header));
+  uint64_t checksum;
+  memcpy(&checksum, index.data() + index.size() - 8, 8);
+  if (header[0] != ZSTD_FRAME_INDEX_MAGIC || header[1] != index_content_size ||
+      header[2] != ZSTD_FRAME_INDEX_VERSION || header[3] != frames_num ||
+      XXH3_64bits(index.data() + 8, index_content_size - 8) != checksum)
+  {
+    return false;
+  }
+
+  int64_t offset = 0;
+  for (const int64_t i : IndexRange(frames_num)) {
+    ZstdFrameIndexEntry entry;
+    memcpy(&entry, index.data() + 16 + i * sizeof(entry), sizeof(entry));
+    if (entry.compressed_size != seek_table[2 + i * 2] ||
+        entry.uncompressed_size != seek_table[3 + i * 2])
+    {
+      return false;
+    }
+    const ZstdFrameKey key = {entry.hash_low, entry.hash_high, entry.uncompressed_size};
+    reference_frames.add(key, {offset, entry.compressed_size, entry.compressed_hash});
+    offset += entry.compressed_size;
+  }
+  return true;
+}
+
+bool ZstdWriteWrap::reference_frame_read(const ZstdFrameKey &key, void **r_buf, size_t *r_size)
+{
+  if (reference_file == -1) {
+    return false;
+  }
+  const ReferenceFrame *frame = reference_frames.lookup_ptr(key);
+  if (frame == nullptr) {
+    return false;
+  }
+  void *buf = MEM_new_uninitialized(frame->compressed_size, "Zstd out buffer");
+  /* The file may have been modified since its index was read, only use unchanged frames. */
+  if (BLI_pread(reference_file, buf, frame->compressed_size, frame->offset) !=
+          frame->compressed_size ||
+      XXH3_64bits(buf, frame->compressed_size) != frame->compressed_hash)
+  {
+    MEM_delete_void(buf);
+    return false;
+  }
+  *r_buf = buf;
+  *r_size = frame->compressed_size;
+  return true;
+}
+
 void ZstdWriteWrap::write_u32_le(uint32_t val)
 {
   /* NOTE: this is endianness-sensitive.
@@ -313,6 +529,47 @@ void ZstdWriteWrap::write_u32_le(uint32_t val)
   base_wrap.write(&val, sizeof(uint32_t));
 }
 
+/**
+ * Write a skippable frame with the content hashes of all frames, so that the next save of the
+ * file can reuse the compressed frames of unchanged data, see #reference_frames_read. It is
+ * listed in the seek table like the other frames, with an uncompressed size of zero.
+ */
+void ZstdWriteWrap::write_frame_index()
+{
+  Vector<uint8_t> index;
+  auto append = [&](const auto &value) {
+    index.extend(Span<uint8_t>(reinterpret_cast<const uint8_t *>(&value), sizeof(value)));
+  };
+
+  /* NOTE: this is endianness-sensitive, like the seek table. */
+  BLI_assert(ENDIAN_ORDER == L_ENDIAN);
+  const uint32_t frames_num = frames.count();
+  append(uint32_t(ZSTD_FRAME_INDEX_MAGIC));
+  append(uint32_t(4 + 4 + frames_num * sizeof(ZstdFrameIndexEntry) + 8));
+  append(uint32_t(ZSTD_FRAME_INDEX_VERSION));
+  append(frames_num);
+  for (const ZstdFrame &frame : frames) {
+    const ZstdFrameIndexEntry entry = {frame.key.hash_low,
+                                       frame.key.hash_high,
+                                       frame.uncompressed_size,
+                                       frame.compressed_size,
+                                       frame.compressed_hash};
+    append(entry);
+  }
+  append(uint64_t(XXH3_64bits(index.data() + 8, index.size() - 8)));
+
+  if (!base_wrap.write(index.data(), index.size())) {
+    write_error = true;
+    return;
+  }
+  ZstdFrame *frameinfo = MEM_new_uninitialized<ZstdFrame>("zstd frameinfo");
+  frameinfo->compressed_size = uint32_t(index.size());
+  frameinfo->uncompressed_size = 0;
+  frameinfo->key = {};
+  frameinfo->compressed_hash = 0;
+  BLI_addtail(&frames, frameinfo);
+}
+
 /* In order to implement efficient seeking when reading the .blend, we append
  * a skippable frame that encodes information about the other frames present
  * in the file.
@@ -352,9 +609,17 @@ bool ZstdWriteWrap::close()
   BLI_task_pool_free(pool);
   pool = nullptr;
 
+  if (!write_error) {
+    write_frame_index();
+  }
   write_seekable_frames();
   frames.free_no_destruct();
 
+  if (reference_file != -1) {
+    ::close(reference_file);
+    reference_file = -1;
+  }
+
   return base_wrap.close() && !write_error;
 }
 
@@ -407,6 +672,26 @@ static WriteData *writedata_new(WriteWrap *ww)
   return wd;
 }
 
+/**
+ * Create a #WriteData that serializes a single ID into \a r_buffer, using the same SDNA and the
+ * stable address ids of \a parent for all IDs.
+ */
+static WriteData *writedata_new_for_id_buffer(const WriteData &parent, Vector<uchar> &r_buffer)
+{
+  BLI_assert(!parent.use_memfile);
+  WriteData *wd = MEM_new<WriteData>(__func__);
+
+  wd->timestamp_init = parent.timestamp_init;
+
+  wd->sdna = parent.sdna;
+  wd->stable_address_ids.sdna_pointers = parent.stable_address_ids.sdna_pointers;
+  wd->stable_address_ids.parent = &parent.stable_address_ids;
+
+  wd->id_buffer = &r_buffer;
+
+  return wd;
+}
+
 static void writedata_do_write(WriteData *wd, const void *mem, const size_t memlen)
 {
   if ((wd == nullptr) || wd->validation_data.critical_error || (mem == nullptr) || memlen < 1) {
@@ -479,6 +764,12 @@ static void mywrite(WriteData *wd, const void *adr, size_t len)
   wd->write_len += len;
 #endif
 
+  if (wd->id_buffer) {
+    /* Buffers of single IDs are written to the actual #WriteData afterwards. */
+    wd->id_buffer->extend(static_cast<const uchar *>(adr), int64_t(len));
+    return;
+  }
+
   if (wd->buffer.buf == nullptr) {
     writedata_do_write(wd, adr, len);
   }
@@ -776,8 +1067,11 @@ static uint64_t stable_id_from_hint(const uint64_t hint)
 
 static uint64_t get_next_stable_address_id(WriteData &wd, uint64_t &hint)
 {
+  const WriteDataStableAddressIDs *parent = wd.stable_address_ids.parent;
   uint64_t stable_id = stable_id_from_hint(hint);
-  while (!wd.stable_address_ids.used_ids.add(stable_id)) {
+  while ((parent && parent->used_ids.contains(stable_id)) ||
+         !wd.stable_address_ids.used_ids.add(stable_id))
+  {
     /* Generate a new hint because there is a collision. Collisions are generally expected to be
      * very rare. It can happen when #get_stable_pointer_hint_for_id produces values that are very
      * close for different IDs. */
@@ -800,6 +1094,12 @@ static uint64_t get_address_id_int(WriteData &wd, const void *address)
     return wd.stable_address_ids.pointer_map.lookup_default_as(
         address, reinterpret_cast<uint64_t>(address));
   }
+  /* IDs serialized on their own share the identifiers of IDs and of previously written data. */
+  if (const WriteDataStableAddressIDs *parent = wd.stable_address_ids.parent) {
+    if (const uint64_t *address_id = parent->pointer_map.lookup_ptr(address)) {
+      return *address_id;
+    }
+  }
   /* Either reuse an existing identifier or create a new one. */
   return wd.stable_address_ids.pointer_map.lookup_or_add_cb(address, [&]() {
     return get_next_stable_address_id(wd, wd.stable_address_ids.next_id_hint);
@@ -1284,6 +1584,103 @@ static void write_id(WriteData *wd, ID *id)
   mywrite_id_end(wd, id);
 }
 
+/**
+ * Whether the ID can be serialized concurrently with other IDs on another thread. This is not the
+ * case when its writer temporarily modifies original data:
+ * - UI data-blocks modify data referencing other data-blocks.
+ * - Node trees, including the ones embedded in other IDs, write forward compatible data.
+ * - Armatures link their bone collections into a list.
+ */
+static bool write_id_supports_parallel(ID &id)
+{
+  if (ELEM(GS(id.name), ID_WM, ID_SCR, ID_WS, ID_NT, ID_AR)) {
+    return false;
+  }
+  return bke::node_tree_from_id(&id) == nullptr;
+}
+
+/**
+ * Serialize IDs into separate buffers in parallel, and write the buffers in the order of \a ids
+ * as soon as all preceding IDs are written. IDs are serialized in order, and threads stop taking
+ * new IDs while too much serialized data waits for a preceding ID, which bounds memory usage.
+ */
+static void write_ids_parallel_buffered(WriteData *wd, const Span<ID *> ids)
+{
+  Array<Vector<uchar>> buffers(ids.size());
+  Array<bool> finished(ids.size(), false);
+  std::atomic<int64_t> next_to_serialize = 0;
+
+  std::mutex mutex;
+  std::condition_variable cond;
+  int64_t next_to_write = 0;
+  int64_t pending_size = 0;
+
+  threading::parallel_for(ids.index_range(), 1, [&](const IndexRange range) {
+    for ([[maybe_unused]] const int64_t task : range) {
+      /* Isolate, so that waiting below never blocks a thread that is serializing an earlier ID
+       * in a nested parallel loop. */
+      threading::isolate_task([&]() {
+        const int64_t i = next_to_serialize.fetch_add(1);
+        WriteData *id_wd = writedata_new_for_id_buffer(*wd, buffers[i]);
+        write_id(id_wd, ids[i]);
+        writedata_free(id_wd);
+
+        std::unique_lock lock(mutex);
+        finished[i] = true;
+        pending_size += buffers[i].size();
+        while (next_to_write < ids.size() && finished[next_to_write]) {
+          Vector<uchar> &buffer = buffers[next_to_write];
+          if (!buffer.is_empty()) {
+            mywrite(wd, buffer.data(), size_t(buffer.size()));
+          }
+          pending_size -= buffer.size();
+          buffer.clear_and_shrink();
+          next_to_write++;
+          /* Avoid that changes in the size of an ID affect how the data of following IDs is
+           * split into chunks, so that the compressed frames of unchanged data can be reused. */
+          if (wd->buffer.used_len >= WRITE_ID_FLUSH_MIN_SIZE) {
+            mywrite_flush(wd);
+          }
+        }
+        cond.notify_all();
+        /* The ID at #next_to_write is always being serialized by a thread that is not waiting, so
+         * this cannot wait forever. */
+        cond.wait(lock, [&]() {
+          return next_to_write > i || pending_size <= WRITE_ID_PENDING_MAX_SIZE;
+        });
+      });
+    }
+  });
+  BLI_assert(next_to_write == ids.size());
+}
+
+/**
+ * Writes IDs like #write_id, but serializes consecutive IDs that support it in parallel. The
+ * written file does not depend on scheduling, and IDs that do not support it are written when no
+ * other ID is being serialized.
+ *
+ * Data written for an ID only gets stable address ids generated from that ID's own hint, so that
+ * they don't depend on the other IDs written concurrently.
+ */
+static void write_ids_parallel(WriteData *wd, const Span<ID *> ids)
+{
+  BLI_assert(!wd->use_memfile && wd->debug_dst == nullptr);
+  int64_t start = 0;
+  while (start < ids.size()) {
+    if (!write_id_supports_parallel(*ids[start])) {
+      write_id(wd, ids[start]);
+      start++;
+      continue;
+    }
+    int64_t end = start + 1;
+    while (end < ids.size() && write_id_supports_parallel(*ids[end])) {
+      end++;
+    }
+    write_ids_parallel_buffered(wd, ids.slice(IndexRange::from_begin_end(start, end)));
+    start = end;
+  }
+}
+
 static void write_id_placeholder(WriteData *wd, ID *id)
 {
   mywrite_id_begin(wd, id);
@@ -1773,9 +2170,15 @@ static bool write_file_handle(Main *mainvar,
     }
   }
 
-  /* Actually write local data-blocks to the file. */
-  for (ID *id : local_ids_to_write) {
-    write_id(wd, id);
+  /* Actually write local data-blocks to the file. Undo steps are written serially, since they
+   * are compared to the previous step chunk by chunk. */
+  if (is_undo || wd->debug_dst) {
+    for (ID *id : local_ids_to_write) {
+      write_id(wd, id);
+    }
+  }
+  else {
+    write_ids_parallel(wd, local_ids_to_write);
   }
 
   /* Write libraries about libraries and linked data-blocks. */
@@ -2099,11 +2502,22 @@ bool BLO_write_file(Main *mainvar,
   RawWriteWrap raw_wrap;
 
   if (write_flags & G_FILE_COMPRESS) {
-    ZstdWriteWrap zstd_wrap(raw_wrap);
-    return BLO_write_file_impl(mainvar, filepath, write_flags, params, reports, zstd_wrap);
+    /* Reuse compressed frames of the file that is overwritten for unchanged data. */
+    ZstdWriteWrap zstd_wrap(raw_wrap, filepath);
+    const bool success = BLO_write_file_impl(
+        mainvar, filepath, write_flags, params, reports, zstd_wrap);
+    if (success && params->r_stats) {
+      zstd_wrap.stats_get(*params->r_stats);
+    }
+    return success;
   }
 
-  return BLO_write_file_impl(mainvar, filepath, write_flags, params, reports, raw_wrap);
+  const bool success = BLO_write_file_impl(
+      mainvar, filepath, write_flags, params, reports, raw_wrap);
+  if (success && params->r_stats) {
+    *params->r_stats = {};
+  }
+  return success;
 }
 
 bool BLO_write_file_mem(Main *mainvar, MemFile *compare, MemFile *current, const int write_flags)
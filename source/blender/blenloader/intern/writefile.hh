@@ -16,6 +16,7 @@
 
 #include "BLI_map.hh"
 #include "BLI_set.hh"
+#include "BLI_vector.hh"
 
 #include "BLO_undofile.hh"
 
@@ -74,6 +75,12 @@ struct WriteDataStableAddressIDs {
    * previous hints.
    */
   uint64_t next_id_hint = 0;
+  /**
+   * When serializing a single ID into its own buffer (see #WriteData.id_buffer), the stable
+   * address ids of the #WriteData that the buffer is written into. Its #pointer_map and #used_ids
+   * are read-only while IDs are serialized, and take precedence over the local ones.
+   */
+  const WriteDataStableAddressIDs *parent = nullptr;
 };
 
 struct WriteData {
@@ -129,6 +136,12 @@ struct WriteData {
    */
   Set<const void *> per_id_written_shared_addresses;
 
+  /**
+   * When set, everything written is appended to this buffer instead, so that an ID can be
+   * serialized independently of the others, see #write_ids_parallel.
+   */
+  Vector<uchar> *id_buffer;
+
   /** #MemFile writing (used for undo). */
   MemFileWriteData mem;
   /** When true, write to #WriteData.current, could also call 'is_undo'. */
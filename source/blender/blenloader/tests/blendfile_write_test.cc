@@ -0,0 +1,206 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+#include "blendfile_loading_base_test.h"
+
+#include <cstring>
+#include <string>
+
+#include "BLI_fileops.hh"
+#include "BLI_listbase.hh"
+#include "BLI_math_vector_types.hh"
+#include "BLI_path_utils.hh"
+#include "BLI_vector.hh"
+
+#include "BKE_appdir.hh"
+#include "BKE_global.hh"
+#include "BKE_lib_id.hh"
+#include "BKE_main.hh"
+#include "BKE_mesh.h"
+#include "BKE_mesh.hh"
+
+#include "BLO_readfile.hh"
+#include "BLO_writefile.hh"
+
+#include "DNA_ID.h"
+#include "DNA_mesh_types.h"
+#include "DNA_object_types.h"
+
+#include "MEM_guardedalloc.h"
+
+namespace blender {
+
+class BlendfileWritingTest : public BlendfileLoadingBaseTest {
+ protected:
+  Vector<std::string> written_files_;
+
+  void TearDown() override
+  {
+    for (const std::string &filepath : written_files_) {
+      BLI_delete(filepath.c_str(), false, false);
+    }
+    BlendfileLoadingBaseTest::TearDown();
+  }
+
+ public:
+  std::string temp_filepath(const char *filename)
+  {
+    const std::string filepath = std::string(BKE_tempdir_base()) + SEP_STR + filename;
+    written_files_.append(filepath);
+    return filepath;
+  }
+
+  bool write_file(Main *bmain,
+                  const std::string &filepath,
+                  const int write_flags,
+                  BlendFileWriteStats *r_stats = nullptr)
+  {
+    BlendFileWriteParams params{};
+    params.r_stats = r_stats;
+    return BLO_write_file(bmain, filepath.c_str(), write_flags, &params, nullptr);
+  }
+
+  static Vector<uint8_t> read_file_bytes(const std::string &filepath)
+  {
+    size_t size = 0;
+    void *data = BLI_file_read_binary_as_mem(filepath.c_str(), 0, &size);
+    if (data == nullptr) {
+      return {};
+    }
+    Vector<uint8_t> bytes(Span<uint8_t>(static_cast<const uint8_t *>(data), int64_t(size)));
+    MEM_freeN(data);
+    return bytes;
+  }
+
+  static Vector<std::string> id_names(Main *bmain)
+  {
+    Vector<std::string> names;
+    ID *id;
+    FOREACH_MAIN_ID_BEGIN (bmain, id) {
+      names.append(id->name);
+    }
+    FOREACH_MAIN_ID_END;
+    return names;
+  }
+
+  /** Read the written file back and check that it contains the same data-blocks. */
+  void expect_file_matches_main(const std::string &filepath, Main *bmain)
+  {
+    BlendFileReadReport reports = {};
+    BlendFileData *written = BLO_read_from_file(filepath.c_str(), BLO_READ_SKIP_NONE, &reports);
+    ASSERT_NE(written, nullptr);
+    EXPECT_EQ_SPAN<std::string>(id_names(bmain), id_names(written->main));
+
+    ListBase &meshes = bmain->meshes;
+    ListBase &written_meshes = written->main->meshes;
+    ASSERT_EQ(BLI_listbase_count(&meshes), BLI_listbase_count(&written_meshes));
+    for (Mesh *mesh = static_cast<Mesh *>(meshes.first),
+              *written_mesh = static_cast<Mesh *>(written_meshes.first);
+         mesh;
+         mesh = static_cast<Mesh *>(mesh->id.next),
+              written_mesh = static_cast<Mesh *>(written_mesh->id.next))
+    {
+      EXPECT_EQ(mesh->verts_num, written_mesh->verts_num);
+      EXPECT_EQ(mesh->edges_num, written_mesh->edges_num);
+      EXPECT_EQ(mesh->faces_num, written_mesh->faces_num);
+      EXPECT_EQ(mesh->corners_num, written_mesh->corners_num);
+    }
+
+    BLO_blendfiledata_free(written);
+  }
+
+  /** Write the loaded file twice, which has to give the same bytes regardless of scheduling. */
+  void test_write_deterministic(const int write_flags)
+  {
+    if (!blendfile_load("modifier_stack" SEP_STR "array_test.blend")) {
+      return;
+    }
+    const std::string filepath_a = temp_filepath("blendfile_write_test_a.blend");
+    const std::string filepath_b = temp_filepath("blendfile_write_test_b.blend");
+    ASSERT_TRUE(write_file(bfile->main, filepath_a, write_flags));
+    ASSERT_TRUE(write_file(bfile->main, filepath_b, write_flags));
+
+    const Vector<uint8_t> bytes_a = read_file_bytes(filepath_a);
+    const Vector<uint8_t> bytes_b = read_file_bytes(filepath_b);
+    ASSERT_FALSE(bytes_a.is_empty());
+    ASSERT_EQ(bytes_a.size(), bytes_b.size());
+    EXPECT_EQ(memcmp(bytes_a.data(), bytes_b.data(), bytes_a.size()), 0);
+
+    expect_file_matches_main(filepath_a, bfile->main);
+  }
+
+  /** Add a mesh with a fake user, large enough to be compressed in several frames. */
+  static void add_large_mesh(Main *bmain)
+  {
+    const int verts_num = 400000;
+    Mesh *mesh_src = BKE_mesh_new_nomain(verts_num, 0, 0, 0);
+    MutableSpan<float3> positions = mesh_src->vert_positions_for_write();
+    for (const int i : positions.index_range()) {
+      positions[i] = float3(float(i % 101), float(i % 103), float(i));
+    }
+    Mesh *mesh = BKE_mesh_add(bmain, "LargeMesh");
+    BKE_mesh_nomain_to_mesh(mesh_src, mesh, nullptr);
+    id_fake_user_set(&mesh->id);
+  }
+
+  static const Object *first_object(Main *bmain)
+  {
+    return static_cast<const Object *>(bmain->objects.first);
+  }
+};
+
+TEST_F(BlendfileWritingTest, WriteTwiceIdentical)
+{
+  test_write_deterministic(0);
+}
+
+TEST_F(BlendfileWritingTest, WriteTwiceIdenticalCompressed)
+{
+  test_write_deterministic(G_FILE_COMPRESS);
+}
+
+TEST_F(BlendfileWritingTest, SaveModifySaveCompressed)
+{
+  if (!blendfile_load("modifier_stack" SEP_STR "array_test.blend")) {
+    return;
+  }
+  Object *ob = static_cast<Object *>(bfile->main->objects.first);
+  ASSERT_NE(ob, nullptr);
+  add_large_mesh(bfile->main);
+
+  /* The second save reuses compressed frames of the first one for unchanged data. */
+  const std::string filepath = temp_filepath("blendfile_write_test_resave.blend");
+  BLI_delete(filepath.c_str(), false, false);
+  BlendFileWriteStats stats;
+  ASSERT_TRUE(write_file(bfile->main, filepath, G_FILE_COMPRESS, &stats));
+  EXPECT_GT(stats.frames_num, 1);
+  EXPECT_EQ(stats.frames_reused_num, 0);
+
+  ob->loc[0] += 1.0f;
+  BlendFileWriteStats resave_stats;
+  ASSERT_TRUE(write_file(bfile->main, filepath, G_FILE_COMPRESS, &resave_stats));
+  EXPECT_EQ(resave_stats.frames_num, stats.frames_num);
+  EXPECT_GT(resave_stats.frames_reused_num, 0);
+  /* The frame with the changed object is compressed again. */
+  EXPECT_LT(resave_stats.frames_reused_num, resave_stats.frames_num);
+
+  /* Reusing frames must give the same file as compressing everything again. */
+  const std::string filepath_fresh = temp_filepath("blendfile_write_test_fresh.blend");
+  BLI_delete(filepath_fresh.c_str(), false, false);
+  BlendFileWriteStats fresh_stats;
+  ASSERT_TRUE(write_file(bfile->main, filepath_fresh, G_FILE_COMPRESS, &fresh_stats));
+  EXPECT_EQ(fresh_stats.frames_reused_num, 0);
+  const Vector<uint8_t> bytes = read_file_bytes(filepath);
+  const Vector<uint8_t> bytes_fresh = read_file_bytes(filepath_fresh);
+  ASSERT_EQ(bytes.size(), bytes_fresh.size());
+  EXPECT_EQ(memcmp(bytes.data(), bytes_fresh.data(), bytes.size()), 0);
+
+  expect_file_matches_main(filepath, bfile->main);
+  BlendFileReadReport reports = {};
+  BlendFileData *written = BLO_read_from_file(filepath.c_str(), BLO_READ_SKIP_NONE, &reports);
+  ASSERT_NE(written, nullptr);
+  EXPECT_EQ(first_object(written->main)->loc[0], ob->loc[0]);
+  BLO_blendfiledata_free(written);
+}
+
+}  // namespace blender
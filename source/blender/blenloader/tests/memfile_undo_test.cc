@@ -0,0 +1,158 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+#include "blendfile_loading_base_test.h"
+
+#include "BLI_listbase.hh"
+#include "BLI_map.hh"
+#include "BLI_set.hh"
+#include "BLI_vector.hh"
+
+#include "BKE_main.hh"
+
+#include "BLO_undofile.hh"
+#include "BLO_writefile.hh"
+
+#include "DNA_object_types.h"
+
+namespace blender {
+
+class MemFileUndoTest : public BlendfileLoadingBaseTest {
+ protected:
+  /** Memfiles that are not freed yet, from oldest to newest. */
+  Vector<MemFile *> memfiles_;
+  /** Size of each memfile that is not chunk data, i.e. estimated size of shared data. */
+  Map<MemFile *, size_t> shared_size_;
+
+  void TearDown() override
+  {
+    for (MemFile *memfile : memfiles_) {
+      BLO_memfile_free(memfile);
+      MEM_delete(memfile);
+    }
+    BlendfileLoadingBaseTest::TearDown();
+  }
+
+ public:
+  /**
+   * Chunk data that is used by the memfile but none of the older ones. Chunks with the same data
+   * use the same buffer.
+   */
+  Set<const char *> chunks_data_not_in_older(const MemFile *memfile)
+  {
+    Set<const char *> older_data;
+    for (const MemFile *older : memfiles_) {
+      if (older == memfile) {
+        break;
+      }
+      for (const MemFileChunk &chunk : older->chunks) {
+        older_data.add(chunk.buf);
+      }
+    }
+    Set<const char *> data;
+    for (const MemFileChunk &chunk : memfile->chunks) {
+      if (!older_data.contains(chunk.buf)) {
+        data.add(chunk.buf);
+      }
+    }
+    return data;
+  }
+
+  size_t chunks_data_size_not_in_older(const MemFile *memfile)
+  {
+    const Set<const char *> data = chunks_data_not_in_older(memfile);
+    size_t size = 0;
+    Set<const char *> counted;
+    for (const MemFileChunk &chunk : memfile->chunks) {
+      if (data.contains(chunk.buf) && counted.add(chunk.buf)) {
+        size += chunk.size;
+      }
+    }
+    return size;
+  }
+
+  MemFile *write_memfile()
+  {
+    MemFile *memfile = MEM_new_zeroed<MemFile>(__func__);
+    MemFile *reference = memfiles_.is_empty() ? nullptr : memfiles_.last();
+    if (reference) {
+      BLO_memfile_clear_future(reference);
+    }
+    EXPECT_TRUE(BLO_write_file_mem(bfile->main, reference, memfile, 0));
+    memfiles_.append(memfile);
+    shared_size_.add(memfile, memfile->size - chunks_data_size_not_in_older(memfile));
+    return memfile;
+  }
+
+  void free_memfile(MemFile *memfile)
+  {
+    const int64_t index = memfiles_.first_index_of(memfile);
+    if (index + 1 < memfiles_.size()) {
+      /* Like freeing an undo step. */
+      BLO_memfile_merge(memfile, memfiles_[index + 1]);
+    }
+    else {
+      BLO_memfile_free(memfile);
+    }
+    memfiles_.remove(index);
+    shared_size_.remove(memfile);
+    MEM_delete(memfile);
+  }
+
+  /** Every chunk data has to be counted once, in the oldest memfile using it. */
+  void expect_sizes_valid()
+  {
+    for (MemFile *memfile : memfiles_) {
+      EXPECT_EQ(memfile->size,
+                shared_size_.lookup(memfile) + chunks_data_size_not_in_older(memfile));
+    }
+  }
+};
+
+TEST_F(MemFileUndoTest, ChunkDeduplicationAndSize)
+{
+  if (!blendfile_load("modifier_stack" SEP_STR "array_test.blend")) {
+    return;
+  }
+  Object *ob = static_cast<Object *>(bfile->main->objects.first);
+  ASSERT_NE(ob, nullptr);
+  const float loc_orig = ob->loc[0];
+
+  MemFile *memfile_a = write_memfile();
+  EXPECT_GT(memfile_a->size, 0);
+
+  /* Nothing changed, so no new chunk data. */
+  MemFile *memfile_b = write_memfile();
+  EXPECT_TRUE(chunks_data_not_in_older(memfile_b).is_empty());
+
+  ob->loc[0] = loc_orig + 1.0f;
+  MemFile *memfile_c = write_memfile();
+  EXPECT_FALSE(chunks_data_not_in_older(memfile_c).is_empty());
+
+  /* Changing the object back reuses the data of the older steps, not just the previous one. */
+  ob->loc[0] = loc_orig;
+  MemFile *memfile_d = write_memfile();
+  EXPECT_TRUE(chunks_data_not_in_older(memfile_d).is_empty());
+  expect_sizes_valid();
+
+  /* Data of the freed steps that is still used has to be counted in other steps. */
+  free_memfile(memfile_a);
+  expect_sizes_valid();
+  EXPECT_GT(memfile_b->size, 0);
+
+  free_memfile(memfile_c);
+  expect_sizes_valid();
+
+  free_memfile(memfile_b);
+  expect_sizes_valid();
+
+  /* The written data can still be read after the steps it was shared with are freed. */
+  Main *bmain_undo = BLO_memfile_main_get(memfile_d, bfile->main, nullptr);
+  ASSERT_NE(bmain_undo, nullptr);
+  const Object *ob_read = static_cast<const Object *>(bmain_undo->objects.first);
+  ASSERT_NE(ob_read, nullptr);
+  EXPECT_EQ(ob_read->loc[0], loc_orig);
+  BKE_main_free(bmain_undo);
+}
+
+}  // namespace blender
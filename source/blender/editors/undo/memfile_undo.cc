@@ -334,6 +334,18 @@ static void memfile_undosys_step_free(UndoStep *us_p)
   }
 
   BKE_memfile_undo_free(us->data);
+
+  /* Data that was shared with the freed step is now counted in another memfile step. */
+  for (UndoStep *us_iter = BKE_undosys_step_same_type_prev(us_p); us_iter;
+       us_iter = BKE_undosys_step_same_type_prev(us_iter))
+  {
+    us_iter->data_size = reinterpret_cast<MemFileUndoStep *>(us_iter)->data->memfile.size;
+  }
+  for (UndoStep *us_iter = BKE_undosys_step_same_type_next(us_p); us_iter;
+       us_iter = BKE_undosys_step_same_type_next(us_iter))
+  {
+    us_iter->data_size = reinterpret_cast<MemFileUndoStep *>(us_iter)->data->memfile.size;
+  }
 }
 
 void ED_memfile_undosys_type(UndoType *ut)
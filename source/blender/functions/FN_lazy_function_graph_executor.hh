@@ -12,6 +12,7 @@
  */
 
 #include "BLI_generic_pointer.hh"
+#include "BLI_timeit.hh"
 #include "BLI_vector.hh"
 
 #include "FN_lazy_function_graph.hh"
@@ -30,6 +31,10 @@ class GraphExecutorLogger {
     bool socket_values = true;
     bool before_node_execute = true;
     bool after_node_execute = true;
+    /**
+     * Measuring the time of every node is not free, so it is only done when explicitly requested.
+     */
+    bool node_execution_time = false;
 
     explicit LoggingEnabledState(const bool enabled)
         : socket_values(enabled), before_node_execute(enabled), after_node_execute(enabled)
@@ -51,6 +56,15 @@ class GraphExecutorLogger {
                                       const Params &params,
                                       const Context &context) const;
 
+  /**
+   * Called after every execution of a node when #LoggingEnabledState::node_execution_time is set.
+   * A node may be executed multiple times, e.g. when it requests more inputs.
+   */
+  virtual void log_node_execution_time(const FunctionNode &node,
+                                       timeit::TimePoint start,
+                                       timeit::TimePoint end,
+                                       const Context &context) const;
+
   virtual void dump_when_outputs_are_missing(const FunctionNode &node,
                                              Span<const OutputSocket *> missing_sockets,
                                              const Context &context) const;
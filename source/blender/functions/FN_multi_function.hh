@@ -113,6 +113,13 @@ class MultiFunction : NonCopyable, NonMovable {
      * educated guess about a good grain size.
      */
     bool uniform_execution_time = true;
+    /**
+     * Every output element only depends on the input elements at the same index, only single
+     * values are passed in and out, and the result does not depend on the indices in the mask.
+     * This allows evaluating the function on small compacted chunks of data, which is used to
+     * fuse multiple such functions in a #ProcedureExecutor.
+     */
+    bool is_elementwise = false;
   };
 
   ExecutionHints execution_hints() const;
@@ -513,6 +513,15 @@ template<typename CallFn, typename... ParamTags> class CustomMF : public MultiFu
   {
     call_fn_(mask, params);
   }
+
+  ExecutionHints get_execution_hints() const override
+  {
+    ExecutionHints hints;
+    /* The call function is generated from an element function that only sees one element at a
+     * time, see #build_multi_function_call_from_element_fn. */
+    hints.is_elementwise = true;
+    return hints;
+  }
 };
 
 template<typename Out, typename... In, typename ElementFn, typename ExecPreset>
@@ -835,6 +844,7 @@ class CustomMF_GenericConstant : public MultiFunction {
   void call(const IndexMask &mask, Params params, Context context) const override;
   void hash_unique(UniqueHashBytes &hash) const override;
   bool equals(const MultiFunction &other) const override;
+  ExecutionHints get_execution_hints() const override;
 };
 
 /**
@@ -873,6 +883,13 @@ template<typename T> class CustomMF_Constant : public MultiFunction {
     mask.foreach_index_optimized<int64_t>([&](const int64_t i) { new (&output[i]) T(value_); });
   }
 
+  ExecutionHints get_execution_hints() const override
+  {
+    ExecutionHints hints;
+    hints.is_elementwise = true;
+    return hints;
+  }
+
   void hash_unique(UniqueHashBytes &hash) const override
   {
     hash.add(&CustomMF_GenericConstant::HASH_ID);
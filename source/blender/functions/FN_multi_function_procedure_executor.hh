@@ -17,6 +17,12 @@ class ProcedureExecutor : public MultiFunction {
  private:
   Signature signature_;
   const Procedure &procedure_;
+  /**
+   * Non-empty when the procedure is a linear sequence of calls to element-wise functions (see
+   * #ExecutionHints::is_elementwise). Those are executed in order for small chunks of the mask at
+   * a time, so that intermediate values do not have to be stored for the full mask.
+   */
+  Vector<const CallInstruction *> fused_calls_;
 
  public:
   ProcedureExecutor(const Procedure &procedure);
@@ -24,6 +30,8 @@ class ProcedureExecutor : public MultiFunction {
   void call(const IndexMask &mask, Params params, Context context) const override;
 
  private:
+  void call_fused(const IndexMask &full_mask, Params params, const Context &context) const;
+
   ExecutionHints get_execution_hints() const override;
 };
 
@@ -117,6 +117,14 @@ void GraphExecutorLogger::log_after_node_execute(const FunctionNode &node,
   UNUSED_VARS(node, params, context);
 }
 
+void GraphExecutorLogger::log_node_execution_time(const FunctionNode &node,
+                                                  const timeit::TimePoint start,
+                                                  const timeit::TimePoint end,
+                                                  const Context &context) const
+{
+  UNUSED_VARS(node, start, end, context);
+}
+
 Vector<const FunctionNode *> GraphExecutorSideEffectProvider::get_nodes_with_side_effects(
     const Context &context) const
 {
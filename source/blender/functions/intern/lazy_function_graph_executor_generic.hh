@@ -25,6 +25,13 @@
  * exceptions). The assumption here is that most nodes are only ever touched by a single thread and
  * therefore the lock contention is reduced the more nodes there are.
  *
+ * While a node is locked, only the bookkeeping of the node state is done. Values and storage that
+ * become unused are destructed only after the lock has been released, because their destructors
+ * may run arbitrary code (e.g. freeing large geometries in parallel). This way, a thread holding a
+ * node lock never starts working on other tasks, which would be able to deadlock when they try to
+ * lock the same node. That also means that locking a node does not need task isolation, which
+ * keeps the per-node overhead low for graphs that consist of many small nodes.
+ *
  * Similar to how a #LazyFunction can be thought of as a state machine (see `FN_lazy_function.hh`),
  * each node can also be thought of as a state machine. The state of a node contains the evaluation
  * state of its inputs and outputs. Every time a node is executed, it has to advance its state in
@@ -210,6 +217,13 @@ struct LockedNode {
   Vector<const OutputSocket *> delayed_required_outputs;
   Vector<const OutputSocket *> delayed_unused_outputs;
 
+  /**
+   * Values and node storage that are freed right after the node is not locked anymore. See the
+   * comment at the top of the file for why this is delayed.
+   */
+  Vector<GMutablePointer> delayed_destruct_values;
+  void *delayed_destruct_storage = nullptr;
+
   LockedNode(const Node &node, NodeState &node_state) : node(node), node_state(node_state) {}
 };
 
@@ -750,6 +764,7 @@ class GenericGraphExecutor {
     NodeState &node_state = *node_states_[node.index_in_graph()];
     OutputState &output_state = node_state.outputs[index_in_node];
 
+    bool graph_input_became_unused = false;
     this->with_locked_node(
         node, node_state, current_task, local_data, [&](LockedNode &locked_node) {
           output_state.potential_target_sockets -= 1;
@@ -758,9 +773,7 @@ class GenericGraphExecutor {
             if (output_state.usage == ValueUsage::Maybe) {
               output_state.usage = ValueUsage::Unused;
               if (node.is_interface()) {
-                const int graph_input_index =
-                    self_.graph_input_index_by_socket_index_[socket.index()];
-                params_->set_input_unused(graph_input_index);
+                graph_input_became_unused = true;
               }
               else {
                 /* Schedule as priority node. This allows freeing up memory earlier which results
@@ -770,6 +783,11 @@ class GenericGraphExecutor {
             }
           }
         });
+    if (graph_input_became_unused) {
+      /* Notify the caller outside of the lock, because it may free the value right away. */
+      const int graph_input_index = self_.graph_input_index_by_socket_index_[socket.index()];
+      params_->set_input_unused(graph_input_index);
+    }
   }
 
   void schedule_node(LockedNode &locked_node, CurrentTask &current_task, const bool is_priority)
@@ -813,12 +831,20 @@ class GenericGraphExecutor {
     LockedNode locked_node{node, node_state};
     if (this->use_multi_threading()) {
       std::lock_guard lock{node_state.mutex};
-      threading::isolate_task([&]() { f(locked_node); });
+      f(locked_node);
     }
     else {
       f(locked_node);
     }
 
+    for (GMutablePointer value : locked_node.delayed_destruct_values) {
+      value.destruct();
+    }
+    if (locked_node.delayed_destruct_storage != nullptr) {
+      const FunctionNode &fn_node = static_cast<const FunctionNode &>(node);
+      fn_node.function().destruct_storage(locked_node.delayed_destruct_storage);
+    }
+
     this->send_output_required_notifications(
         locked_node.delayed_required_outputs, current_task, local_data);
     this->send_output_unused_notifications(
@@ -1042,14 +1068,13 @@ class GenericGraphExecutor {
         this->set_input_unused(locked_node, input_socket);
       }
       else if (input_state.usage == ValueUsage::Used) {
-        this->destruct_input_value_if_exists(input_state, input_socket.type());
+        this->destruct_input_value_after_unlock(locked_node, input_state, input_socket.type());
       }
     }
 
     if (node_state.storage != nullptr) {
       if (node.is_function()) {
-        const FunctionNode &fn_node = static_cast<const FunctionNode &>(node);
-        fn_node.function().destruct_storage(node_state.storage);
+        locked_node.delayed_destruct_storage = node_state.storage;
       }
       node_state.storage = nullptr;
     }
@@ -1063,6 +1088,16 @@ class GenericGraphExecutor {
     }
   }
 
+  void destruct_input_value_after_unlock(LockedNode &locked_node,
+                                         InputState &input_state,
+                                         const CPPType &type)
+  {
+    if (input_state.value != nullptr) {
+      locked_node.delayed_destruct_values.append({type, input_state.value});
+      input_state.value = nullptr;
+    }
+  }
+
   void execute_node(const FunctionNode &node,
                     NodeState &node_state,
                     CurrentTask &current_task,
@@ -1093,7 +1128,7 @@ class GenericGraphExecutor {
     }
     input_state.usage = ValueUsage::Unused;
 
-    this->destruct_input_value_if_exists(input_state, input_socket.type());
+    this->destruct_input_value_after_unlock(locked_node, input_state, input_socket.type());
     if (input_state.was_ready_for_execution) {
       return;
     }
@@ -1486,12 +1521,20 @@ inline void GenericGraphExecutor::execute_node(const FunctionNode &node,
   };
 
   lazy_threading::HintReceiver blocking_hint_receiver{blocking_hint_fn};
+  std::optional<timeit::TimePoint> start_time;
+  if (logging_enabled_state_.node_execution_time) {
+    start_time = timeit::Clock::now();
+  }
   if (self_.node_execute_wrapper_) {
     self_.node_execute_wrapper_->execute_node(node, node_params, fn_context);
   }
   else {
     fn.execute(node_params, fn_context);
   }
+  if (start_time) {
+    const timeit::TimePoint end_time = timeit::Clock::now();
+    self_.logger_->log_node_execution_time(node, *start_time, end_time, fn_context);
+  }
 
   if (logging_enabled_state_.after_node_execute) {
     self_.logger_->log_after_node_execute(node, node_params, fn_context);
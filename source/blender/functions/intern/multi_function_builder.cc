@@ -39,6 +39,13 @@ void CustomMF_GenericConstant::call(const IndexMask &mask,
   type_.fill_construct_indices(value_, output.data(), mask);
 }
 
+MultiFunction::ExecutionHints CustomMF_GenericConstant::get_execution_hints() const
+{
+  ExecutionHints hints;
+  hints.is_elementwise = true;
+  return hints;
+}
+
 void CustomMF_GenericConstant::hash_unique(UniqueHashBytes &hash) const
 {
   hash.add(&HASH_ID);
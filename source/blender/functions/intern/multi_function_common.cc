@@ -89,6 +89,14 @@ class PowFunction : public MultiFunction {
     }
     pow_generic->call(mask, params, context);
   }
+
+ private:
+  ExecutionHints get_execution_hints() const override
+  {
+    ExecutionHints hints;
+    hints.is_elementwise = true;
+    return hints;
+  }
 };
 
 class DivideFunction : public MultiFunction {
@@ -169,6 +177,14 @@ class DivideFunction : public MultiFunction {
     const float fraction = frexpf(x, &exp);
     return fraction == 0.5f;
   }
+
+ private:
+  ExecutionHints get_execution_hints() const override
+  {
+    ExecutionHints hints;
+    hints.is_elementwise = true;
+    return hints;
+  }
 };
 
 static void register_common_functions_impl()
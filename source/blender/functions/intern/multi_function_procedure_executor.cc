@@ -8,6 +8,77 @@
 
 namespace blender::fn::multi_function {
 
+/**
+ * Find the call instructions of procedures that only consist of a linear sequence of calls to
+ * element-wise functions. Returns an empty vector if the procedure can't be fused.
+ */
+static Vector<const CallInstruction *> find_fusable_calls(const Procedure &procedure)
+{
+  Array<bool> is_initialized(procedure.variables().size(), false);
+  for (const ConstParameter &param : procedure.params()) {
+    if (!param.variable->data_type().is_single() || param.type == ParamType::Mutable) {
+      return {};
+    }
+    if (param.type == ParamType::Input) {
+      is_initialized[param.variable->index_in_procedure()] = true;
+    }
+  }
+
+  Vector<const CallInstruction *> calls;
+  const Instruction *instruction = procedure.entry();
+  while (instruction != nullptr) {
+    switch (instruction->type()) {
+      case InstructionType::Call: {
+        const CallInstruction &call_instruction = *static_cast<const CallInstruction *>(
+            instruction);
+        const MultiFunction &fn = call_instruction.fn();
+        if (!fn.execution_hints().is_elementwise) {
+          return {};
+        }
+        for (const int param_index : fn.param_indices()) {
+          const ParamType param_type = fn.param_type(param_index);
+          const Variable *variable = call_instruction.params()[param_index];
+          if (!param_type.data_type().is_single() ||
+              param_type.interface_type() == ParamType::Mutable)
+          {
+            return {};
+          }
+          if (param_type.interface_type() == ParamType::Output && variable != nullptr) {
+            /* Every variable must only be initialized once, because values are only destructed
+             * at the end of every chunk. */
+            if (is_initialized[variable->index_in_procedure()]) {
+              return {};
+            }
+            is_initialized[variable->index_in_procedure()] = true;
+          }
+        }
+        calls.append(&call_instruction);
+        instruction = call_instruction.next();
+        break;
+      }
+      case InstructionType::Destruct: {
+        instruction = static_cast<const DestructInstruction *>(instruction)->next();
+        break;
+      }
+      case InstructionType::Dummy: {
+        instruction = static_cast<const DummyInstruction *>(instruction)->next();
+        break;
+      }
+      case InstructionType::Branch: {
+        return {};
+      }
+      case InstructionType::Return: {
+        /* A single call is executed without intermediate values anyway. */
+        if (calls.size() < 2) {
+          return {};
+        }
+        return calls;
+      }
+    }
+  }
+  return {};
+}
+
 ProcedureExecutor::ProcedureExecutor(const Procedure &procedure) : procedure_(procedure)
 {
   SignatureBuilder builder("Procedure Executor", signature_);
@@ -17,6 +88,8 @@ ProcedureExecutor::ProcedureExecutor(const Procedure &procedure) : procedure_(pr
   }
 
   this->set_signature(&signature_);
+
+  fused_calls_ = find_fusable_calls(procedure);
 }
 
 using IndicesSplitVectors = std::array<Vector<int64_t>, 2>;
@@ -1157,10 +1230,205 @@ class InstructionScheduler {
   }
 };
 
+/** State of a variable while executing a fused procedure, see #ProcedureExecutor::call_fused. */
+struct FusedVariable {
+  const CPPType *type = nullptr;
+  /** Set when the variable has the same value for every index. */
+  void *single_value = nullptr;
+  /** Input provided by the caller. */
+  const GVArray *caller_input = nullptr;
+  /** Output buffer provided by the caller. */
+  GMutableSpan caller_output;
+  /** Buffer large enough for a single chunk. */
+  void *chunk_buffer = nullptr;
+  /** Values of the current chunk, either #chunk_buffer or caller memory. */
+  void *chunk_data = nullptr;
+  /** True when #chunk_buffer contains values that have to be destructed. */
+  bool chunk_buffer_initialized = false;
+};
+
+void ProcedureExecutor::call_fused(const IndexMask &full_mask,
+                                   Params params,
+                                   const Context &context) const
+{
+  /* Small enough that the values of all variables in a chunk stay in the CPU cache while they
+   * are passed through all functions, but large enough that the per-call overhead of the
+   * multi-functions is negligible. */
+  static constexpr int64_t chunk_size = 512;
+
+  LinearAllocator<> allocator;
+  Array<FusedVariable> variables(procedure_.variables().size());
+  for (const Variable *variable : procedure_.variables()) {
+    variables[variable->index_in_procedure()].type = &variable->data_type().single_type();
+  }
+
+  for (const int param_index : this->param_indices()) {
+    const Variable &variable = *procedure_.params()[param_index].variable;
+    FusedVariable &fused_variable = variables[variable.index_in_procedure()];
+    if (this->param_type(param_index).interface_type() == ParamType::Input) {
+      const GVArray &varray = params.readonly_single_input(param_index);
+      if (varray.is_single()) {
+        fused_variable.single_value = allocator.allocate(*fused_variable.type);
+        varray.get_internal_single_to_uninitialized(fused_variable.single_value);
+      }
+      else {
+        fused_variable.caller_input = &varray;
+      }
+    }
+    else {
+      fused_variable.caller_output = params.uninitialized_single_output(param_index);
+    }
+  }
+
+  /* Functions whose inputs are all single values are only evaluated once, like in the general
+   * case. The remaining functions are evaluated per chunk. */
+  static const IndexMask one_mask(1);
+  Vector<const CallInstruction *> chunk_calls;
+  for (const CallInstruction *call_instruction : fused_calls_) {
+    const MultiFunction &fn = call_instruction->fn();
+    const Span<const Variable *> param_variables = call_instruction->params();
+    const bool all_inputs_single = std::all_of(
+        fn.param_indices().begin(), fn.param_indices().end(), [&](const int param_index) {
+          return fn.param_type(param_index).interface_type() != ParamType::Input ||
+                 variables[param_variables[param_index]->index_in_procedure()].single_value;
+        });
+    if (!all_inputs_single) {
+      chunk_calls.append(call_instruction);
+      continue;
+    }
+    ParamsBuilder sub_params{fn, &one_mask};
+    for (const int param_index : fn.param_indices()) {
+      const Variable *variable = param_variables[param_index];
+      if (variable == nullptr) {
+        sub_params.add_ignored_single_output();
+        continue;
+      }
+      FusedVariable &fused_variable = variables[variable->index_in_procedure()];
+      if (fn.param_type(param_index).interface_type() == ParamType::Input) {
+        sub_params.add_readonly_single_input(GPointer(fused_variable.type,
+                                                      fused_variable.single_value));
+      }
+      else {
+        fused_variable.single_value = allocator.allocate(*fused_variable.type);
+        sub_params.add_uninitialized_single_output(
+            GMutableSpan(*fused_variable.type, fused_variable.single_value, 1));
+      }
+    }
+    fn.call(one_mask, sub_params, context);
+  }
+
+  for (FusedVariable &fused_variable : variables) {
+    if (fused_variable.single_value == nullptr) {
+      fused_variable.chunk_buffer = allocator.allocate(
+          fused_variable.type->size * chunk_size, fused_variable.type->alignment);
+    }
+  }
+
+  for (int64_t chunk_start = 0; chunk_start < full_mask.size(); chunk_start += chunk_size) {
+    const IndexMask chunk_mask = full_mask.slice(
+        chunk_start, std::min(chunk_size, full_mask.size() - chunk_start));
+    const int64_t size = chunk_mask.size();
+    const std::optional<IndexRange> chunk_range = chunk_mask.to_range();
+    const IndexMask local_mask(size);
+
+    for (FusedVariable &fused_variable : variables) {
+      if (fused_variable.single_value != nullptr) {
+        continue;
+      }
+      const int64_t type_size = fused_variable.type->size;
+      fused_variable.chunk_data = fused_variable.chunk_buffer;
+      if (fused_variable.caller_input != nullptr) {
+        const GVArray &varray = *fused_variable.caller_input;
+        if (chunk_range && varray.is_span()) {
+          /* Read from the caller memory directly. */
+          fused_variable.chunk_data = const_cast<void *>(POINTER_OFFSET(
+              varray.get_internal_span().data(), type_size * chunk_range->start()));
+        }
+        else {
+          varray.materialize_compressed_to_uninitialized(chunk_mask,
+                                                         fused_variable.chunk_buffer);
+          fused_variable.chunk_buffer_initialized = true;
+        }
+      }
+      else if (!fused_variable.caller_output.is_empty() && chunk_range) {
+        /* Write into the caller memory directly. */
+        fused_variable.chunk_data = POINTER_OFFSET(fused_variable.caller_output.data(),
+                                                   type_size * chunk_range->start());
+      }
+    }
+
+    for (const CallInstruction *call_instruction : chunk_calls) {
+      const MultiFunction &fn = call_instruction->fn();
+      ParamsBuilder sub_params{fn, &local_mask};
+      for (const int param_index : fn.param_indices()) {
+        const Variable *variable = call_instruction->params()[param_index];
+        if (variable == nullptr) {
+          sub_params.add_ignored_single_output();
+          continue;
+        }
+        FusedVariable &fused_variable = variables[variable->index_in_procedure()];
+        const CPPType &type = *fused_variable.type;
+        if (fn.param_type(param_index).interface_type() == ParamType::Input) {
+          if (fused_variable.single_value != nullptr) {
+            sub_params.add_readonly_single_input(
+                GVArray::from_single_ref(type, size, fused_variable.single_value));
+          }
+          else {
+            sub_params.add_readonly_single_input(GSpan(type, fused_variable.chunk_data, size));
+          }
+        }
+        else {
+          sub_params.add_uninitialized_single_output(
+              GMutableSpan(type, fused_variable.chunk_data, size));
+          if (fused_variable.chunk_data == fused_variable.chunk_buffer) {
+            fused_variable.chunk_buffer_initialized = true;
+          }
+        }
+      }
+      fn.call(local_mask, sub_params, context);
+    }
+
+    for (FusedVariable &fused_variable : variables) {
+      if (!fused_variable.chunk_buffer_initialized) {
+        continue;
+      }
+      const CPPType &type = *fused_variable.type;
+      if (!fused_variable.caller_output.is_empty()) {
+        /* Move the values of this chunk to their final location. */
+        void *dst = fused_variable.caller_output.data();
+        chunk_mask.foreach_index([&](const int64_t i, const int64_t pos) {
+          type.relocate_construct(POINTER_OFFSET(fused_variable.chunk_buffer, type.size * pos),
+                                  POINTER_OFFSET(dst, type.size * i));
+        });
+      }
+      else {
+        type.destruct_n(fused_variable.chunk_buffer, size);
+      }
+      fused_variable.chunk_buffer_initialized = false;
+    }
+  }
+
+  for (FusedVariable &fused_variable : variables) {
+    if (fused_variable.single_value == nullptr) {
+      continue;
+    }
+    if (!fused_variable.caller_output.is_empty()) {
+      fused_variable.type->fill_construct_indices(
+          fused_variable.single_value, fused_variable.caller_output.data(), full_mask);
+    }
+    fused_variable.type->destruct(fused_variable.single_value);
+  }
+}
+
 void ProcedureExecutor::call(const IndexMask &full_mask, Params params, Context context) const
 {
   BLI_assert(procedure_.validate());
 
+  if (!fused_calls_.is_empty()) {
+    this->call_fused(full_mask, params, context);
+    return;
+  }
+
   AlignedBuffer<512, 64> local_buffer;
   LinearAllocator<> linear_allocator;
   linear_allocator.provide_buffer(local_buffer);
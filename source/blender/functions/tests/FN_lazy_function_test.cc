@@ -119,6 +119,57 @@ TEST_F(LazyFunctionTest, SideEffects)
   EXPECT_EQ(dst2, 105);
 }
 
+class ExecutionTimeLogger : public GraphExecutor::Logger {
+ public:
+  mutable Vector<const FunctionNode *> timed_nodes;
+
+  LoggingEnabledState get_logging_enabled_state(const Context & /*context*/) const override
+  {
+    LoggingEnabledState state{false};
+    state.node_execution_time = true;
+    return state;
+  }
+
+  void log_node_execution_time(const FunctionNode &node,
+                               const timeit::TimePoint start,
+                               const timeit::TimePoint end,
+                               const Context & /*context*/) const override
+  {
+    EXPECT_LE(start, end);
+    timed_nodes.append(&node);
+  }
+};
+
+TEST_F(LazyFunctionTest, NodeExecutionTime)
+{
+  const AddLazyFunction add_fn;
+
+  Graph graph;
+  FunctionNode &add_node_1 = graph.add_function(add_fn);
+  FunctionNode &add_node_2 = graph.add_function(add_fn);
+  GraphInputSocket &graph_input = graph.add_input(CPPType::get<int>());
+  GraphOutputSocket &graph_output = graph.add_output(CPPType::get<int>());
+
+  graph.add_link(graph_input, add_node_1.input(0));
+  graph.add_link(graph_input, add_node_1.input(1));
+  graph.add_link(add_node_1.output(0), add_node_2.input(0));
+  graph.add_link(graph_input, add_node_2.input(1));
+  graph.add_link(add_node_2.output(0), graph_output);
+
+  graph.update_node_indices();
+
+  const ExecutionTimeLogger logger;
+  GraphExecutor executor_fn{graph, {&graph_input}, {&graph_output}, &logger, nullptr, nullptr};
+  int result = 0;
+  execute_lazy_function_eagerly(
+      executor_fn, nullptr, nullptr, std::make_tuple(3), std::make_tuple(&result));
+
+  EXPECT_EQ(result, 9);
+  ASSERT_EQ(logger.timed_nodes.size(), 2);
+  EXPECT_EQ(logger.timed_nodes[0], &add_node_1);
+  EXPECT_EQ(logger.timed_nodes[1], &add_node_2);
+}
+
 class PartialEvaluationTestFunction : public LazyFunction {
  public:
   PartialEvaluationTestFunction()
@@ -427,4 +427,73 @@ TEST_F(MultiFunctionProcedureTest, OutputBufferReplaced)
   EXPECT_EQ(output[2], output_value);
 }
 
+TEST_F(MultiFunctionProcedureTest, FusedElementwiseCalls)
+{
+  /**
+   * procedure(int a, int b, int *out) {
+   *   int c = a * b;
+   *   int d = c + a;
+   *   out = d + 10;
+   * }
+   */
+
+  auto add_fn = build::SI2_SO<int, int, int>("add", [](int a, int b) { return a + b; });
+  auto mul_fn = build::SI2_SO<int, int, int>("mul", [](int a, int b) { return a * b; });
+  auto add_10_fn = build::SI1_SO<int, int>("add 10", [](int a) { return a + 10; });
+
+  Procedure procedure;
+  ProcedureBuilder builder{procedure};
+
+  Variable *var_a = &builder.add_single_input_parameter<int>();
+  Variable *var_b = &builder.add_single_input_parameter<int>();
+  auto [var_c] = builder.add_call<1>(mul_fn, {var_a, var_b});
+  builder.add_destruct(*var_b);
+  auto [var_d] = builder.add_call<1>(add_fn, {var_c, var_a});
+  builder.add_destruct({var_a, var_c});
+  auto [var_out] = builder.add_call<1>(add_10_fn, {var_d});
+  builder.add_destruct(*var_d);
+  builder.add_return();
+  builder.add_output_parameter(*var_out);
+
+  EXPECT_TRUE(procedure.validate());
+
+  ProcedureExecutor procedure_fn{procedure};
+
+  /* Use more elements than fit into a single chunk. */
+  const int size = 2000;
+  Array<int> inputs(size);
+  for (const int i : inputs.index_range()) {
+    inputs[i] = i;
+  }
+
+  {
+    Array<int> results(size, -1);
+    const IndexMask mask(size);
+    ParamsBuilder params{procedure_fn, &mask};
+    params.add_readonly_single_input(inputs.as_span());
+    params.add_readonly_single_input_value(3);
+    params.add_uninitialized_single_output(results.as_mutable_span());
+    ContextBuilder context;
+    procedure_fn.call(mask, params, context);
+    for (const int i : IndexRange(size)) {
+      EXPECT_EQ(results[i], i * 3 + i + 10);
+    }
+  }
+  {
+    Array<int> results(size, -1);
+    IndexMaskMemory memory;
+    const IndexMask mask = IndexMask::from_predicate(
+        IndexRange(size), memory, [](const int64_t i) { return i % 3 == 0; });
+    ParamsBuilder params{procedure_fn, &mask};
+    params.add_readonly_single_input(inputs.as_span());
+    params.add_readonly_single_input(inputs.as_span());
+    params.add_uninitialized_single_output(results.as_mutable_span());
+    ContextBuilder context;
+    procedure_fn.call(mask, params, context);
+    for (const int i : IndexRange(size)) {
+      EXPECT_EQ(results[i], (i % 3 == 0) ? i * i + i + 10 : -1);
+    }
+  }
+}
+
 }  // namespace blender::fn::multi_function::tests
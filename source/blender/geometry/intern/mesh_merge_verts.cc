@@ -20,6 +20,7 @@
 #include "BKE_customdata.hh"
 #include "BKE_deform.hh"
 #include "BKE_mesh.hh"
+#include "BKE_mesh_mapping.hh"
 #include "DNA_meshdata_types.h"
 
 #include "DNA_object_types.h"
@@ -339,33 +340,53 @@ static Vector<WeldEdge> weld_edge_ctx_alloc_and_find_collapsed(Span<int2> edges,
                                                                int *r_edge_collapsed_len)
 {
   /* Edge Context. */
-  int edge_collapsed_len = 0;
+  const int edge_collapsed_len = threading::parallel_reduce(
+      edges.index_range(),
+      4096,
+      0,
+      [&](const IndexRange range, int collapsed_len) {
+        for (const int i : range) {
+          int v1 = edges[i][0];
+          int v2 = edges[i][1];
+          int v_dest_1 = vert_dest_map[v1];
+          int v_dest_2 = vert_dest_map[v2];
+          if (v_dest_1 == OUT_OF_CONTEXT && v_dest_2 == OUT_OF_CONTEXT) {
+            r_edge_dest_map[i] = OUT_OF_CONTEXT;
+            continue;
+          }
 
-  Vector<WeldEdge> wedge;
-  wedge.reserve(edges.size());
+          const int vert_a = (v_dest_1 == OUT_OF_CONTEXT) ? v1 : v_dest_1;
+          const int vert_b = (v_dest_2 == OUT_OF_CONTEXT) ? v2 : v_dest_2;
 
-  for (const int i : edges.index_range()) {
-    int v1 = edges[i][0];
-    int v2 = edges[i][1];
-    int v_dest_1 = vert_dest_map[v1];
-    int v_dest_2 = vert_dest_map[v2];
-    if (v_dest_1 == OUT_OF_CONTEXT && v_dest_2 == OUT_OF_CONTEXT) {
-      r_edge_dest_map[i] = OUT_OF_CONTEXT;
-      continue;
-    }
+          if (vert_a == vert_b) {
+            r_edge_dest_map[i] = ELEM_COLLAPSED;
+            collapsed_len++;
+          }
+          else {
+            r_edge_dest_map[i] = i;
+          }
+        }
+        return collapsed_len;
+      },
+      std::plus<>());
 
-    const int vert_a = (v_dest_1 == OUT_OF_CONTEXT) ? v1 : v_dest_1;
-    const int vert_b = (v_dest_2 == OUT_OF_CONTEXT) ? v2 : v_dest_2;
+  /* Compact the remaining edges of the context, keeping their order. */
+  IndexMaskMemory memory;
+  const IndexMask wedge_mask = IndexMask::from_predicate(
+      edges.index_range(), memory, [&](const int i) { return r_edge_dest_map[i] >= 0; });
 
-    if (vert_a == vert_b) {
-      r_edge_dest_map[i] = ELEM_COLLAPSED;
-      edge_collapsed_len++;
-    }
-    else {
-      wedge.append({i, vert_a, vert_b});
-      r_edge_dest_map[i] = i;
-    }
-  }
+  Vector<WeldEdge> wedge;
+  wedge.resize(wedge_mask.size());
+  wedge_mask.foreach_index(
+      [&](const int i, const int pos) {
+        const int2 &edge = edges[i];
+        const int v_dest_1 = vert_dest_map[edge[0]];
+        const int v_dest_2 = vert_dest_map[edge[1]];
+        wedge[pos] = {i,
+                      (v_dest_1 == OUT_OF_CONTEXT) ? edge[0] : v_dest_1,
+                      (v_dest_2 == OUT_OF_CONTEXT) ? edge[1] : v_dest_2};
+      },
+      exec_mode::grain_size(4096));
 
   *r_edge_collapsed_len = edge_collapsed_len;
   return wedge;
@@ -386,102 +407,87 @@ static void weld_edge_find_doubles(Span<WeldEdge> weld_edges,
                                    int *r_edge_double_kill_len)
 {
   /* Setup Edge Overlap. */
-  int edge_double_kill_len = 0;
-
   if (weld_edges.is_empty()) {
-    *r_edge_double_kill_len = edge_double_kill_len;
+    *r_edge_double_kill_len = 0;
     return;
   }
 
-  /* Add +1 to allow calculation of the length of the last group. */
-  Array<int> v_links(mvert_num + 1, 0);
-
-  for (const WeldEdge &we : weld_edges) {
-    BLI_assert(r_edge_dest_map[we.edge_orig] != ELEM_COLLAPSED);
-    BLI_assert(we.vert_a != we.vert_b);
-    v_links[we.vert_a]++;
-    v_links[we.vert_b]++;
-  }
-
-  int link_len = 0;
-  for (const int i : IndexRange(mvert_num)) {
-    link_len += v_links[i];
-    v_links[i] = link_len;
-  }
-  v_links.last() = link_len;
-
-  BLI_assert(link_len > 0);
-  Array<int> link_edge_buffer(link_len);
-
-  /* Use a reverse for loop to ensure that indexes are assigned in ascending order. */
-  for (int i = weld_edges.size(); i--;) {
-    const WeldEdge &we = weld_edges[i];
-    BLI_assert(r_edge_dest_map[we.edge_orig] != ELEM_COLLAPSED);
-    int dst_vert_a = we.vert_a;
-    int dst_vert_b = we.vert_b;
-
-    link_edge_buffer[--v_links[dst_vert_a]] = i;
-    link_edge_buffer[--v_links[dst_vert_b]] = i;
-  }
-
-  for (const int i : weld_edges.index_range()) {
-    const WeldEdge &we = weld_edges[i];
-    BLI_assert(r_edge_dest_map[we.edge_orig] != OUT_OF_CONTEXT);
-    if (r_edge_dest_map[we.edge_orig] != we.edge_orig) {
-      /* Already a duplicate. */
-      continue;
+  Array<int2> weld_edge_verts(weld_edges.size());
+  threading::parallel_for(weld_edges.index_range(), 4096, [&](const IndexRange range) {
+    for (const int i : range) {
+      const WeldEdge &we = weld_edges[i];
+      BLI_assert(r_edge_dest_map[we.edge_orig] != ELEM_COLLAPSED);
+      BLI_assert(we.vert_a != we.vert_b);
+      weld_edge_verts[i] = int2(we.vert_a, we.vert_b);
     }
+  });
 
-    int dst_vert_a = we.vert_a;
-    int dst_vert_b = we.vert_b;
-
-    const int link_a = v_links[dst_vert_a];
-    const int link_b = v_links[dst_vert_b];
-
-    int edges_len_a = v_links[dst_vert_a + 1] - link_a;
-    int edges_len_b = v_links[dst_vert_b + 1] - link_b;
-
-    int edge_orig = we.edge_orig;
-    if (edges_len_a <= 1 || edges_len_b <= 1) {
-      /* This edge would form a group with only one element.
-       * For better performance, mark these edges and avoid forming these groups. */
-      r_edge_dest_map[edge_orig] = OUT_OF_CONTEXT;
-      continue;
-    }
+  /* The weld edges of each vertex, in ascending order. */
+  Array<int> v_links_offsets;
+  Array<int> v_links_indices;
+  const GroupedSpan<int> v_links = bke::mesh::build_vert_to_edge_map(
+      weld_edge_verts, mvert_num, v_links_offsets, v_links_indices);
+
+  /* Edges connecting the same vertices form a group that is merged into the edge with the lowest
+   * index. Every edge finds its own group independently, so this is done in parallel. */
+  const int edge_double_kill_len = threading::parallel_reduce(
+      weld_edges.index_range(),
+      1024,
+      0,
+      [&](const IndexRange range, int kill_len) {
+        for (const int i : range) {
+          const WeldEdge &we = weld_edges[i];
+          BLI_assert(r_edge_dest_map[we.edge_orig] == we.edge_orig);
+
+          const Span<int> edges_ctx_a = v_links[we.vert_a];
+          const Span<int> edges_ctx_b = v_links[we.vert_b];
+          if (edges_ctx_a.size() <= 1 || edges_ctx_b.size() <= 1) {
+            /* This edge would form a group with only one element.
+             * For better performance, mark these edges and avoid forming these groups. */
+            r_edge_dest_map[we.edge_orig] = OUT_OF_CONTEXT;
+            continue;
+          }
 
-    int *edges_ctx_a = &link_edge_buffer[link_a];
-    int *edges_ctx_b = &link_edge_buffer[link_b];
+          /* Intersect the sorted edges of both vertices. */
+          int group_first = -1;
+          int group_len = 0;
+          int index_a = 0, index_b = 0;
+          while (index_a < edges_ctx_a.size() && index_b < edges_ctx_b.size()) {
+            const int e_ctx_a = edges_ctx_a[index_a];
+            const int e_ctx_b = edges_ctx_b[index_b];
+            if (e_ctx_a < e_ctx_b) {
+              index_a++;
+            }
+            else if (e_ctx_b < e_ctx_a) {
+              index_b++;
+            }
+            else {
+              if (group_len == 0) {
+                group_first = e_ctx_a;
+              }
+              group_len++;
+              index_a++;
+              index_b++;
+            }
+          }
+          BLI_assert(group_len >= 1);
 
-    const int edge_double_len_prev = edge_double_kill_len;
-    for (; edges_len_a--; edges_ctx_a++) {
-      int e_ctx_a = *edges_ctx_a;
-      if (e_ctx_a == i) {
-        continue;
-      }
-      while (edges_len_b && *edges_ctx_b < e_ctx_a) {
-        edges_ctx_b++;
-        edges_len_b--;
-      }
-      if (edges_len_b == 0) {
-        break;
-      }
-      int e_ctx_b = *edges_ctx_b;
-      if (e_ctx_a == e_ctx_b) {
-        const WeldEdge &we_b = weld_edges[e_ctx_b];
-        BLI_assert(ELEM(we_b.vert_a, dst_vert_a, dst_vert_b));
-        BLI_assert(ELEM(we_b.vert_b, dst_vert_a, dst_vert_b));
-        BLI_assert(we_b.edge_orig != edge_orig);
-        BLI_assert(r_edge_dest_map[we_b.edge_orig] == we_b.edge_orig);
-        r_edge_dest_map[we_b.edge_orig] = edge_orig;
-        edge_double_kill_len++;
-      }
-    }
-    if (edge_double_len_prev == edge_double_kill_len) {
-      /* This edge would form a group with only one element.
-       * For better performance, mark these edges and avoid forming these groups. */
-      r_edge_dest_map[edge_orig] = OUT_OF_CONTEXT;
-    }
-  }
+          if (group_len == 1) {
+            /* This edge would form a group with only one element.
+             * For better performance, mark these edges and avoid forming these groups. */
+            r_edge_dest_map[we.edge_orig] = OUT_OF_CONTEXT;
+          }
+          else if (group_first != i) {
+            const WeldEdge &we_first = weld_edges[group_first];
+            BLI_assert(ELEM(we_first.vert_a, we.vert_a, we.vert_b));
+            BLI_assert(ELEM(we_first.vert_b, we.vert_a, we.vert_b));
+            r_edge_dest_map[we.edge_orig] = we_first.edge_orig;
+            kill_len++;
+          }
+        }
+        return kill_len;
+      },
+      std::plus<>());
 
   *r_edge_double_kill_len = edge_double_kill_len;
 }
@@ -589,109 +595,123 @@ static void weld_poly_loop_ctx_alloc(const OffsetIndices<int> faces,
   /* Loop/Poly Context. */
   Array<int> loop_map(corner_verts.size());
   Array<int> face_map(faces.size());
-  int wloop_len = 0;
-  int wpoly_len = 0;
-  int max_ctx_poly_len = 4;
-
-  Vector<WeldLoop> wloop;
-  wloop.reserve(corner_verts.size());
-
-  Vector<WeldPoly> wpoly;
-  wpoly.reserve(faces.size());
-
-  int maybe_new_poly = 0;
 
-  for (const int i : faces.index_range()) {
-    const int loopstart = faces[i].start();
-    const int totloop = faces[i].size();
-    const int loop_end = loopstart + totloop - 1;
-    int v_first = corner_verts[loopstart];
-    int v_dest_first = vert_dest_map[v_first];
-    bool is_vert_first_ctx = v_dest_first != OUT_OF_CONTEXT;
-
-    int v_next = v_first;
-    int v_dest_next = v_dest_first;
-    bool is_vert_next_ctx = is_vert_first_ctx;
-
-    int prev_wloop_len = wloop_len;
-    for (const int loop_orig : faces[i]) {
-      int v = v_next;
-      int v_dest = v_dest_next;
-      bool is_vert_ctx = is_vert_next_ctx;
+  /* A corner is part of the context when its vertex or the vertex of the next corner is. */
+  const auto is_loop_ctx = [&](const IndexRange face, const int loop_orig) {
+    const int loop_next = loop_orig == face.last() ? face.first() : loop_orig + 1;
+    return vert_dest_map[corner_verts[loop_orig]] != OUT_OF_CONTEXT ||
+           vert_dest_map[corner_verts[loop_next]] != OUT_OF_CONTEXT;
+  };
 
-      int loop_next;
-      if (loop_orig != loop_end) {
-        loop_next = loop_orig + 1;
-        v_next = corner_verts[loop_next];
-        v_dest_next = vert_dest_map[v_next];
-        is_vert_next_ctx = v_dest_next != OUT_OF_CONTEXT;
+  /* First count the context loops of every face, so that the context can be filled in
+   * parallel, in the same order as when looping over the faces sequentially. */
+  Array<int> wloop_offsets_data(faces.size() + 1);
+  threading::parallel_for(faces.index_range(), 1024, [&](const IndexRange range) {
+    for (const int i : range) {
+      const IndexRange face = faces[i];
+      int loop_ctx_len = 0;
+      for (const int loop_orig : face) {
+        if (is_loop_ctx(face, loop_orig)) {
+          loop_ctx_len++;
+        }
+        else {
+          loop_map[loop_orig] = OUT_OF_CONTEXT;
+        }
       }
-      else {
-        loop_next = loopstart;
-        v_next = v_first;
-        v_dest_next = v_dest_first;
-        is_vert_next_ctx = is_vert_first_ctx;
+      wloop_offsets_data[i] = loop_ctx_len;
+      if (loop_ctx_len == 0) {
+        face_map[i] = OUT_OF_CONTEXT;
       }
+    }
+  });
+  const OffsetIndices<int> wloop_offsets = offset_indices::accumulate_counts_to_offsets(
+      wloop_offsets_data);
 
-      if (is_vert_ctx || is_vert_next_ctx) {
-        int e = corner_edges[loop_orig];
-        int e_dest = edge_dest_map[e];
-        bool is_edge_ctx = e_dest != OUT_OF_CONTEXT;
-
-        wloop.increase_size_by_unchecked(1);
-        WeldLoop &wl = wloop.last();
-        wl.vert = is_vert_ctx ? v_dest : v;
-        wl.edge = is_edge_ctx ? e_dest : e;
-        wl.loop_orig = loop_orig;
-        wl.loop_next = loop_next;
+  IndexMaskMemory memory;
+  const IndexMask faces_ctx = IndexMask::from_predicate(
+      faces.index_range(), memory, [&](const int i) { return !wloop_offsets[i].is_empty(); });
 
-        loop_map[loop_orig] = wloop_len++;
-      }
-      else {
-        loop_map[loop_orig] = OUT_OF_CONTEXT;
-      }
-    }
+  Vector<WeldLoop> wloop;
+  wloop.resize(wloop_offsets.total_size());
 
-    if (wloop_len != prev_wloop_len) {
-      int loop_ctx_len = wloop_len - prev_wloop_len;
-      wpoly.increase_size_by_unchecked(1);
+  Vector<WeldPoly> wpoly;
+  wpoly.resize(faces_ctx.size());
+
+  faces_ctx.foreach_index(
+      [&](const int i, const int wpoly_index) {
+        const IndexRange face = faces[i];
+        const IndexRange face_wloops = wloop_offsets[i];
+        int wloop_index = face_wloops.first();
+        for (const int loop_orig : face) {
+          if (!is_loop_ctx(face, loop_orig)) {
+            continue;
+          }
+          const int v = corner_verts[loop_orig];
+          const int v_dest = vert_dest_map[v];
+          const int e = corner_edges[loop_orig];
+          const int e_dest = edge_dest_map[e];
+
+          WeldLoop &wl = wloop[wloop_index];
+          wl.vert = (v_dest != OUT_OF_CONTEXT) ? v_dest : v;
+          wl.edge = (e_dest != OUT_OF_CONTEXT) ? e_dest : e;
+          wl.loop_orig = loop_orig;
+          wl.loop_next = loop_orig == face.last() ? face.first() : loop_orig + 1;
+
+          loop_map[loop_orig] = wloop_index++;
+        }
 
-      WeldPoly &wp = wpoly.last();
-      wp.poly_dst = OUT_OF_CONTEXT;
-      wp.poly_orig = i;
-      wp.loop_start = loopstart;
-      wp.loop_end = loop_end;
+        WeldPoly &wp = wpoly[wpoly_index];
+        wp.poly_dst = OUT_OF_CONTEXT;
+        wp.poly_orig = i;
+        wp.loop_start = face.first();
+        wp.loop_end = face.last();
 
-      wp.loop_ctx_start = prev_wloop_len;
-      wp.loop_ctx_len = loop_ctx_len;
+        wp.loop_ctx_start = face_wloops.first();
+        wp.loop_ctx_len = face_wloops.size();
 
 #ifdef USE_WELD_DEBUG
-      wp.loop_len = totloop;
+        wp.loop_len = face.size();
 #endif
 
-      face_map[i] = wpoly_len++;
-      if (totloop > 5 && loop_ctx_len > 1) {
-        /* We could be smarter here and actually count how many new polygons will be created.
-         * But counting this can be inefficient as it depends on the number of non-consecutive
-         * self face merges. For now just estimate a maximum value. */
-        int max_new = std::min((totloop / 3), loop_ctx_len) - 1;
-        maybe_new_poly += max_new;
-        CLAMP_MIN(max_ctx_poly_len, totloop);
-      }
-    }
-    else {
-      face_map[i] = OUT_OF_CONTEXT;
-    }
-  }
+        face_map[i] = wpoly_index;
+      },
+      exec_mode::grain_size(1024));
+
+  struct NewPolyInfo {
+    int maybe_new_poly = 0;
+    int max_ctx_poly_len = 4;
+  };
+  const NewPolyInfo new_poly_info = threading::parallel_reduce(
+      wpoly.index_range(),
+      4096,
+      NewPolyInfo(),
+      [&](const IndexRange range, NewPolyInfo info) {
+        for (const WeldPoly &wp : wpoly.as_span().slice(range)) {
+          const int totloop = (wp.loop_end - wp.loop_start) + 1;
+          if (totloop > 5 && wp.loop_ctx_len > 1) {
+            /* We could be smarter here and actually count how many new polygons will be
+             * created. But counting this can be inefficient as it depends on the number of
+             * non-consecutive self face merges. For now just estimate a maximum value. */
+            int max_new = std::min((totloop / 3), wp.loop_ctx_len) - 1;
+            info.maybe_new_poly += max_new;
+            CLAMP_MIN(info.max_ctx_poly_len, totloop);
+          }
+        }
+        return info;
+      },
+      [](const NewPolyInfo &a, const NewPolyInfo &b) {
+        return NewPolyInfo{a.maybe_new_poly + b.maybe_new_poly,
+                           std::max(a.max_ctx_poly_len, b.max_ctx_poly_len)};
+      });
 
-  wpoly.reserve(wpoly.size() + maybe_new_poly);
+  wpoly.reserve(wpoly.size() + new_poly_info.maybe_new_poly);
 
   r_weld_mesh->wloop = std::move(wloop);
   r_weld_mesh->wpoly = std::move(wpoly);
   r_weld_mesh->wpoly_new_len = 0;
   r_weld_mesh->loop_map = std::move(loop_map);
   r_weld_mesh->face_map = std::move(face_map);
-  r_weld_mesh->max_face_len = max_ctx_poly_len;
+  r_weld_mesh->max_face_len = new_poly_info.max_ctx_poly_len;
 }
 
 static void weld_poly_split_recursive(int poly_loop_len,
@@ -1627,98 +1647,118 @@ static Mesh *create_merged_mesh(const Mesh &mesh,
   });
 
   /* Faces/Loops. */
-  Vector<int> corner_src_index_offset_data;
-  Vector<int> corner_src_index_data;
-
-  corner_src_index_offset_data.reserve(result->corners_num + 1);
-  corner_src_index_data.reserve(mesh.corners_num);
-
-  int r_i = 0;
-  int loop_cur = 0;
-  Vector<bool> dst_face_unaffected;
-  dst_face_unaffected.reserve(result_nfaces);
-  Vector<int> dst_to_src_faces;
-  dst_to_src_faces.reserve(result_nfaces);
-  Array<int, 64> group_buffer(weld_mesh.max_face_len);
-  for (const int i : src_faces.index_range()) {
-    const int loop_start = loop_cur;
-    const int poly_ctx = weld_mesh.face_map[i];
-    if (poly_ctx == OUT_OF_CONTEXT) {
-      for (const int loop_orig : src_faces[i]) {
-        corner_src_index_offset_data.append_unchecked(corner_src_index_data.size());
-        corner_src_index_data.append(loop_orig);
-        loop_cur++;
+
+  /* The result faces are the remaining source faces in their original order, followed by the new
+   * faces created by splitting. "Face sources" index both, the new faces come after the source
+   * faces. The corners of every face are counted first, so they can be written in parallel. */
+  const int src_faces_num = src_faces.size();
+  const IndexRange new_wpoly_range = weld_mesh.wpoly.index_range().take_back(
+      weld_mesh.wpoly_new_len);
+  const int face_sources_num = src_faces_num + new_wpoly_range.size();
+  const auto get_face_source_wpoly = [&](const int face_source) -> const WeldPoly * {
+    if (face_source < src_faces_num) {
+      const int poly_ctx = weld_mesh.face_map[face_source];
+      return poly_ctx == OUT_OF_CONTEXT ? nullptr : &weld_mesh.wpoly[poly_ctx];
+    }
+    return &weld_mesh.wpoly[new_wpoly_range[face_source - src_faces_num]];
+  };
+  const auto wpoly_iter_begin =
+      [&](WeldLoopOfPolyIter &iter, const WeldPoly &wp, int *group_buffer) {
+        return weld_iter_loop_of_poly_begin(iter,
+                                            wp,
+                                            weld_mesh.wloop,
+                                            src_corner_verts,
+                                            src_corner_edges,
+                                            weld_mesh.loop_map,
+                                            group_buffer) &&
+               wp.poly_dst == OUT_OF_CONTEXT;
+      };
+
+  /* The number of result corners, and the number of source corners mixed into them. */
+  Array<int> dst_corners_num(face_sources_num);
+  Array<int> src_corners_num(face_sources_num);
+  threading::parallel_for(IndexRange(face_sources_num), 1024, [&](const IndexRange range) {
+    Array<int, 64> group_buffer(weld_mesh.max_face_len);
+    for (const int face_source : range) {
+      const WeldPoly *wp = get_face_source_wpoly(face_source);
+      if (wp == nullptr) {
+        dst_corners_num[face_source] = src_faces[face_source].size();
+        src_corners_num[face_source] = src_faces[face_source].size();
+        continue;
       }
-      dst_face_unaffected.append_unchecked(true);
-    }
-    else {
-      const WeldPoly &wp = weld_mesh.wpoly[poly_ctx];
+      int dst_num = 0;
+      int src_num = 0;
       WeldLoopOfPolyIter iter;
-      if (!weld_iter_loop_of_poly_begin(iter,
-                                        wp,
-                                        weld_mesh.wloop,
-                                        src_corner_verts,
-                                        src_corner_edges,
-                                        weld_mesh.loop_map,
-                                        group_buffer.data()))
-      {
-        continue;
+      if (wpoly_iter_begin(iter, *wp, group_buffer.data())) {
+        do {
+          dst_num++;
+          src_num += iter.group_len;
+        } while (weld_iter_loop_of_poly_next(iter));
       }
+      dst_corners_num[face_source] = dst_num;
+      src_corners_num[face_source] = src_num;
+    }
+  });
 
-      if (wp.poly_dst != OUT_OF_CONTEXT) {
-        continue;
+  IndexMaskMemory memory;
+  const IndexMask dst_face_sources = IndexMask::from_predicate(
+      IndexRange(face_sources_num), memory, [&](const int face_source) {
+        return dst_corners_num[face_source] > 0;
+      });
+  BLI_assert(dst_face_sources.size() == result_nfaces);
+
+  Array<int> corner_src_offsets_data(result_nfaces + 1);
+  dst_face_sources.foreach_index(
+      [&](const int face_source, const int dst_face) {
+        dst_face_offsets[dst_face] = dst_corners_num[face_source];
+        corner_src_offsets_data[dst_face] = src_corners_num[face_source];
+      },
+      exec_mode::grain_size(4096));
+  const OffsetIndices<int> dst_faces_init = offset_indices::accumulate_counts_to_offsets(
+      dst_face_offsets);
+  const OffsetIndices<int> corner_src_offsets = offset_indices::accumulate_counts_to_offsets(
+      corner_src_offsets_data);
+  BLI_assert(dst_faces_init.total_size() == result_nloops);
+
+  Array<int> corner_src_index_offset_data(result_nloops + 1);
+  Array<int> corner_src_index_data(corner_src_offsets.total_size());
+  corner_src_index_offset_data.last() = corner_src_index_data.size();
+
+  threading::parallel_for(dst_face_sources.index_range(), 1024, [&](const IndexRange range) {
+    Array<int, 64> group_buffer(weld_mesh.max_face_len);
+    dst_face_sources.slice(range).foreach_index([&](const int face_source, const int pos) {
+      const int dst_face = range.start() + pos;
+      int dst_corner = dst_faces_init[dst_face].start();
+      int src_index = corner_src_offsets[dst_face].start();
+      const WeldPoly *wp = get_face_source_wpoly(face_source);
+      if (wp == nullptr) {
+        for (const int loop_orig : src_faces[face_source]) {
+          corner_src_index_offset_data[dst_corner++] = src_index;
+          corner_src_index_data[src_index++] = loop_orig;
+        }
+        return;
+      }
+      WeldLoopOfPolyIter iter;
+      if (!wpoly_iter_begin(iter, *wp, group_buffer.data())) {
+        BLI_assert_unreachable();
+        return;
       }
-      dst_face_unaffected.append_unchecked(false);
       do {
-        corner_src_index_offset_data.append_unchecked(corner_src_index_data.size());
-        corner_src_index_data.extend(Span(group_buffer.data(), iter.group_len));
-        dst_corner_verts[loop_cur] = vert_final_map[iter.v];
-        dst_corner_edges[loop_cur] = edge_final_map[iter.e];
-        loop_cur++;
+        corner_src_index_offset_data[dst_corner] = src_index;
+        for (const int loop_orig : Span(group_buffer.data(), iter.group_len)) {
+          corner_src_index_data[src_index++] = loop_orig;
+        }
+        dst_corner_verts[dst_corner] = vert_final_map[iter.v];
+        dst_corner_edges[dst_corner] = edge_final_map[iter.e];
+        dst_corner++;
       } while (weld_iter_loop_of_poly_next(iter));
-    }
-
-    dst_to_src_faces.append_unchecked(i);
-    dst_face_offsets[r_i] = loop_start;
-    r_i++;
-  }
-
-  /* New Polygons.
-   * NOTE: The number of "src" and "new" faces might not match `wpoly_new_len`. */
-  for (const int i : weld_mesh.wpoly.index_range().take_back(weld_mesh.wpoly_new_len)) {
-    const WeldPoly &wp = weld_mesh.wpoly[i];
-    const int loop_start = loop_cur;
-    WeldLoopOfPolyIter iter;
-    if (!weld_iter_loop_of_poly_begin(iter,
-                                      wp,
-                                      weld_mesh.wloop,
-                                      src_corner_verts,
-                                      src_corner_edges,
-                                      weld_mesh.loop_map,
-                                      group_buffer.data()))
-    {
-      continue;
-    }
-
-    if (wp.poly_dst != OUT_OF_CONTEXT) {
-      continue;
-    }
-    do {
-      corner_src_index_offset_data.append_unchecked(corner_src_index_data.size());
-      corner_src_index_data.extend(Span(group_buffer.data(), iter.group_len));
-      dst_corner_verts[loop_cur] = vert_final_map[iter.v];
-      dst_corner_edges[loop_cur] = edge_final_map[iter.e];
-      loop_cur++;
-    } while (weld_iter_loop_of_poly_next(iter));
-
-    dst_face_offsets[r_i] = loop_start;
-    r_i++;
-  }
-
-  BLI_assert(int(r_i) == result_nfaces);
-  BLI_assert(loop_cur == result_nloops);
+    });
+  });
 
-  corner_src_index_offset_data.append_unchecked(corner_src_index_data.size());
+  /* Result faces that map to a source face, which excludes the new faces. */
+  const IndexMask dst_faces_from_src = dst_face_sources.slice_content(IndexRange(src_faces_num));
+  Array<int> dst_to_src_faces(dst_faces_from_src.size());
+  dst_faces_from_src.to_indices<int>(dst_to_src_faces);
 
   const GroupedSpan<int> dst_to_src_corners(OffsetIndices<int>(corner_src_index_offset_data),
                                             corner_src_index_data);
@@ -1757,8 +1797,10 @@ static Mesh *create_merged_mesh(const Mesh &mesh,
     dst.drop_front(dst_to_src_faces.size()).fill(ORIGINDEX_NONE);
   }
 
-  IndexMaskMemory memory;
-  const IndexMask out_of_context_faces = IndexMask::from_bools(dst_face_unaffected, memory);
+  const IndexMask out_of_context_faces = IndexMask::from_predicate(
+      dst_to_src_faces.index_range(), memory, [&](const int dst_face_index) {
+        return weld_mesh.face_map[dst_to_src_faces[dst_face_index]] == OUT_OF_CONTEXT;
+      });
 
   out_of_context_faces.foreach_index(
       [&](const int dst_face_index) {
@@ -0,0 +1,273 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "BLI_array.hh"
+#include "BLI_map.hh"
+#include "BLI_ordered_edge.hh"
+#include "BLI_set.hh"
+#include "BLI_vector.hh"
+
+#include "BKE_gtest_base.hh"
+#include "BKE_lib_id.hh"
+#include "BKE_mesh.hh"
+
+#include "DNA_mesh_types.h"
+
+#include "GEO_mesh_merge_verts.hh"
+
+#include "testing/testing.h"
+
+namespace blender::geometry::tests {
+
+class MeshMergeVertsTest : public bke::BlenderGTestBase {};
+
+static int grid_vert(const int size, const int x, const int y)
+{
+  return y * (size + 1) + x;
+}
+
+/**
+ * A grid of quads. With \a exploded, every quad has its own four vertices, so that merging the
+ * vertices at the same position gives the connected grid.
+ */
+static Mesh *create_grid_mesh(const int size, const bool exploded)
+{
+  const int faces_num = size * size;
+  const int verts_num = exploded ? faces_num * 4 : (size + 1) * (size + 1);
+  Mesh *mesh = BKE_mesh_new_nomain(verts_num, 0, faces_num, faces_num * 4);
+  MutableSpan<float3> positions = mesh->vert_positions_for_write();
+  MutableSpan<int> face_offsets = mesh->face_offsets_for_write();
+  MutableSpan<int> corner_verts = mesh->corner_verts_for_write();
+  for (const int y : IndexRange(size)) {
+    for (const int x : IndexRange(size)) {
+      const int face = y * size + x;
+      const int2 corners[4] = {{x, y}, {x + 1, y}, {x + 1, y + 1}, {x, y + 1}};
+      face_offsets[face] = face * 4;
+      for (const int i : IndexRange(4)) {
+        const int vert = exploded ? face * 4 + i : grid_vert(size, corners[i].x, corners[i].y);
+        positions[vert] = float3(corners[i].x, corners[i].y, 0.0f);
+        corner_verts[face * 4 + i] = vert;
+      }
+    }
+  }
+  face_offsets.last() = faces_num * 4;
+  bke::mesh_calc_edges(*mesh, false, false);
+  return mesh;
+}
+
+/** Rotate the face so it starts with its smallest vertex, for comparisons up to rotation. */
+static Vector<int> canonical_face(const Span<int> face_verts)
+{
+  const int64_t start = std::min_element(face_verts.begin(), face_verts.end()) -
+                        face_verts.begin();
+  Vector<int> face;
+  for (const int64_t i : face_verts.index_range()) {
+    face.append(face_verts[(start + i) % face_verts.size()]);
+  }
+  return face;
+}
+
+/**
+ * Check the result against the sequential rules of vertex welding, for meshes where no face is
+ * welded onto itself in a way that requires splitting it:
+ * - Kept vertices stay in order.
+ * - Collapsed edges are removed, and duplicate edges merge into the one with the lowest index.
+ * - Consecutive corners on the same vertex are merged, and faces with fewer than three corners
+ *   are removed. Faces using the same vertices as a previous face are removed.
+ */
+static void expect_merge_result(const Mesh &src, const Span<int> vert_dest_map, const Mesh &result)
+{
+  ASSERT_TRUE(bke::mesh_is_valid(result));
+
+  Array<int> vert_final(src.verts_num);
+  Vector<float3> expect_positions;
+  for (const int vert : IndexRange(src.verts_num)) {
+    if (vert_dest_map[vert] == -1) {
+      vert_final[vert] = int(expect_positions.size());
+      expect_positions.append(src.vert_positions()[vert]);
+    }
+  }
+  for (const int vert : IndexRange(src.verts_num)) {
+    if (vert_dest_map[vert] != -1) {
+      vert_final[vert] = vert_final[vert_dest_map[vert]];
+    }
+  }
+  EXPECT_EQ_SPAN<float3>(expect_positions, result.vert_positions());
+
+  Vector<int2> expect_edges;
+  Set<OrderedEdge> edges_set;
+  for (const int2 edge : src.edges()) {
+    const int2 final_edge(vert_final[edge[0]], vert_final[edge[1]]);
+    if (final_edge[0] != final_edge[1] && edges_set.add(OrderedEdge(final_edge))) {
+      expect_edges.append(final_edge);
+    }
+  }
+  EXPECT_EQ_SPAN<int2>(expect_edges, result.edges());
+
+  Vector<Vector<int>> expect_faces;
+  Set<Vector<int>> faces_set;
+  for (const IndexRange face : src.faces()) {
+    Vector<int> face_verts;
+    for (const int corner : face) {
+      const int vert = vert_final[src.corner_verts()[corner]];
+      if (face_verts.is_empty() || face_verts.last() != vert) {
+        face_verts.append(vert);
+      }
+    }
+    while (face_verts.size() > 1 && face_verts.first() == face_verts.last()) {
+      face_verts.remove_last();
+    }
+    if (face_verts.size() < 3) {
+      continue;
+    }
+    Vector<int> sorted_verts = face_verts;
+    std::sort(sorted_verts.begin(), sorted_verts.end());
+    if (faces_set.add(sorted_verts)) {
+      expect_faces.append(canonical_face(face_verts));
+    }
+  }
+
+  const OffsetIndices faces = result.faces();
+  ASSERT_EQ(expect_faces.size(), faces.size());
+  for (const int face : faces.index_range()) {
+    const Span<int> face_verts = result.corner_verts().slice(faces[face]);
+    EXPECT_EQ_SPAN<int>(expect_faces[face], canonical_face(face_verts));
+
+    /* Every corner edge has to connect the vertex of the corner and the next corner. */
+    for (const int i : face_verts.index_range()) {
+      const int2 edge = result.edges()[result.corner_edges()[faces[face][i]]];
+      EXPECT_EQ(OrderedEdge(edge),
+                OrderedEdge(face_verts[i], face_verts[(i + 1) % face_verts.size()]));
+    }
+  }
+}
+
+static Mesh *merge_verts(const Mesh &mesh, MutableSpan<int> vert_dest_map)
+{
+  const int merged_num = std::count_if(
+      vert_dest_map.begin(), vert_dest_map.end(), [](const int dest) { return dest != -1; });
+  return mesh_merge_verts(mesh, vert_dest_map, merged_num, false);
+}
+
+/** Merge the vertices of an exploded grid into the vertex with the lowest index. */
+static void test_merge_exploded_grid(const int size)
+{
+  Mesh *mesh = create_grid_mesh(size, true);
+  Array<int> vert_dest_map(mesh->verts_num, -1);
+  Map<float3, int> first_vert;
+  for (const int vert : IndexRange(mesh->verts_num)) {
+    const int first = first_vert.lookup_or_add(mesh->vert_positions()[vert], vert);
+    if (first != vert) {
+      vert_dest_map[vert] = first;
+    }
+  }
+
+  Mesh *result = merge_verts(*mesh, vert_dest_map);
+  EXPECT_EQ(result->verts_num, (size + 1) * (size + 1));
+  EXPECT_EQ(result->edges_num, 2 * size * (size + 1));
+  EXPECT_EQ(result->faces_num, size * size);
+  expect_merge_result(*mesh, vert_dest_map, *result);
+
+  BKE_id_free(nullptr, mesh);
+  BKE_id_free(nullptr, result);
+}
+
+TEST_F(MeshMergeVertsTest, exploded_grid_small)
+{
+  test_merge_exploded_grid(3);
+}
+
+TEST_F(MeshMergeVertsTest, exploded_grid_large)
+{
+  /* Large enough for the parallel passes to use multiple tasks. */
+  test_merge_exploded_grid(128);
+}
+
+/** Merge a column of vertices into the previous one, which collapses the faces between them. */
+static void test_merge_collapsed_column(const int size)
+{
+  Mesh *mesh = create_grid_mesh(size, false);
+  Array<int> vert_dest_map(mesh->verts_num, -1);
+  for (const int y : IndexRange(size + 1)) {
+    vert_dest_map[grid_vert(size, 1, y)] = grid_vert(size, 0, y);
+  }
+
+  Mesh *result = merge_verts(*mesh, vert_dest_map);
+  EXPECT_EQ(result->verts_num, size * (size + 1));
+  EXPECT_EQ(result->faces_num, size * (size - 1));
+  expect_merge_result(*mesh, vert_dest_map, *result);
+
+  BKE_id_free(nullptr, mesh);
+  BKE_id_free(nullptr, result);
+}
+
+TEST_F(MeshMergeVertsTest, collapsed_faces_small)
+{
+  test_merge_collapsed_column(3);
+}
+
+TEST_F(MeshMergeVertsTest, collapsed_faces_large)
+{
+  test_merge_collapsed_column(128);
+}
+
+/** Merge every second row of vertices into the previous one, collapsing half of the faces. */
+TEST_F(MeshMergeVertsTest, collapsed_rows)
+{
+  const int size = 64;
+  Mesh *mesh = create_grid_mesh(size, false);
+  Array<int> vert_dest_map(mesh->verts_num, -1);
+  for (int y = 1; y <= size; y += 2) {
+    for (const int x : IndexRange(size + 1)) {
+      vert_dest_map[grid_vert(size, x, y)] = grid_vert(size, x, y - 1);
+    }
+  }
+
+  Mesh *result = merge_verts(*mesh, vert_dest_map);
+  EXPECT_EQ(result->faces_num, size * size / 2);
+  expect_merge_result(*mesh, vert_dest_map, *result);
+
+  BKE_id_free(nullptr, mesh);
+  BKE_id_free(nullptr, result);
+}
+
+/** Two grids at the same position, merging the second one removes all its faces as doubles. */
+TEST_F(MeshMergeVertsTest, duplicate_faces)
+{
+  const int size = 32;
+  Mesh *grid = create_grid_mesh(size, false);
+  const int grid_verts_num = grid->verts_num;
+  const int grid_faces_num = grid->faces_num;
+
+  Mesh *mesh = BKE_mesh_new_nomain(
+      grid_verts_num * 2, 0, grid_faces_num * 2, grid->corners_num * 2);
+  for (const int i : IndexRange(2)) {
+    mesh->vert_positions_for_write()
+        .slice(i * grid_verts_num, grid_verts_num)
+        .copy_from(grid->vert_positions());
+    for (const int corner : grid->corner_verts().index_range()) {
+      mesh->corner_verts_for_write()[i * grid->corners_num + corner] =
+          grid->corner_verts()[corner] + i * grid_verts_num;
+    }
+  }
+  offset_indices::fill_constant_group_size(4, 0, mesh->face_offsets_for_write());
+  bke::mesh_calc_edges(*mesh, false, false);
+
+  Array<int> vert_dest_map(mesh->verts_num, -1);
+  for (const int vert : IndexRange(grid_verts_num)) {
+    vert_dest_map[grid_verts_num + vert] = vert;
+  }
+
+  Mesh *result = merge_verts(*mesh, vert_dest_map);
+  EXPECT_EQ(result->verts_num, grid_verts_num);
+  EXPECT_EQ(result->edges_num, grid->edges_num);
+  EXPECT_EQ(result->faces_num, grid_faces_num);
+  expect_merge_result(*mesh, vert_dest_map, *result);
+
+  BKE_id_free(nullptr, grid);
+  BKE_id_free(nullptr, mesh);
+  BKE_id_free(nullptr, result);
+}
+
+}  // namespace blender::geometry::tests
@@ -12,6 +12,7 @@
 
 #include "BLI_endian_switch.hh"
 #include "BLI_string_ref.hh"
+#include "BLI_task.hh"
 
 #include "fast_float.h"
 
@@ -102,6 +103,12 @@ static void endian_switch_array(uint8_t *ptr, int type_size, int size)
 
 namespace io::ply {
 
+/**
+ * Number of vertex rows that are read from the file at once, before they are converted in
+ * parallel. This bounds the memory used by the intermediate data.
+ */
+static constexpr int64_t VERTEX_ROWS_PER_BATCH = 64 * 1024;
+
 static const int data_type_size[] = {0, 1, 1, 2, 2, 4, 4, 4, 8};
 static_assert(std::size(data_type_size) == PLY_TYPE_COUNT, "PLY data type size table mismatch");
 
@@ -133,13 +140,8 @@ static int get_index(const PlyElement &element, StringRef property)
   return -1;
 }
 
-static const char *parse_row_ascii(PlyReadBuffer &file, Vector<float> &r_values)
+static void parse_line_ascii(const Span<char> line, MutableSpan<float> r_values)
 {
-  Span<char> line = file.read_line();
-  if (line.is_empty()) {
-    return "Could not read row of ASCII property";
-  }
-
   /* Parse whole line as floats. */
   const char *p = line.data();
   const char *end = p + line.size();
@@ -149,6 +151,15 @@ static const char *parse_row_ascii(PlyReadBuffer &file, Vector<float> &r_values)
     p = parse_float(p, end, 0.0f, val);
     r_values[value_idx++] = val;
   }
+}
+
+static const char *parse_row_ascii(PlyReadBuffer &file, Vector<float> &r_values)
+{
+  Span<char> line = file.read_line();
+  if (line.is_empty()) {
+    return "Could not read row of ASCII property";
+  }
+  parse_line_ascii(line, r_values);
   return nullptr;
 }
 
@@ -196,22 +207,18 @@ template<typename T> static T get_binary_value(PlyDataTypes type, const uint8_t
   return val;
 }
 
-static const char *parse_row_binary(PlyReadBuffer &file,
-                                    const PlyHeader &header,
-                                    const PlyElement &element,
-                                    Vector<uint8_t> &r_scratch,
-                                    Vector<float> &r_values)
+/**
+ * Convert a row of an element with fixed-size properties. The row is modified in place when the
+ * endianness has to be switched.
+ */
+static void convert_row_binary(const PlyHeader &header,
+                               const PlyElement &element,
+                               uint8_t *row,
+                               MutableSpan<float> r_values)
 {
-  if (element.stride == 0) {
-    return "Vertex/Edge element contains list properties, this is not supported";
-  }
-  BLI_assert(r_scratch.size() == element.stride);
+  BLI_assert(ELEM(header.type, PlyFormatType::BINARY_LE, PlyFormatType::BINARY_BE));
   BLI_assert(r_values.size() == element.properties.size());
-  if (!file.read_bytes(r_scratch.data(), r_scratch.size())) {
-    return "Could not read row of binary property";
-  }
-
-  const uint8_t *ptr = r_scratch.data();
+  const uint8_t *ptr = row;
   if (header.type == PlyFormatType::BINARY_LE) {
     /* Little endian: just read/convert the values. */
     for (int i = 0, n = int(element.properties.size()); i != n; i++) {
@@ -220,7 +227,7 @@ static const char *parse_row_binary(PlyReadBuffer &file,
       r_values[i] = val;
     }
   }
-  else if (header.type == PlyFormatType::BINARY_BE) {
+  else {
     /* Big endian: read, switch endian, convert the values. */
     for (int i = 0, n = int(element.properties.size()); i != n; i++) {
       const PlyProperty &prop = element.properties[i];
@@ -229,9 +236,25 @@ static const char *parse_row_binary(PlyReadBuffer &file,
       r_values[i] = val;
     }
   }
-  else {
+}
+
+static const char *parse_row_binary(PlyReadBuffer &file,
+                                    const PlyHeader &header,
+                                    const PlyElement &element,
+                                    Vector<uint8_t> &r_scratch,
+                                    Vector<float> &r_values)
+{
+  if (element.stride == 0) {
+    return "Vertex/Edge element contains list properties, this is not supported";
+  }
+  if (!ELEM(header.type, PlyFormatType::BINARY_LE, PlyFormatType::BINARY_BE)) {
     return "Unknown binary ply format for vertex element";
   }
+  BLI_assert(r_scratch.size() == element.stride);
+  if (!file.read_bytes(r_scratch.data(), r_scratch.size())) {
+    return "Could not read row of binary property";
+  }
+  convert_row_binary(header, element, r_scratch.data(), r_values);
   return nullptr;
 }
 
@@ -273,15 +296,25 @@ static const char *load_vertex_element(PlyReadBuffer &file,
     data->vertex_custom_attr.append(attr);
   }
 
-  data->vertices.reserve(element.count);
+  const bool is_ascii = header.type == PlyFormatType::ASCII;
+  if (!is_ascii) {
+    if (element.stride == 0) {
+      return "Vertex/Edge element contains list properties, this is not supported";
+    }
+    if (!ELEM(header.type, PlyFormatType::BINARY_LE, PlyFormatType::BINARY_BE)) {
+      return "Unknown binary ply format for vertex element";
+    }
+  }
+
+  data->vertices.resize(element.count);
   if (has_color) {
-    data->vertex_colors.reserve(element.count);
+    data->vertex_colors.resize(element.count);
   }
   if (has_normal) {
-    data->vertex_normals.reserve(element.count);
+    data->vertex_normals.resize(element.count);
   }
   if (has_uv) {
-    data->uv_coordinates.reserve(element.count);
+    data->uv_coordinates.resize(element.count);
   }
 
   float4 color_norm = {1, 1, 1, 1};
@@ -294,31 +327,13 @@ static const char *load_vertex_element(PlyReadBuffer &file,
     color_norm.w = data_type_normalizer[element.properties[alpha_index].type];
   }
 
-  Vector<float> value_vec(element.properties.size());
-  Vector<uint8_t> scratch;
-  if (header.type != PlyFormatType::ASCII) {
-    scratch.resize(element.stride);
-  }
-
-  for (int i = 0; i < element.count; i++) {
-
-    const char *error = nullptr;
-    if (header.type == PlyFormatType::ASCII) {
-      error = parse_row_ascii(file, value_vec);
-    }
-    else {
-      error = parse_row_binary(file, header, element, scratch, value_vec);
-    }
-    if (error != nullptr) {
-      return error;
-    }
-
+  auto store_row = [&](const int64_t i, const Span<float> value_vec) {
     /* Vertex coord */
     float3 vertex3;
     vertex3.x = value_vec[vertex_index.x];
     vertex3.y = value_vec[vertex_index.y];
     vertex3.z = value_vec[vertex_index.z];
-    data->vertices.append(vertex3);
+    data->vertices[i] = vertex3;
 
     /* Vertex color */
     if (has_color) {
@@ -332,7 +347,7 @@ static const char *load_vertex_element(PlyReadBuffer &file,
       else {
         colors4.w = 1.0f;
       }
-      data->vertex_colors.append(colors4);
+      data->vertex_colors[i] = colors4;
     }
 
     /* If normals */
@@ -341,7 +356,7 @@ static const char *load_vertex_element(PlyReadBuffer &file,
       normals3.x = value_vec[normal_index.x];
       normals3.y = value_vec[normal_index.y];
       normals3.z = value_vec[normal_index.z];
-      data->vertex_normals.append(normals3);
+      data->vertex_normals[i] = normals3;
     }
 
     /* If uv */
@@ -349,7 +364,7 @@ static const char *load_vertex_element(PlyReadBuffer &file,
       float2 uvmap;
       uvmap.x = value_vec[uv_index.x];
       uvmap.y = value_vec[uv_index.y];
-      data->uv_coordinates.append(uvmap);
+      data->uv_coordinates[i] = uvmap;
     }
 
     /* Custom attributes */
@@ -357,6 +372,52 @@ static const char *load_vertex_element(PlyReadBuffer &file,
       float value = value_vec[custom_attr_indices[ci]];
       data->vertex_custom_attr[ci].data[i] = value;
     }
+  };
+
+  /* Reading from the file happens sequentially, but the rows of a batch are independent, so
+   * parsing and converting them happens in parallel. */
+  Vector<uint8_t> batch_binary;
+  Vector<char> batch_text;
+  Vector<int64_t> batch_line_offsets;
+  for (int64_t batch_start = 0; batch_start < element.count; batch_start += VERTEX_ROWS_PER_BATCH)
+  {
+    const IndexRange batch(batch_start,
+                           std::min<int64_t>(VERTEX_ROWS_PER_BATCH, element.count - batch_start));
+    if (is_ascii) {
+      /* Lines returned by the buffer are only valid until the next read, so copy them. */
+      batch_text.clear();
+      batch_line_offsets.clear();
+      batch_line_offsets.append(0);
+      for (int64_t i = 0; i < batch.size(); i++) {
+        const Span<char> line = file.read_line();
+        if (line.is_empty()) {
+          return "Could not read row of ASCII property";
+        }
+        batch_text.extend(line);
+        batch_line_offsets.append(batch_text.size());
+      }
+    }
+    else {
+      batch_binary.resize(batch.size() * element.stride);
+      if (!file.read_bytes(batch_binary.data(), batch_binary.size())) {
+        return "Could not read row of binary property";
+      }
+    }
+
+    threading::parallel_for(batch.index_range(), 4096, [&](const IndexRange range) {
+      Vector<float> value_vec(element.properties.size());
+      for (const int64_t i : range) {
+        if (is_ascii) {
+          parse_line_ascii(batch_text.as_span().slice(IndexRange::from_begin_end(
+                               batch_line_offsets[i], batch_line_offsets[i + 1])),
+                           value_vec);
+        }
+        else {
+          convert_row_binary(header, element, &batch_binary[i * element.stride], value_vec);
+        }
+        store_row(batch[i], value_vec);
+      }
+    });
   }
   return nullptr;
 }
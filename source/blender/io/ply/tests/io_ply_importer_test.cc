@@ -4,10 +4,18 @@
 
 #include "testing/testing.h"
 
+#include <fstream>
+
+#include "BLI_fileops.hh"
 #include "BLI_path_utils.hh"
+#include "BLI_string.hh"
+#include "BLI_system.hh"
+#include "BLI_tempfile.hh"
 
 #include "CLG_log.h"
 
+#include BLI_SYSTEM_PID_H
+
 #include "ply_import.hh"
 #include "ply_import_buffer.hh"
 #include "ply_import_data.hh"
@@ -20,7 +28,7 @@ namespace io::ply {
 
 /* Extensive tests for PLY importing are in `io_ply_import_test.py`.
  * The tests here are only for testing PLY reader buffer refill behavior,
- * by using a very small buffer size on purpose. */
+ * by using a very small buffer size on purpose, and for the batched vertex conversion. */
 
 TEST(ply_import, BufferRefillTest)
 {
@@ -66,6 +74,163 @@ TEST(ply_import, BufferRefillTest)
   EXPECT_EQ_SPAN<std::pair<int, int>>(Span(exp_edges, 12), data_b->edges);
 }
 
+/* Vertex rows are converted in batches of 64K rows, test files with rows on both sides of the
+ * batch boundaries. */
+class PlyImportBatchTest : public testing::Test {
+ protected:
+  std::string temp_dir_;
+
+  static constexpr int64_t rows_per_batch = 64 * 1024;
+  static constexpr int64_t verts_num = rows_per_batch * 2 + 100;
+
+  void SetUp() override
+  {
+    char temp_dir[FILE_MAX];
+    BLI_temp_directory_path_get(temp_dir, sizeof(temp_dir));
+    temp_dir_ = std::string(temp_dir) + SEP_STR + "blender_ply_import_test_" +
+                std::to_string(getpid());
+    BLI_dir_create_recursive(temp_dir_.c_str());
+  }
+
+  void TearDown() override
+  {
+    BLI_delete(temp_dir_.c_str(), true, true);
+  }
+
+  static float3 expected_position(const int64_t i)
+  {
+    return float3(float(i), float(i % 1000) * 0.25f, -float(i % 7));
+  }
+
+  static uchar3 expected_color(const int64_t i)
+  {
+    return uchar3(uint8_t(i % 256), uint8_t((i / 256) % 256), 7);
+  }
+
+  static float expected_quality(const int64_t i)
+  {
+    return float(i % 4096) * 0.5f;
+  }
+
+  static void write_header(std::ofstream &file, const char *format)
+  {
+    file << "ply\n"
+         << "format " << format << " 1.0\n"
+         << "element vertex " << verts_num << "\n"
+         << "property float x\n"
+         << "property float y\n"
+         << "property float z\n"
+         << "property uchar red\n"
+         << "property uchar green\n"
+         << "property uchar blue\n"
+         << "property float quality\n"
+         << "end_header\n";
+  }
+
+  std::string write_ascii_file() const
+  {
+    const std::string filepath = temp_dir_ + SEP_STR + "batches_ascii.ply";
+    std::ofstream file(filepath, std::ios::binary);
+    write_header(file, "ascii");
+    char line[256];
+    for (const int64_t i : IndexRange(verts_num)) {
+      const float3 pos = expected_position(i);
+      const uchar3 color = expected_color(i);
+      SNPRINTF(line,
+               "%.9g %.9g %.9g %d %d %d %.9g\n",
+               pos.x,
+               pos.y,
+               pos.z,
+               int(color.x),
+               int(color.y),
+               int(color.z),
+               expected_quality(i));
+      file << line;
+    }
+    return filepath;
+  }
+
+  std::string write_binary_file() const
+  {
+    const std::string filepath = temp_dir_ + SEP_STR + "batches_binary.ply";
+    std::ofstream file(filepath, std::ios::binary);
+    write_header(file, "binary_little_endian");
+    for (const int64_t i : IndexRange(verts_num)) {
+      const float3 pos = expected_position(i);
+      const uchar3 color = expected_color(i);
+      const float quality = expected_quality(i);
+      file.write(reinterpret_cast<const char *>(&pos), sizeof(pos));
+      file.write(reinterpret_cast<const char *>(&color), sizeof(color));
+      file.write(reinterpret_cast<const char *>(&quality), sizeof(quality));
+    }
+    return filepath;
+  }
+
+  static void expect_row(const PlyData &data, const int64_t i)
+  {
+    SCOPED_TRACE("row " + std::to_string(i));
+    const float3 pos = expected_position(i);
+    EXPECT_EQ(data.vertices[i].x, pos.x);
+    EXPECT_EQ(data.vertices[i].y, pos.y);
+    EXPECT_EQ(data.vertices[i].z, pos.z);
+    const uchar3 color = expected_color(i);
+    EXPECT_FLOAT_EQ(data.vertex_colors[i].x, color.x / 255.0f);
+    EXPECT_FLOAT_EQ(data.vertex_colors[i].y, color.y / 255.0f);
+    EXPECT_FLOAT_EQ(data.vertex_colors[i].z, color.z / 255.0f);
+    EXPECT_EQ(data.vertex_colors[i].w, 1.0f);
+    EXPECT_EQ(data.vertex_custom_attr[0].data[i], expected_quality(i));
+  }
+
+  static void import_and_check(const std::string &filepath)
+  {
+    PlyReadBuffer file(filepath.c_str());
+    PlyHeader header;
+    ASSERT_EQ(read_header(file, header), nullptr);
+    std::unique_ptr<PlyData> data = import_ply_data(file, header);
+    ASSERT_TRUE(data->error.empty()) << data->error;
+
+    ASSERT_EQ(data->vertices.size(), verts_num);
+    ASSERT_EQ(data->vertex_colors.size(), verts_num);
+    ASSERT_EQ(data->vertex_custom_attr.size(), 1);
+    EXPECT_EQ(data->vertex_custom_attr[0].name, "quality");
+    EXPECT_TRUE(data->vertex_normals.is_empty());
+    EXPECT_TRUE(data->uv_coordinates.is_empty());
+
+    const int64_t rows[] = {0,
+                            1,
+                            rows_per_batch - 1,
+                            rows_per_batch,
+                            rows_per_batch + 1,
+                            rows_per_batch * 2 - 1,
+                            rows_per_batch * 2,
+                            verts_num - 1};
+    for (const int64_t i : rows) {
+      expect_row(*data, i);
+    }
+
+    /* Every row ends up at its own index. */
+    int64_t mismatches_num = 0;
+    for (const int64_t i : IndexRange(verts_num)) {
+      if (data->vertices[i] != expected_position(i) ||
+          data->vertex_custom_attr[0].data[i] != expected_quality(i))
+      {
+        mismatches_num++;
+      }
+    }
+    EXPECT_EQ(mismatches_num, 0);
+  }
+};
+
+TEST_F(PlyImportBatchTest, ASCIIVertexBatches)
+{
+  import_and_check(write_ascii_file());
+}
+
+TEST_F(PlyImportBatchTest, BinaryVertexBatches)
+{
+  import_and_check(write_binary_file());
+}
+
 //@TODO: now we put vertex color attribute first, maybe put position first?
 //@TODO: test with vertex element having list properties
 //@TODO: test with edges starting with non-vertex index properties
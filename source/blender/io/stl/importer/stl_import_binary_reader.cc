@@ -12,6 +12,7 @@
 #include "BKE_mesh.hh"
 
 #include "BLI_array.hh"
+#include "BLI_task.hh"
 
 #include "DNA_mesh_types.h"
 
@@ -30,7 +31,7 @@ static CLG_LogRef LOG = {"io.stl"};
 
 Mesh *read_stl_binary(FILE *file, const bool use_custom_normals)
 {
-  const int chunk_size = 1024;
+  const int chunk_size = 64 * 1024;
   uint32_t num_tris = 0;
   fseek(file, BINARY_HEADER_SIZE, SEEK_SET);
   if (fread(&num_tris, sizeof(uint32_t), 1, file) != 1) {
@@ -47,16 +48,37 @@ Mesh *read_stl_binary(FILE *file, const bool use_custom_normals)
     return nullptr;
   }
 
+  /* Unpack the triangles of each chunk in parallel, merging is done for all of them at once. */
   Array<PackedTriangle> tris_buf(chunk_size);
-  STLMeshHelper stl_mesh(num_tris, use_custom_normals);
+  Array<float3> corner_positions(int64_t(num_tris) * 3);
+  Array<float3> tri_normals(use_custom_normals ? num_tris : 0);
+  int64_t tris_read = 0;
   size_t num_read_tris;
-  while ((num_read_tris = fread(tris_buf.data(), sizeof(PackedTriangle), chunk_size, file))) {
-    for (size_t i = 0; i < num_read_tris; i++) {
-      stl_mesh.add_triangle(tris_buf[i]);
-    }
+  while (tris_read < num_tris &&
+         (num_read_tris = fread(tris_buf.data(),
+                                sizeof(PackedTriangle),
+                                std::min<int64_t>(chunk_size, num_tris - tris_read),
+                                file)))
+  {
+    threading::parallel_for(IndexRange(num_read_tris), 4096, [&](const IndexRange range) {
+      for (const int64_t i : range) {
+        const PackedTriangle &tri = tris_buf[i];
+        const int64_t dst_tri = tris_read + i;
+        corner_positions[dst_tri * 3 + 0] = tri.vertices[0];
+        corner_positions[dst_tri * 3 + 1] = tri.vertices[1];
+        corner_positions[dst_tri * 3 + 2] = tri.vertices[2];
+        if (use_custom_normals) {
+          tri_normals[dst_tri] = tri.normal;
+        }
+      }
+    });
+    tris_read += num_read_tris;
   }
 
-  return stl_mesh.to_mesh();
+  return stl_triangles_to_mesh(corner_positions.as_span().take_front(tris_read * 3),
+                               tri_normals.as_span().take_front(std::min(tri_normals.size(),
+                                                                         tris_read)),
+                               use_custom_normals);
 }
 
 }  // namespace blender::io::stl
@@ -8,8 +8,12 @@
 
 #include "BKE_mesh.hh"
 
+#include "BLI_array.hh"
 #include "BLI_array_utils.hh"
+#include "BLI_index_mask.hh"
+#include "BLI_map.hh"
 #include "BLI_span.hh"
+#include "BLI_task.hh"
 
 #include "DNA_mesh_types.h"
 
@@ -57,31 +61,183 @@ bool STLMeshHelper::add_triangle(const PackedTriangle &data)
   return true;
 }
 
-Mesh *STLMeshHelper::to_mesh()
+static Mesh *finish_mesh(Mesh *mesh,
+                         const int degenerate_tris_num,
+                         const int duplicate_tris_num,
+                         MutableSpan<float3> loop_normals,
+                         const bool use_custom_normals)
 {
-  if (degenerate_tris_num_ > 0) {
-    CLOG_WARN(&LOG, "Removed %d degenerate triangles during import", degenerate_tris_num_);
+  if (degenerate_tris_num > 0) {
+    CLOG_WARN(&LOG, "Removed %d degenerate triangles during import", degenerate_tris_num);
   }
-  if (duplicate_tris_num_ > 0) {
-    CLOG_WARN(&LOG, "Removed %d duplicate triangles during import", duplicate_tris_num_);
+  if (duplicate_tris_num > 0) {
+    CLOG_WARN(&LOG, "Removed %d duplicate triangles during import", duplicate_tris_num);
   }
 
-  Mesh *mesh = BKE_mesh_new_nomain(verts_.size(), 0, tris_.size(), tris_.size() * 3);
-  mesh->vert_positions_for_write().copy_from(verts_);
-  offset_indices::fill_constant_group_size(3, 0, mesh->face_offsets_for_write());
-  array_utils::copy(tris_.as_span().cast<int>(), mesh->corner_verts_for_write());
-
   bke::mesh_smooth_set(*mesh, false);
 
   /* NOTE: edges must be calculated first before setting custom normals. */
   bke::mesh_calc_edges(*mesh, false, false);
 
-  if (use_custom_normals_ && loop_normals_.size() == mesh->corners_num) {
-    bke::mesh_set_custom_normals(*mesh, loop_normals_);
+  if (use_custom_normals && loop_normals.size() == mesh->corners_num) {
+    bke::mesh_set_custom_normals(*mesh, loop_normals);
   }
 
   return mesh;
 }
 
+Mesh *STLMeshHelper::to_mesh()
+{
+  Mesh *mesh = BKE_mesh_new_nomain(verts_.size(), 0, tris_.size(), tris_.size() * 3);
+  mesh->vert_positions_for_write().copy_from(verts_);
+  offset_indices::fill_constant_group_size(3, 0, mesh->face_offsets_for_write());
+  array_utils::copy(tris_.as_span().cast<int>(), mesh->corner_verts_for_write());
+
+  return finish_mesh(
+      mesh, degenerate_tris_num_, duplicate_tris_num_, loop_normals_, use_custom_normals_);
+}
+
+/**
+ * For every index in the mask, find the first index in the mask whose element is equal, which is
+ * what adding the elements to a #VectorSet in order would give. The elements are distributed to
+ * shards by hash first, so that the shards can be deduplicated independently in parallel.
+ */
+template<typename T, typename GetElementFn>
+static void find_first_occurrences(const IndexMask &mask,
+                                   const GetElementFn &get_element,
+                                   MutableSpan<int> r_first)
+{
+  constexpr int shard_bits = 8;
+  constexpr int shards_num = 1 << shard_bits;
+  constexpr int64_t block_size = 64 * 1024;
+  const int64_t blocks_num = divide_ceil_ul(mask.size(), block_size);
+  auto block_range = [&](const int64_t block) {
+    return IndexRange::from_begin_end(block * block_size,
+                                      std::min((block + 1) * block_size, mask.size()));
+  };
+
+  /* Use the high bits of the mixed hash for the shard, the hash table of each shard uses the low
+   * bits. */
+  Array<uint8_t> shard_of_pos(mask.size());
+  Array<int64_t> block_shard_offsets(blocks_num * shards_num, 0);
+  threading::parallel_for(IndexRange(blocks_num), 1, [&](const IndexRange blocks) {
+    for (const int64_t block : blocks) {
+      MutableSpan<int64_t> counts = block_shard_offsets.as_mutable_span().slice(
+          block * shards_num, shards_num);
+      for (const int64_t pos : block_range(block)) {
+        const uint64_t hash = DefaultHash<T>{}(get_element(mask[pos]));
+        const uint8_t shard = uint8_t((hash * 0x9E3779B97F4A7C15ull) >> (64 - shard_bits));
+        shard_of_pos[pos] = shard;
+        counts[shard]++;
+      }
+    }
+  });
+
+  /* Counting sort: the indices of each shard are stored contiguously and in ascending order. */
+  Array<int64_t> shard_offsets(shards_num + 1);
+  int64_t offset = 0;
+  for (const int shard : IndexRange(shards_num)) {
+    shard_offsets[shard] = offset;
+    for (const int64_t block : IndexRange(blocks_num)) {
+      const int64_t count = block_shard_offsets[block * shards_num + shard];
+      block_shard_offsets[block * shards_num + shard] = offset;
+      offset += count;
+    }
+  }
+  shard_offsets[shards_num] = offset;
+
+  Array<int> sorted_indices(mask.size());
+  threading::parallel_for(IndexRange(blocks_num), 1, [&](const IndexRange blocks) {
+    for (const int64_t block : blocks) {
+      MutableSpan<int64_t> offsets = block_shard_offsets.as_mutable_span().slice(
+          block * shards_num, shards_num);
+      for (const int64_t pos : block_range(block)) {
+        sorted_indices[offsets[shard_of_pos[pos]]++] = int(mask[pos]);
+      }
+    }
+  });
+
+  threading::parallel_for(IndexRange(shards_num), 1, [&](const IndexRange shards) {
+    for (const int shard : shards) {
+      const Span<int> indices = sorted_indices.as_span().slice(
+          IndexRange::from_begin_end(shard_offsets[shard], shard_offsets[shard + 1]));
+      Map<T, int> first_by_element;
+      first_by_element.reserve(indices.size());
+      for (const int i : indices) {
+        r_first[i] = first_by_element.lookup_or_add(get_element(i), i);
+      }
+    }
+  });
+}
+
+Mesh *stl_triangles_to_mesh(const Span<float3> corner_positions,
+                            const Span<float3> tri_normals,
+                            const bool use_custom_normals)
+{
+  const int tris_num = int(corner_positions.size() / 3);
+  IndexMaskMemory memory;
+
+  /* Merge vertices at the same position, numbering them in order of first occurrence. */
+  Array<int> corner_first(corner_positions.size());
+  find_first_occurrences<float3>(
+      corner_positions.index_range(),
+      [&](const int corner) { return corner_positions[corner]; },
+      corner_first);
+  const IndexMask first_corners = IndexMask::from_predicate(
+      corner_positions.index_range(), memory, [&](const int64_t corner) {
+        return corner_first[corner] == corner;
+      });
+  Array<int> corner_verts(corner_positions.size());
+  Array<float3> positions(first_corners.size());
+  first_corners.foreach_index(
+      [&](const int64_t corner, const int64_t vert) {
+        positions[vert] = corner_positions[corner];
+        corner_verts[corner] = int(vert);
+      },
+      exec_mode::grain_size(4096));
+  threading::parallel_for(corner_verts.index_range(), 4096, [&](const IndexRange range) {
+    for (const int64_t corner : range) {
+      if (corner_first[corner] != corner) {
+        corner_verts[corner] = corner_verts[corner_first[corner]];
+      }
+    }
+  });
+  corner_first = {};
+
+  /* Remove degenerate triangles, and triangles using the same vertices as a previous one. */
+  const Span<Triangle> tris = corner_verts.as_span().cast<Triangle>();
+  const IndexMask valid_tris = IndexMask::from_predicate(
+      IndexRange(tris_num), memory, [&](const int64_t tri) {
+        const Triangle &t = tris[tri];
+        return t.v1 != t.v2 && t.v1 != t.v3 && t.v2 != t.v3;
+      });
+  Array<int> tri_first(tris_num);
+  find_first_occurrences<Triangle>(
+      valid_tris, [&](const int tri) { return tris[tri]; }, tri_first);
+  const IndexMask unique_tris = IndexMask::from_predicate(
+      valid_tris, memory, [&](const int64_t tri) { return tri_first[tri] == tri; });
+
+  Mesh *mesh = BKE_mesh_new_nomain(
+      positions.size(), 0, unique_tris.size(), unique_tris.size() * 3);
+  mesh->vert_positions_for_write().copy_from(positions);
+  offset_indices::fill_constant_group_size(3, 0, mesh->face_offsets_for_write());
+  MutableSpan<Triangle> mesh_tris = mesh->corner_verts_for_write().cast<Triangle>();
+  Array<float3> loop_normals(use_custom_normals ? mesh->corners_num : 0);
+  unique_tris.foreach_index(
+      [&](const int64_t tri, const int64_t face) {
+        mesh_tris[face] = tris[tri];
+        if (use_custom_normals) {
+          loop_normals.as_mutable_span().slice(face * 3, 3).fill(tri_normals[tri]);
+        }
+      },
+      exec_mode::grain_size(4096));
+
+  return finish_mesh(mesh,
+                     tris_num - int(valid_tris.size()),
+                     int(valid_tris.size() - unique_tris.size()),
+                     loop_normals,
+                     use_custom_normals);
+}
+
 }  // namespace io::stl
 }  // namespace blender
@@ -11,6 +11,7 @@
 #include <cstdint>
 
 #include "BLI_math_vector_types.hh"
+#include "BLI_span.hh"
 #include "BLI_vector.hh"
 #include "BLI_vector_set.hh"
 #include "stl_data.hh"
@@ -69,5 +70,16 @@ class STLMeshHelper {
   Mesh *to_mesh();
 };
 
+/**
+ * Create a mesh from all triangles at once, with the same result as adding them to a
+ * #STLMeshHelper in order. Duplicate vertices and triangles are merged in parallel.
+ *
+ * \param corner_positions: The positions of the three corners of each triangle.
+ * \param tri_normals: The facet normal of each triangle, only used with custom normals.
+ */
+Mesh *stl_triangles_to_mesh(Span<float3> corner_positions,
+                            Span<float3> tri_normals,
+                            bool use_custom_normals);
+
 }  // namespace io::stl
 }  // namespace blender
@@ -0,0 +1,120 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "BKE_gtest_base.hh"
+#include "BKE_lib_id.hh"
+#include "BKE_mesh.hh"
+
+#include "BLI_rand.hh"
+
+#include "DNA_mesh_types.h"
+
+#include "testing/testing.h"
+
+#include "stl_data.hh"
+#include "stl_import_mesh.hh"
+
+namespace blender::io::stl {
+
+class STLImportMeshTest : public bke::BlenderGTestBase {};
+
+/**
+ * Triangles of a grid, in random order and with random corner order. Some triangles are added
+ * again with rotated or flipped corners and some are degenerate, to test the merging.
+ */
+static Vector<PackedTriangle> create_triangle_soup(const int size)
+{
+  RandomNumberGenerator rng(42);
+  auto grid_position = [&](const int x, const int y) {
+    return float3(x * 0.5f, y * 0.25f, float((x * 7 + y * 3) % 5));
+  };
+
+  Vector<PackedTriangle> tris;
+  for (const int y : IndexRange(size)) {
+    for (const int x : IndexRange(size)) {
+      const float3 p00 = grid_position(x, y);
+      const float3 p10 = grid_position(x + 1, y);
+      const float3 p01 = grid_position(x, y + 1);
+      const float3 p11 = grid_position(x + 1, y + 1);
+      tris.append({float3(0, 0, 1), {p00, p10, p11}, 0});
+      tris.append({float3(0, 1, 0), {p00, p11, p01}, 0});
+    }
+  }
+
+  const int64_t unique_num = tris.size();
+  for (const int64_t i : IndexRange(unique_num / 8)) {
+    PackedTriangle tri = tris[rng.get_int32(int(unique_num))];
+    if (i % 2 == 0) {
+      std::swap(tri.vertices[0], tri.vertices[1]);
+    }
+    else {
+      std::rotate(tri.vertices, tri.vertices + 1, tri.vertices + 3);
+    }
+    tri.normal = float3(1, 0, 0);
+    tris.append(tri);
+  }
+  for (const int64_t i : IndexRange(unique_num / 16)) {
+    PackedTriangle tri = tris[rng.get_int32(int(unique_num))];
+    tri.vertices[i % 3] = tri.vertices[(i + 1) % 3];
+    tris.append(tri);
+  }
+
+  rng.shuffle<PackedTriangle>(tris);
+  for (PackedTriangle &tri : tris) {
+    std::rotate(tri.vertices, tri.vertices + rng.get_int32(3), tri.vertices + 3);
+  }
+  return tris;
+}
+
+/** Merge the triangles in parallel and with #STLMeshHelper, which adds them one by one. */
+static void test_merge_triangles(const Span<PackedTriangle> tris, const bool use_custom_normals)
+{
+  STLMeshHelper helper(int(tris.size()), use_custom_normals);
+  Array<float3> corner_positions(tris.size() * 3);
+  Array<float3> tri_normals(tris.size());
+  for (const int64_t i : tris.index_range()) {
+    helper.add_triangle(tris[i]);
+    corner_positions[i * 3 + 0] = tris[i].vertices[0];
+    corner_positions[i * 3 + 1] = tris[i].vertices[1];
+    corner_positions[i * 3 + 2] = tris[i].vertices[2];
+    tri_normals[i] = tris[i].normal;
+  }
+
+  Mesh *expect = helper.to_mesh();
+  Mesh *result = stl_triangles_to_mesh(corner_positions, tri_normals, use_custom_normals);
+
+  EXPECT_EQ_SPAN<float3>(expect->vert_positions(), result->vert_positions());
+  EXPECT_EQ_SPAN<int>(expect->face_offsets(), result->face_offsets());
+  EXPECT_EQ_SPAN<int>(expect->corner_verts(), result->corner_verts());
+  EXPECT_EQ_SPAN<int>(expect->corner_edges(), result->corner_edges());
+  EXPECT_EQ_SPAN<int2>(expect->edges(), result->edges());
+  if (use_custom_normals) {
+    EXPECT_EQ_SPAN<float3>(expect->corner_normals(), result->corner_normals());
+  }
+
+  BKE_id_free(nullptr, expect);
+  BKE_id_free(nullptr, result);
+}
+
+TEST_F(STLImportMeshTest, merge_triangles_small)
+{
+  const Vector<PackedTriangle> tris = create_triangle_soup(8);
+  test_merge_triangles(tris, false);
+  test_merge_triangles(tris, true);
+}
+
+TEST_F(STLImportMeshTest, merge_triangles_large)
+{
+  /* Enough corners for multiple blocks when distributing them to shards. */
+  const Vector<PackedTriangle> tris = create_triangle_soup(200);
+  test_merge_triangles(tris, false);
+  test_merge_triangles(tris, true);
+}
+
+TEST_F(STLImportMeshTest, merge_triangles_empty)
+{
+  test_merge_triangles({}, false);
+}
+
+}  // namespace blender::io::stl
@@ -232,11 +232,9 @@ void OBJWriter::write_object_name(FormatHandler &fh, const OBJMesh &obj_mesh_dat
   fh.write_obj_object(object_name);
 }
 
-/* Split up large meshes into multi-threaded jobs; each job processes
- * this amount of items. */
-static const int chunk_size = 32768;
 static int calc_chunk_count(int count)
 {
+  const int chunk_size = format_batch_sizes().chunk_size;
   return (count + chunk_size - 1) / chunk_size;
 }
 
@@ -245,6 +243,10 @@ static int calc_chunk_count(int count)
  * If the amount of items is large enough (> chunk_size), then writing
  * will be done in parallel, into temporary FormatHandler buffers that
  * will be written into the final /fh/ buffer at the end.
+ *
+ * If /fh/ has a stream file, the chunks are formatted in batches instead,
+ * and each batch is written to the file while the next one is formatted,
+ * so that memory usage does not depend on the size of the mesh.
  */
 template<typename Function>
 void obj_parallel_chunked_output(FormatHandler &fh, int tot_count, const Function &function)
@@ -255,6 +257,8 @@ void obj_parallel_chunked_output(FormatHandler &fh, int tot_count, const Functio
   /* If we have just one chunk, process it directly into the output
    * buffer - avoids all the job scheduling and temporary vector allocation
    * overhead. */
+  const int chunk_size = format_batch_sizes().chunk_size;
+  const int stream_batch_chunks = format_batch_sizes().stream_batch_chunks;
   const int chunk_count = calc_chunk_count(tot_count);
   if (chunk_count == 1) {
     for (int i = 0; i < tot_count; i++) {
@@ -262,21 +266,57 @@ void obj_parallel_chunked_output(FormatHandler &fh, int tot_count, const Functio
     }
     return;
   }
-  /* Give each chunk its own temporary output buffer, and process them in parallel. */
-  Array<FormatHandler> buffers(chunk_count);
-  threading::parallel_for(IndexRange(chunk_count), 1, [&](IndexRange range) {
-    for (const int r : range) {
-      int i_start = r * chunk_size;
-      int i_end = std::min(i_start + chunk_size, tot_count);
-      auto &buf = buffers[r];
-      for (int i = i_start; i < i_end; i++) {
-        function(buf, i);
+  auto format_chunks = [&](const IndexRange chunks, MutableSpan<FormatHandler> buffers) {
+    threading::parallel_for(chunks, 1, [&](IndexRange range) {
+      for (const int r : range) {
+        int i_start = r * chunk_size;
+        int i_end = std::min(i_start + chunk_size, tot_count);
+        auto &buf = buffers[r - chunks.start()];
+        for (int i = i_start; i < i_end; i++) {
+          function(buf, i);
+        }
       }
+    });
+  };
+
+  FILE *stream_file = fh.get_stream_file();
+  if (stream_file == nullptr) {
+    /* Give each chunk its own temporary output buffer, and process them in parallel. */
+    Array<FormatHandler> buffers(chunk_count);
+    format_chunks(IndexRange(chunk_count), buffers);
+    /* Emit all temporary output buffers into the destination buffer. */
+    for (auto &buf : buffers) {
+      fh.append_from(buf);
     }
-  });
-  /* Emit all temporary output buffers into the destination buffer. */
-  for (auto &buf : buffers) {
-    fh.append_from(buf);
+    return;
+  }
+
+  /* Everything written so far has to come before the chunks in the file. */
+  fh.write_to_file(stream_file);
+  /* Two sets of buffers: one is written to the file while the other one is being formatted. */
+  Array<FormatHandler> buffers(stream_batch_chunks * 2);
+  const int batch_count = (chunk_count + stream_batch_chunks - 1) / stream_batch_chunks;
+  auto batch_buffers = [&](const int batch) {
+    return buffers.as_mutable_span().slice((batch % 2) * stream_batch_chunks,
+                                           stream_batch_chunks);
+  };
+  for (int batch = 0; batch <= batch_count; batch++) {
+    threading::parallel_invoke(
+        [&]() {
+          if (batch > 0) {
+            for (FormatHandler &buf : batch_buffers(batch - 1)) {
+              buf.write_to_file(stream_file);
+            }
+          }
+        },
+        [&]() {
+          if (batch < batch_count) {
+            const int chunks_start = batch * stream_batch_chunks;
+            const int chunks_end = std::min(chunks_start + stream_batch_chunks, chunk_count);
+            format_chunks(IndexRange::from_begin_end(chunks_start, chunks_end),
+                          batch_buffers(batch));
+          }
+        });
   }
 }
 
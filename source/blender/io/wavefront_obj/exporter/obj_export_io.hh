@@ -18,22 +18,58 @@
 
 namespace blender::io::obj {
 
+/**
+ * Amounts of elements the exporter formats at once. Only tests change them, to cover
+ * writing in parallel chunks and batches with small scenes.
+ */
+struct FormatBatchSizes {
+  /** Split up large meshes into multi-threaded jobs; each job processes this amount of items. */
+  int chunk_size = 32768;
+  /** When streaming to a file, only this amount of chunks is formatted at once. */
+  int stream_batch_chunks = 16;
+  /**
+   * Objects are formatted in batches of at most this amount of elements (vertices, faces,
+   * UVs and normals), so that the text of the whole scene is never held in memory at once.
+   */
+  int64_t object_batch_max_elements = 1024 * 1024;
+};
+
+inline FormatBatchSizes &format_batch_sizes()
+{
+  static FormatBatchSizes sizes;
+  return sizes;
+}
+
 /**
  * File buffer writer.
  * All writes are done into an internal chunked memory buffer
  * (list of default 64 kilobyte blocks).
  * Call write_fo_file once in a while to write the memory buffer(s)
  * into the given file.
+ *
+ * A handler can also be given a stream file, which means that everything before the
+ * current write position may be written to that file at any time. Writers producing
+ * a lot of output use it to flush their buffers early and keep memory usage bounded.
  */
 class FormatHandler : NonCopyable, NonMovable {
  private:
   using VectorChar = Vector<char>;
   Vector<VectorChar> blocks_;
   size_t buffer_chunk_size_;
+  FILE *stream_file_ = nullptr;
 
  public:
   FormatHandler(size_t buffer_chunk_size = 64 * 1024) : buffer_chunk_size_(buffer_chunk_size) {}
 
+  void set_stream_file(FILE *f)
+  {
+    stream_file_ = f;
+  }
+  FILE *get_stream_file() const
+  {
+    return stream_file_;
+  }
+
   /* Write contents to the buffer(s) into a file, and clear the buffers. */
   void write_to_file(FILE *f)
   {
@@ -166,11 +166,10 @@ static void write_mesh_objects(const Span<std::unique_ptr<OBJMesh>> exportable_a
                                MTLWriter *mtl_writer,
                                const OBJExportParams &export_params)
 {
-  /* Parallelization is over meshes/objects, which means
-   * we have to have the output text buffer for each object,
-   * and write them all into the file at the end. */
+  /* Parallelization is over meshes/objects within a batch and over chunks of elements
+   * within a mesh, which means we have to have the output text buffer for each object
+   * of a batch, and write them into the file after the batch is formatted. */
   size_t count = exportable_as_mesh.size();
-  Array<FormatHandler> buffers(count);
 
   /* Serial: gather material indices, ensure normals & edges. */
   Vector<Vector<int>> mtlindices;
@@ -201,63 +200,103 @@ static void write_mesh_objects(const Span<std::unique_ptr<OBJMesh>> exportable_a
   });
 
   /* Serial: calculate index offsets; these are sequentially added
-   * over all meshes, and requite normal/uv indices to be calculated. */
+   * over all meshes, and requite normal/uv indices to be calculated.
+   * Objects are grouped into batches at the same time. */
   Vector<IndexOffsets> index_offsets;
   index_offsets.reserve(count);
   IndexOffsets offsets{0, 0, 0};
-  for (const auto &obj_mesh : exportable_as_mesh) {
-    OBJMesh &obj = *obj_mesh;
+  const int64_t object_batch_max_elements = format_batch_sizes().object_batch_max_elements;
+  Vector<IndexRange> batches;
+  int64_t batch_elements = 0;
+  for (const int i : exportable_as_mesh.index_range()) {
+    OBJMesh &obj = *exportable_as_mesh[i];
     index_offsets.append(offsets);
     offsets.vertex_offset += obj.tot_vertices();
     offsets.uv_vertex_offset += obj.tot_uv_vertices();
     offsets.normal_offset += obj.get_normal_coords().size();
+
+    const int64_t elements = int64_t(obj.tot_vertices()) + obj.tot_faces() +
+                             obj.tot_uv_vertices() + obj.get_normal_coords().size();
+    if (batches.is_empty() || batch_elements + elements > object_batch_max_elements) {
+      batches.append(IndexRange(i, 1));
+      batch_elements = elements;
+    }
+    else {
+      batches.last() = IndexRange(batches.last().start(), batches.last().size() + 1);
+      batch_elements += elements;
+    }
   }
 
-  /* Parallel over meshes: main result writing. */
-  threading::parallel_for(IndexRange(count), 1, [&](IndexRange range) {
-    for (const int i : range) {
-      OBJMesh &obj = *exportable_as_mesh[i];
-      auto &fh = buffers[i];
+  /* Main result writing of a single object. */
+  auto write_mesh_object = [&](const int i, FormatHandler &fh) {
+    OBJMesh &obj = *exportable_as_mesh[i];
 
-      obj_writer.write_object_name(fh, obj);
-      obj_writer.write_vertex_coords(fh, obj, export_params.export_colors);
+    obj_writer.write_object_name(fh, obj);
+    obj_writer.write_vertex_coords(fh, obj, export_params.export_colors);
 
-      if (obj.tot_faces() > 0) {
-        if (export_params.export_smooth_groups) {
-          obj.calc_smooth_groups(export_params.smooth_groups_bitflags);
-        }
-        if (export_params.export_materials) {
-          obj.calc_face_order();
-        }
-        if (export_params.export_normals) {
-          obj_writer.write_normals(fh, obj);
-        }
-        if (export_params.export_uv) {
-          obj_writer.write_uv_coords(fh, obj);
-        }
-        /* This function takes a 0-indexed slot index for the obj_mesh object and
-         * returns the material name that we are using in the `.obj` file for it. */
-        const auto *obj_mtlindices = mtlindices.is_empty() ? nullptr : &mtlindices[i];
-        auto matname_fn = [&](int s) -> const char * {
-          if (!obj_mtlindices || s < 0 || s >= obj_mtlindices->size()) {
-            return nullptr;
-          }
-          return mtl_writer->mtlmaterial_name((*obj_mtlindices)[s]);
-        };
-        obj_writer.write_face_elements(fh, index_offsets[i], obj, matname_fn);
+    if (obj.tot_faces() > 0) {
+      if (export_params.export_smooth_groups) {
+        obj.calc_smooth_groups(export_params.smooth_groups_bitflags);
       }
-      obj_writer.write_edges_indices(fh, index_offsets[i], obj);
-
-      /* Nothing will need this object's data after this point, release
-       * various arrays here. */
-      obj.clear();
+      if (export_params.export_materials) {
+        obj.calc_face_order();
+      }
+      if (export_params.export_normals) {
+        obj_writer.write_normals(fh, obj);
+      }
+      if (export_params.export_uv) {
+        obj_writer.write_uv_coords(fh, obj);
+      }
+      /* This function takes a 0-indexed slot index for the obj_mesh object and
+       * returns the material name that we are using in the `.obj` file for it. */
+      const auto *obj_mtlindices = mtlindices.is_empty() ? nullptr : &mtlindices[i];
+      auto matname_fn = [&](int s) -> const char * {
+        if (!obj_mtlindices || s < 0 || s >= obj_mtlindices->size()) {
+          return nullptr;
+        }
+        return mtl_writer->mtlmaterial_name((*obj_mtlindices)[s]);
+      };
+      obj_writer.write_face_elements(fh, index_offsets[i], obj, matname_fn);
     }
-  });
+    obj_writer.write_edges_indices(fh, index_offsets[i], obj);
 
-  /* Write all the object text buffers into the output file. */
+    /* Nothing will need this object's data after this point, release
+     * various arrays here. */
+    obj.clear();
+  };
+
+  /* Format the batches one after another, writing the previous batch into the
+   * output file while the next one is being formatted. */
   FILE *f = obj_writer.get_outfile();
-  for (auto &b : buffers) {
-    b.write_to_file(f);
+  FormatHandler batch_buffers[2];
+  for (const int batch_i : batches.index_range()) {
+    const IndexRange batch = batches[batch_i];
+    FormatHandler &prev_fh = batch_buffers[(batch_i + 1) % 2];
+    FormatHandler &batch_fh = batch_buffers[batch_i % 2];
+    if (batch.size() == 1) {
+      /* A single (possibly very large) object: stream its elements directly into the file,
+       * the chunked writers take care of formatting them in parallel. */
+      prev_fh.write_to_file(f);
+      batch_fh.set_stream_file(f);
+      write_mesh_object(batch.first(), batch_fh);
+      batch_fh.set_stream_file(nullptr);
+      continue;
+    }
+    auto format_batch = [&]() {
+      Array<FormatHandler> buffers(batch.size());
+      threading::parallel_for(batch.index_range(), 1, [&](IndexRange range) {
+        for (const int i : range) {
+          write_mesh_object(batch[i], buffers[i]);
+        }
+      });
+      for (FormatHandler &buf : buffers) {
+        batch_fh.append_from(buf);
+      }
+    };
+    threading::parallel_invoke([&]() { prev_fh.write_to_file(f); }, format_batch);
+  }
+  if (!batches.is_empty()) {
+    batch_buffers[(batches.size() - 1) % 2].write_to_file(f);
   }
 }
 
@@ -16,6 +16,7 @@
 #include "BLI_mmap.hh"
 #include "BLI_string.hh"
 #include "BLI_string_ref.hh"
+#include "BLI_task.hh"
 #include "BLI_vector.hh"
 
 #include "IO_string_utils.hh"
@@ -44,6 +45,55 @@ namespace io::obj {
 
 using std::string;
 
+/**
+ * Number of chunks that are parsed at once. The elements of a batch are added to the geometry
+ * while the next batch is parsed, which bounds the memory used by the intermediate data.
+ */
+static constexpr int64_t OBJ_CHUNKS_PER_BATCH = 32;
+
+/** A face corner as written in the file, before the indices are resolved. */
+struct OBJRawFaceCorner {
+  FaceCorner corner;
+  bool got_uv = false;
+  bool got_normal = false;
+};
+
+/**
+ * Elements of a chunk of the file that can be parsed without knowing the parser state, i.e.
+ * vertex data and face corners. They are consumed in file order by #OBJParser::add_chunk.
+ */
+struct OBJChunk {
+  StringRef buffer;
+
+  Vector<float3> vertices;
+  /** Values of the `xyzrgb` extension, with the index of their vertex in #vertices. */
+  Vector<std::pair<int64_t, float3>> vertex_extensions;
+  Vector<float2> uv_vertices;
+  Vector<float3> vert_normals;
+  Vector<OBJRawFaceCorner> face_corners;
+  /** Number of corners in #face_corners for each face line. */
+  Vector<int> face_corners_num;
+
+  /* Number of elements of each kind consumed so far. */
+  int64_t next_vertex = 0;
+  int64_t next_vertex_extension = 0;
+  int64_t next_uv_vertex = 0;
+  int64_t next_vert_normal = 0;
+  int64_t next_face_corner = 0;
+  int64_t next_face = 0;
+};
+
+/** State of the parser that carries over from one line to the next. */
+struct OBJParseState {
+  Geometry *curr_geom = nullptr;
+  /* Once set, these remain the same for the remaining elements in the object. */
+  bool shaded_smooth = false;
+  string group_name;
+  int group_index = -1;
+  string material_name;
+  int material_index = -1;
+};
+
 /**
  * Based on the properties of the given Geometry instance, create a new Geometry instance
  * or return the previous one.
@@ -83,18 +133,32 @@ static Geometry *create_geometry(Geometry *const prev_geometry,
   return new_geometry();
 }
 
-static void geom_add_vertex(const char *p, const char *end, GlobalVertices &r_global_vertices)
+static void parse_vertex(const char *p, const char *end, OBJChunk &r_chunk)
 {
-  r_global_vertices.flush_mrgb_block();
   float3 vert;
   p = parse_floats(p, end, 0.0f, vert, 3);
-  r_global_vertices.vertices.append(vert);
+  r_chunk.vertices.append(vert);
   /* OBJ extension: `xyzrgb` vertex colors, when the vertex position
    * is followed by 3 more RGB color components. See
    * http://paulbourke.net/dataformats/obj/colour.html */
   if (p < end) {
     float3 srgb;
     p = parse_floats(p, end, -1.0f, srgb, 3);
+    r_chunk.vertex_extensions.append({r_chunk.vertices.size() - 1, srgb});
+  }
+  UNUSED_VARS(p);
+}
+
+static void geom_add_vertex(OBJChunk &chunk, GlobalVertices &r_global_vertices)
+{
+  r_global_vertices.flush_mrgb_block();
+  const int64_t chunk_index = chunk.next_vertex++;
+  r_global_vertices.vertices.append(chunk.vertices[chunk_index]);
+
+  if (chunk.next_vertex_extension < chunk.vertex_extensions.size() &&
+      chunk.vertex_extensions[chunk.next_vertex_extension].first == chunk_index)
+  {
+    const float3 srgb = chunk.vertex_extensions[chunk.next_vertex_extension++].second;
     if (srgb.x >= 0 && srgb.y >= 0 && srgb.z >= 0) {
       float3 linear;
       srgb_to_linearrgb_v3_v3(linear, srgb);
@@ -105,7 +169,6 @@ static void geom_add_vertex(const char *p, const char *end, GlobalVertices &r_gl
       r_global_vertices.set_vertex_weight(r_global_vertices.vertices.size() - 1, srgb.x);
     }
   }
-  UNUSED_VARS(p);
 }
 
 static void geom_add_mrgb_colors(const char *p, const char *end, GlobalVertices &r_global_vertices)
@@ -135,9 +198,7 @@ static void geom_add_mrgb_colors(const char *p, const char *end, GlobalVertices
   }
 }
 
-static void geom_add_vertex_normal(const char *p,
-                                   const char *end,
-                                   GlobalVertices &r_global_vertices)
+static void parse_vertex_normal(const char *p, const char *end, OBJChunk &r_chunk)
 {
   float3 normal;
   parse_floats(p, end, 0.0f, normal, 3);
@@ -145,14 +206,14 @@ static void geom_add_vertex_normal(const char *p,
    * making them ever-so-slightly non unit length. Make sure they are
    * normalized. */
   normalize_v3(normal);
-  r_global_vertices.vert_normals.append(normal);
+  r_chunk.vert_normals.append(normal);
 }
 
-static void geom_add_uv_vertex(const char *p, const char *end, GlobalVertices &r_global_vertices)
+static void parse_uv_vertex(const char *p, const char *end, OBJChunk &r_chunk)
 {
   float2 uv;
   parse_floats(p, end, 0.0f, uv, 2);
-  r_global_vertices.uv_vertices.append(uv);
+  r_chunk.uv_vertices.append(uv);
 }
 
 /**
@@ -218,30 +279,13 @@ static void geom_add_polyline(Geometry *geom,
   }
 }
 
-static void geom_add_polygon(Geometry *geom,
-                             const char *p,
-                             const char *end,
-                             const GlobalVertices &global_vertices,
-                             const int material_index,
-                             const int group_index,
-                             const bool shaded_smooth)
+static void parse_polygon(const char *p, const char *end, OBJChunk &r_chunk)
 {
-  FaceElem curr_face;
-  curr_face.shaded_smooth = shaded_smooth;
-  curr_face.material_index = material_index;
-  if (group_index >= 0) {
-    curr_face.vertex_group_index = group_index;
-    geom->has_vertex_groups_ = true;
-  }
-
-  const int orig_corners_size = geom->face_corners_.size();
-  curr_face.start_index_ = orig_corners_size;
-
-  bool face_valid = true;
+  int corners_num = 0;
   p = drop_whitespace(p, end);
-  while (p < end && face_valid) {
-    FaceCorner corner;
-    bool got_uv = false, got_normal = false;
+  while (p < end) {
+    OBJRawFaceCorner raw_corner;
+    FaceCorner &corner = raw_corner.corner;
     /* Parse vertex index. */
     p = parse_int(p, end, INT32_MAX, corner.vert_index, false);
 
@@ -250,21 +294,61 @@ static void geom_add_polygon(Geometry *geom,
       break;
     }
 
-    face_valid &= corner.vert_index != INT32_MAX;
     if (p < end && *p == '/') {
       /* Parse UV index. */
       ++p;
       if (p < end && *p != '/') {
         p = parse_int(p, end, INT32_MAX, corner.uv_vert_index, false);
-        got_uv = corner.uv_vert_index != INT32_MAX;
+        raw_corner.got_uv = corner.uv_vert_index != INT32_MAX;
       }
       /* Parse normal index. */
       if (p < end && *p == '/') {
         ++p;
         p = parse_int(p, end, INT32_MAX, corner.vertex_normal_index, false);
-        got_normal = corner.vertex_normal_index != INT32_MAX;
+        raw_corner.got_normal = corner.vertex_normal_index != INT32_MAX;
       }
     }
+    r_chunk.face_corners.append(raw_corner);
+    corners_num++;
+
+    /* Some files contain extra stuff per face (e.g. 4 indices); skip any remainder (#103441). */
+    p = drop_non_whitespace(p, end);
+    /* Skip whitespace to get to the next face corner. */
+    p = drop_whitespace(p, end);
+  }
+  r_chunk.face_corners_num.append(corners_num);
+}
+
+static void geom_add_polygon(Geometry *geom,
+                             OBJChunk &chunk,
+                             const GlobalVertices &global_vertices,
+                             const int material_index,
+                             const int group_index,
+                             const bool shaded_smooth)
+{
+  FaceElem curr_face;
+  curr_face.shaded_smooth = shaded_smooth;
+  curr_face.material_index = material_index;
+  if (group_index >= 0) {
+    curr_face.vertex_group_index = group_index;
+    geom->has_vertex_groups_ = true;
+  }
+
+  const int orig_corners_size = geom->face_corners_.size();
+  curr_face.start_index_ = orig_corners_size;
+
+  const Span<OBJRawFaceCorner> raw_corners = chunk.face_corners.as_span().slice(
+      chunk.next_face_corner, chunk.face_corners_num[chunk.next_face]);
+  chunk.next_face_corner += raw_corners.size();
+  chunk.next_face++;
+
+  bool face_valid = true;
+  for (const OBJRawFaceCorner &raw_corner : raw_corners) {
+    if (!face_valid) {
+      break;
+    }
+    FaceCorner corner = raw_corner.corner;
+    face_valid &= corner.vert_index != INT32_MAX;
     /* Always keep stored indices non-negative and zero-based. */
     corner.vert_index += corner.vert_index < 0 ? global_vertices.vertices.size() : -1;
     if (corner.vert_index < 0 || corner.vert_index >= global_vertices.vertices.size()) {
@@ -278,7 +362,7 @@ static void geom_add_polygon(Geometry *geom,
       geom->track_vertex_index(corner.vert_index);
     }
     /* Ignore UV index, if the geometry does not have any UVs (#103212). */
-    if (got_uv && !global_vertices.uv_vertices.is_empty()) {
+    if (raw_corner.got_uv && !global_vertices.uv_vertices.is_empty()) {
       corner.uv_vert_index += corner.uv_vert_index < 0 ? global_vertices.uv_vertices.size() : -1;
       if (corner.uv_vert_index < 0 || corner.uv_vert_index >= global_vertices.uv_vertices.size()) {
         CLOG_WARN(&LOG,
@@ -291,7 +375,7 @@ static void geom_add_polygon(Geometry *geom,
     /* Ignore corner normal index, if the geometry does not have any normals.
      * Some obj files out there do have face definitions that refer to normal indices,
      * without any normals being present (#98782). */
-    if (got_normal && !global_vertices.vert_normals.is_empty()) {
+    if (raw_corner.got_normal && !global_vertices.vert_normals.is_empty()) {
       corner.vertex_normal_index += corner.vertex_normal_index < 0 ?
                                         global_vertices.vert_normals.size() :
                                         -1;
@@ -307,11 +391,6 @@ static void geom_add_polygon(Geometry *geom,
     }
     geom->face_corners_.append(corner);
     curr_face.corner_count_++;
-
-    /* Some files contain extra stuff per face (e.g. 4 indices); skip any remainder (#103441). */
-    p = drop_non_whitespace(p, end);
-    /* Skip whitespace to get to the next face corner. */
-    p = drop_whitespace(p, end);
   }
 
   if (face_valid) {
@@ -440,7 +519,8 @@ static void geom_new_object(const char *p,
       r_curr_geom, GEOM_MESH, StringRef(p, end).trim(), r_all_geometries);
 }
 
-OBJParser::OBJParser(const OBJImportParams &import_params) : import_params_(import_params)
+OBJParser::OBJParser(const OBJImportParams &import_params, const int64_t chunk_size)
+    : import_params_(import_params), chunk_size_(chunk_size)
 {
   const int obj_file = BLI_open(import_params_.filepath, O_BINARY | O_RDONLY, 0);
   if (obj_file == -1) {
@@ -508,7 +588,7 @@ static void use_all_vertices_if_no_faces(Geometry *geom,
 /* OBJ file format supports "line continuations", which
  * are back-slashes, optionally followed by whitespace.
  * The line virtually extends to the next line in that case. */
-StringRef OBJParser::read_next_obj_line(StringRef &buffer)
+static StringRef read_next_obj_line(StringRef &buffer, string &line_buffer)
 {
   const char *start = buffer.begin();
   const char *end = buffer.end();
@@ -529,7 +609,7 @@ StringRef OBJParser::read_next_obj_line(StringRef &buffer)
   /* We have backslash. Copy into line buffer, replace
    * line continuation with space, return result. */
 
-  line_buffer_.assign(start, ptr);
+  line_buffer.assign(start, ptr);
 
   while (ptr < end) {
     char c = *ptr++;
@@ -541,41 +621,102 @@ StringRef OBJParser::read_next_obj_line(StringRef &buffer)
       }
       if (ahead < end && *ahead == '\n') {
         /* Line continuation: replace backslash & newline with space. */
-        line_buffer_ += ' ';
+        line_buffer += ' ';
         ptr = ahead + 1; /* Continue after the newline. */
       }
       else {
         /* Not a continuation: keep the backslash. */
-        line_buffer_ += c;
+        line_buffer += c;
       }
     }
     else if (c == '\n') {
       break;
     }
     else {
-      line_buffer_ += c;
+      line_buffer += c;
     }
   }
 
   buffer = StringRef(ptr, end);
-  return line_buffer_;
+  return line_buffer;
+}
+
+/**
+ * Split the buffer into chunks of approximately the given size. Chunks only end after a newline
+ * that is not part of a line continuation, so that every chunk contains complete lines.
+ */
+static Vector<StringRef> split_into_line_chunks(const StringRef buffer, const int64_t chunk_size)
+{
+  Vector<StringRef> chunks;
+  const char *start = buffer.begin();
+  const char *end = buffer.end();
+  while (start < end) {
+    const char *chunk_end = start + std::min<int64_t>(chunk_size, end - start);
+    while (chunk_end < end) {
+      chunk_end = std::find(chunk_end, end, '\n');
+      if (chunk_end == end) {
+        break;
+      }
+      /* Skip whitespace before the newline, to find a possible line continuation. */
+      const char *ptr = chunk_end;
+      while (ptr > start && ptr[-1] <= ' ' && ptr[-1] != '\n') {
+        --ptr;
+      }
+      ++chunk_end;
+      if (ptr == start || ptr[-1] != '\\') {
+        break;
+      }
+    }
+    chunks.append(StringRef(start, chunk_end));
+    start = chunk_end;
+  }
+  return chunks;
 }
 
-void OBJParser::parse_string_buffer(StringRef &buffer_str,
-                                    Vector<std::unique_ptr<Geometry>> &r_all_geometries,
-                                    GlobalVertices &r_global_vertices,
-                                    Geometry *&curr_geom)
+/** Parse the elements of the chunk that do not depend on the parser state. */
+static void parse_chunk_elements(OBJChunk &r_chunk)
 {
-  /* State variables: once set, they remain the same for the remaining
-   * elements in the object. */
-  bool state_shaded_smooth = false;
-  string state_group_name;
-  int state_group_index = -1;
-  string state_material_name;
-  int state_material_index = -1;
+  string line_buffer;
+  StringRef buffer_str = r_chunk.buffer;
+  while (!buffer_str.is_empty()) {
+    StringRef line = read_next_obj_line(buffer_str, line_buffer);
+    const char *p = line.begin(), *end = line.end();
+    p = drop_whitespace(p, end);
+    if (p == end) {
+      continue;
+    }
+    if (*p == 'v') {
+      if (parse_keyword(p, end, "v")) {
+        parse_vertex(p, end, r_chunk);
+      }
+      else if (parse_keyword(p, end, "vn")) {
+        parse_vertex_normal(p, end, r_chunk);
+      }
+      else if (parse_keyword(p, end, "vt")) {
+        parse_uv_vertex(p, end, r_chunk);
+      }
+    }
+    else if (parse_keyword(p, end, "f")) {
+      parse_polygon(p, end, r_chunk);
+    }
+  }
+}
 
+void OBJParser::add_chunk(OBJChunk &chunk,
+                          OBJParseState &state,
+                          Vector<std::unique_ptr<Geometry>> &r_all_geometries,
+                          GlobalVertices &r_global_vertices)
+{
+  Geometry *&curr_geom = state.curr_geom;
+  bool &state_shaded_smooth = state.shaded_smooth;
+  string &state_group_name = state.group_name;
+  int &state_group_index = state.group_index;
+  string &state_material_name = state.material_name;
+  int &state_material_index = state.material_index;
+
+  StringRef buffer_str = chunk.buffer;
   while (!buffer_str.is_empty()) {
-    StringRef line = read_next_obj_line(buffer_str);
+    StringRef line = read_next_obj_line(buffer_str, line_buffer_);
     const char *p = line.begin(), *end = line.end();
     p = drop_whitespace(p, end);
     if (p == end) {
@@ -584,13 +725,13 @@ void OBJParser::parse_string_buffer(StringRef &buffer_str,
     /* Most common things that start with 'v': vertices, normals, UVs. */
     if (*p == 'v') {
       if (parse_keyword(p, end, "v")) {
-        geom_add_vertex(p, end, r_global_vertices);
+        geom_add_vertex(chunk, r_global_vertices);
       }
       else if (parse_keyword(p, end, "vn")) {
-        geom_add_vertex_normal(p, end, r_global_vertices);
+        r_global_vertices.vert_normals.append(chunk.vert_normals[chunk.next_vert_normal++]);
       }
       else if (parse_keyword(p, end, "vt")) {
-        geom_add_uv_vertex(p, end, r_global_vertices);
+        r_global_vertices.uv_vertices.append(chunk.uv_vertices[chunk.next_uv_vertex++]);
       }
     }
     /* Faces. */
@@ -606,8 +747,7 @@ void OBJParser::parse_string_buffer(StringRef &buffer_str,
       }
 
       geom_add_polygon(curr_geom,
-                       p,
-                       end,
+                       chunk,
                        r_global_vertices,
                        state_material_index,
                        state_group_index,
@@ -707,15 +847,56 @@ void OBJParser::parse(Vector<std::unique_ptr<Geometry>> &r_all_geometries,
   STRNCPY(ob_name, BLI_path_basename(import_params_.filepath));
   BLI_path_extension_strip(ob_name);
 
-  Geometry *curr_geom = create_geometry(nullptr, GEOM_MESH, ob_name, r_all_geometries);
+  OBJParseState state;
+  state.curr_geom = create_geometry(nullptr, GEOM_MESH, ob_name, r_all_geometries);
 
   const char *file_data = static_cast<const char *>(BLI_mmap_get_pointer(mmap_file_));
   size_t file_size = BLI_mmap_get_length(mmap_file_);
-  StringRef buffer_str{file_data, int64_t(file_size)};
-  OBJParser::parse_string_buffer(buffer_str, r_all_geometries, r_global_vertices, curr_geom);
+  const Vector<StringRef> chunk_buffers = split_into_line_chunks(
+      StringRef(file_data, int64_t(file_size)), chunk_size_);
+
+  auto parse_batch = [&](const IndexRange batch, Vector<OBJChunk> &r_chunks) {
+    r_chunks.clear();
+    r_chunks.resize(batch.size());
+    threading::parallel_for(batch.index_range(), 1, [&](const IndexRange range) {
+      for (const int64_t i : range) {
+        r_chunks[i].buffer = chunk_buffers[batch[i]];
+        parse_chunk_elements(r_chunks[i]);
+      }
+    });
+  };
+  auto add_batch = [&](Vector<OBJChunk> &chunks) {
+    for (OBJChunk &chunk : chunks) {
+      this->add_chunk(chunk, state, r_all_geometries, r_global_vertices);
+    }
+  };
+
+  /* Adding the elements depends on the previous lines, so it happens in file order, while the
+   * next batch of chunks is parsed in parallel. */
+  const int64_t batches_num = divide_ceil_ul(chunk_buffers.size(), OBJ_CHUNKS_PER_BATCH);
+  auto batch_range = [&](const int64_t batch) {
+    return chunk_buffers.index_range().slice(
+        batch * OBJ_CHUNKS_PER_BATCH,
+        std::min(OBJ_CHUNKS_PER_BATCH, chunk_buffers.size() - batch * OBJ_CHUNKS_PER_BATCH));
+  };
+  Vector<OBJChunk> chunks;
+  Vector<OBJChunk> next_chunks;
+  if (batches_num > 0) {
+    parse_batch(batch_range(0), chunks);
+  }
+  for (const int64_t batch : IndexRange(batches_num)) {
+    if (batch + 1 < batches_num) {
+      threading::parallel_invoke([&]() { add_batch(chunks); },
+                                 [&]() { parse_batch(batch_range(batch + 1), next_chunks); });
+    }
+    else {
+      add_batch(chunks);
+    }
+    std::swap(chunks, next_chunks);
+  }
 
   r_global_vertices.flush_mrgb_block();
-  use_all_vertices_if_no_faces(curr_geom, r_all_geometries, r_global_vertices);
+  use_all_vertices_if_no_faces(state.curr_geom, r_all_geometries, r_global_vertices);
   add_default_mtl_library();
 }
 
@@ -22,6 +22,14 @@ struct BLI_mmap_file;
 namespace blender::io::obj {
 
 struct MTLMaterial;
+struct OBJChunk;
+struct OBJParseState;
+
+/**
+ * The file is split into chunks of complete lines of approximately this size. The numbers in the
+ * chunks, which is where most of the time is spent for large files, are parsed in parallel.
+ */
+constexpr int64_t OBJ_CHUNK_SIZE = 4 * 1024 * 1024;
 
 class OBJParser {
  private:
@@ -29,12 +37,14 @@ class OBJParser {
   Vector<std::string> mtl_libraries_;
   BLI_mmap_file *mmap_file_ = nullptr;
   std::string line_buffer_;
+  int64_t chunk_size_;
 
  public:
   /**
-   * Open OBJ file at the path given in import parameters.
+   * Open OBJ file at the path given in import parameters. Smaller chunk sizes than the default
+   * are mainly useful to test the splitting of the file.
    */
-  OBJParser(const OBJImportParams &import_params);
+  OBJParser(const OBJImportParams &import_params, int64_t chunk_size = OBJ_CHUNK_SIZE);
   ~OBJParser();
 
   /**
@@ -51,11 +61,14 @@ class OBJParser {
  private:
   void add_mtl_library(StringRef path);
   void add_default_mtl_library();
-  StringRef read_next_obj_line(StringRef &buffer);
-  void parse_string_buffer(StringRef &buffer_str,
-                           Vector<std::unique_ptr<Geometry>> &r_all_geometries,
-                           GlobalVertices &r_global_vertices,
-                           Geometry *&curr_geom);
+  /**
+   * Add the elements of a chunk whose numbers have already been parsed, see #parse_chunk_elements.
+   * Chunks have to be added in file order, since elements depend on the preceding lines.
+   */
+  void add_chunk(OBJChunk &chunk,
+                 OBJParseState &state,
+                 Vector<std::unique_ptr<Geometry>> &r_all_geometries,
+                 GlobalVertices &r_global_vertices);
 };
 
 class MTLParser {
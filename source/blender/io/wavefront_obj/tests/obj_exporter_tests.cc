@@ -603,6 +603,63 @@ TEST_F(OBJExportRegressionTest, all_objects_mat_groups)
                                params);
 }
 
+/* Lowers the amounts of elements formatted at once for the duration of a test. */
+class ScopedFormatBatchSizes {
+  FormatBatchSizes orig_sizes_;
+
+ public:
+  explicit ScopedFormatBatchSizes(const FormatBatchSizes &sizes)
+      : orig_sizes_(format_batch_sizes())
+  {
+    format_batch_sizes() = sizes;
+  }
+  ~ScopedFormatBatchSizes()
+  {
+    format_batch_sizes() = orig_sizes_;
+  }
+};
+
+/* Small objects are grouped into batches of several objects, and larger ones are streamed into
+ * the file in batches of parallel chunks. The output must be the same as the golden file written
+ * without batches. */
+static FormatBatchSizes small_format_batch_sizes()
+{
+  FormatBatchSizes sizes;
+  sizes.chunk_size = 5;
+  sizes.stream_batch_chunks = 3;
+  sizes.object_batch_max_elements = 100;
+  return sizes;
+}
+
+TEST_F(OBJExportRegressionTest, all_objects_mat_groups_batched)
+{
+  const ScopedFormatBatchSizes batch_sizes(small_format_batch_sizes());
+  OBJExportParams params;
+  params.forward_axis = IO_AXIS_Y;
+  params.up_axis = IO_AXIS_Z;
+  params.export_smooth_groups = true;
+  params.export_material_groups = true;
+  compare_obj_export_to_golden("io_tests" SEP_STR "blend_scene" SEP_STR "all_objects.blend",
+                               "io_tests" SEP_STR "obj" SEP_STR "all_objects_mat_groups.obj",
+                               "io_tests" SEP_STR "obj" SEP_STR "all_objects_mat_groups.mtl",
+                               params);
+}
+
+TEST_F(OBJExportRegressionTest, suzanne_all_data_batched)
+{
+  const ScopedFormatBatchSizes batch_sizes(small_format_batch_sizes());
+  OBJExportParams params;
+  params.forward_axis = IO_AXIS_Y;
+  params.up_axis = IO_AXIS_Z;
+  params.export_materials = false;
+  params.export_smooth_groups = true;
+  compare_obj_export_to_golden("io_tests" SEP_STR "blend_geometry" SEP_STR
+                               "suzanne_all_data.blend",
+                               "io_tests" SEP_STR "obj" SEP_STR "suzanne_all_data.obj",
+                               "",
+                               params);
+}
+
 TEST_F(OBJExportRegressionTest, materials_without_pbr)
 {
   OBJExportParams params;
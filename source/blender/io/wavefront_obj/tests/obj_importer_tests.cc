@@ -0,0 +1,189 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include <gtest/gtest.h>
+
+#include "BLI_fileops.hh"
+#include "BLI_string.h"
+
+#include "BKE_appdir.hh"
+#include "BKE_gtest_base.hh"
+
+#include "testing/testing.h"
+
+#include "obj_import_file_reader.hh"
+
+namespace blender::io::obj {
+
+struct OBJParseResult {
+  Vector<std::unique_ptr<Geometry>> geometries;
+  GlobalVertices vertices;
+  Vector<std::string> mtl_libraries;
+};
+
+class OBJParserChunksTest : public bke::BlenderGTestBase {
+ public:
+  static OBJParseResult parse(const std::string &filepath, const int64_t chunk_size)
+  {
+    OBJImportParams params;
+    STRNCPY(params.filepath, filepath.c_str());
+    OBJParser parser{params, chunk_size};
+    OBJParseResult result;
+    parser.parse(result.geometries, result.vertices);
+    result.mtl_libraries = Vector<std::string>(parser.mtl_libraries());
+    return result;
+  }
+
+  static void compare_geometry(const Geometry &expect, const Geometry &got)
+  {
+    EXPECT_EQ(expect.geom_type_, got.geom_type_);
+    EXPECT_EQ(expect.geometry_name_, got.geometry_name_);
+    EXPECT_EQ_SPAN<std::string>(expect.group_order_, got.group_order_);
+    EXPECT_EQ_SPAN<std::string>(expect.material_order_, got.material_order_);
+    EXPECT_EQ(expect.vertex_index_min_, got.vertex_index_min_);
+    EXPECT_EQ(expect.vertex_index_max_, got.vertex_index_max_);
+    EXPECT_TRUE(expect.vertices_ == got.vertices_);
+    EXPECT_TRUE(expect.global_to_local_vertices_ == got.global_to_local_vertices_);
+    EXPECT_EQ_SPAN<int2>(expect.edges_, got.edges_);
+    EXPECT_EQ(expect.has_invalid_faces_, got.has_invalid_faces_);
+    EXPECT_EQ(expect.has_vertex_groups_, got.has_vertex_groups_);
+    EXPECT_EQ(expect.total_corner_, got.total_corner_);
+
+    ASSERT_EQ(expect.face_corners_.size(), got.face_corners_.size());
+    for (const int64_t i : expect.face_corners_.index_range()) {
+      EXPECT_EQ(expect.face_corners_[i].vert_index, got.face_corners_[i].vert_index);
+      EXPECT_EQ(expect.face_corners_[i].uv_vert_index, got.face_corners_[i].uv_vert_index);
+      EXPECT_EQ(expect.face_corners_[i].vertex_normal_index,
+                got.face_corners_[i].vertex_normal_index);
+    }
+    ASSERT_EQ(expect.face_elements_.size(), got.face_elements_.size());
+    for (const int64_t i : expect.face_elements_.index_range()) {
+      const FaceElem &expect_face = expect.face_elements_[i];
+      const FaceElem &got_face = got.face_elements_[i];
+      EXPECT_EQ(expect_face.vertex_group_index, got_face.vertex_group_index);
+      EXPECT_EQ(expect_face.material_index, got_face.material_index);
+      EXPECT_EQ(expect_face.shaded_smooth, got_face.shaded_smooth);
+      EXPECT_EQ(expect_face.start_index_, got_face.start_index_);
+      EXPECT_EQ(expect_face.corner_count_, got_face.corner_count_);
+    }
+
+    EXPECT_EQ(expect.nurbs_element_.group_, got.nurbs_element_.group_);
+    EXPECT_EQ(expect.nurbs_element_.degree, got.nurbs_element_.degree);
+    EXPECT_EQ_SPAN<int>(expect.nurbs_element_.curv_indices, got.nurbs_element_.curv_indices);
+    EXPECT_EQ_SPAN<float>(expect.nurbs_element_.parm, got.nurbs_element_.parm);
+  }
+
+  /**
+   * Parse the file as a single chunk and with small chunks, and check that splitting the file
+   * into chunks does not change the result.
+   */
+  static void check_file(const std::string &filepath)
+  {
+    const OBJParseResult expect = parse(filepath, INT64_MAX);
+    ASSERT_FALSE(expect.geometries.is_empty());
+
+    for (const int64_t chunk_size : {int64_t(1), int64_t(37), int64_t(1024)}) {
+      SCOPED_TRACE(filepath + " with chunk size " + std::to_string(chunk_size));
+      const OBJParseResult got = parse(filepath, chunk_size);
+
+      EXPECT_EQ_SPAN<std::string>(expect.mtl_libraries, got.mtl_libraries);
+      EXPECT_EQ_SPAN<float3>(expect.vertices.vertices, got.vertices.vertices);
+      EXPECT_EQ_SPAN<float2>(expect.vertices.uv_vertices, got.vertices.uv_vertices);
+      EXPECT_EQ_SPAN<float3>(expect.vertices.vert_normals, got.vertices.vert_normals);
+      EXPECT_EQ_SPAN<float3>(expect.vertices.vertex_colors, got.vertices.vertex_colors);
+      EXPECT_EQ_SPAN<float>(expect.vertices.vertex_weights, got.vertices.vertex_weights);
+
+      ASSERT_EQ(expect.geometries.size(), got.geometries.size());
+      for (const int64_t i : expect.geometries.index_range()) {
+        compare_geometry(*expect.geometries[i], *got.geometries[i]);
+      }
+    }
+  }
+
+  static void check_asset(const char *filename)
+  {
+    check_file(tests::flags_test_asset_dir() + SEP_STR "io_tests" SEP_STR "obj" SEP_STR +
+               filename);
+  }
+};
+
+TEST_F(OBJParserChunksTest, all_objects)
+{
+  check_asset("all_objects.obj");
+}
+
+TEST_F(OBJParserChunksTest, cube_vertex_groups)
+{
+  check_asset("cube_vertex_groups.obj");
+}
+
+TEST_F(OBJParserChunksTest, cubes_vertex_colors_mrgb)
+{
+  check_asset("cubes_vertex_colors_mrgb.obj");
+}
+
+TEST_F(OBJParserChunksTest, invalid_indices)
+{
+  check_asset("invalid_indices.obj");
+}
+
+TEST_F(OBJParserChunksTest, faces_invalid_or_with_holes)
+{
+  check_asset("faces_invalid_or_with_holes.obj");
+}
+
+TEST_F(OBJParserChunksTest, nurbs)
+{
+  check_asset("nurbs.obj");
+}
+
+TEST_F(OBJParserChunksTest, suzanne_all_data)
+{
+  check_asset("suzanne_all_data.obj");
+}
+
+TEST_F(OBJParserChunksTest, line_continuations_and_relative_indices)
+{
+  /* Line continuations must not be split across chunks, and relative indices have to be resolved
+   * against the elements of preceding chunks. */
+  const char *text =
+      "mtllib a.mtl \\\n"
+      "  b.mtl\n"
+      "o First\n"
+      "v 0 0 0\n"
+      "v 1 0 0 \\\n"
+      "\n"
+      "v 1 1 0 0.5 0.25 0.125\n"
+      "vt 0 0\n"
+      "vt 1 0\n"
+      "vt 1 1\n"
+      "vn 0 0 1\n"
+      "usemtl Red\n"
+      "s 1\n"
+      "f -3/-3/-1 -2/-2/-1 \\\n"
+      "   -1/-1/-1\n"
+      "o Second\n"
+      "g Group\n"
+      "v 0 0 1\n"
+      "v 1 0 1\n"
+      "v 1 1 1\n"
+      "v 0 1 1\n"
+      "usemtl Blue\n"
+      "s off\n"
+      "f -4 -3 -2 -1\n"
+      "l 4 5\n";
+
+  BKE_tempdir_init(nullptr);
+  const std::string filepath = std::string(BKE_tempdir_base()) + SEP_STR +
+                               "obj_parser_chunks_test.obj";
+  FILE *file = BLI_fopen(filepath.c_str(), "wb");
+  fputs(text, file);
+  fclose(file);
+
+  check_file(filepath);
+
+  BLI_delete(filepath.c_str(), false, false);
+}
+
+}  // namespace blender::io::obj
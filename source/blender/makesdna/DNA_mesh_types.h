@@ -557,6 +557,13 @@ struct Mesh {
 
   /** Call after changing vertex positions to tag lazily calculated caches for recomputation. */
   void tag_positions_changed();
+  /**
+   * Like #tag_positions_changed, but only the given vertices moved. Normals that are cached
+   * already are updated in the neighborhood of those vertices right away instead of being
+   * recomputed for the whole mesh later on. Falls back to #tag_positions_changed when a large
+   * part of the mesh changed.
+   */
+  void tag_positions_changed(const IndexMask &changed_verts);
   /** Call after moving every mesh vertex by the same translation. */
   void tag_positions_changed_uniformly();
   /** Like #tag_positions_changed but doesn't tag normals; they must be updated separately. */
@@ -7707,6 +7707,12 @@ static void rna_def_userdef_experimental(BlenderRNA *brna)
       prop, "Collection Import", "Enables a file importer to be configured on a Collection");
   RNA_def_property_update(prop, 0, "rna_userdef_ui_update");
 
+  prop = RNA_def_property(srna, "use_geometry_nodes_node_cache", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_ui_text(prop,
+                           "Geometry Nodes Cache",
+                           "Reuse the results of geometry nodes from previous evaluations when "
+                           "their inputs did not change");
+
   prop = RNA_def_property(srna, "use_extensions_debug", PROP_BOOLEAN, PROP_NONE);
   RNA_def_property_ui_text(
       prop,
@@ -36,29 +36,19 @@ static KDTree<float3> *build_kdtree(const Span<float3> positions, const IndexMas
   return tree;
 }
 
-static int find_nearest_non_self(const KDTree<float3> &tree,
-                                 const float3 &position,
-                                 const int index)
-{
-  return kdtree_find_nearest_cb<float3>(
-      &tree,
-      position,
-      nullptr,
-      [index](const int other, const float3 & /*co*/, const float /*dist_sq*/) {
-        return index == other ? 0 : 1;
-      });
-}
-
 static void find_neighbors(const KDTree<float3> &tree,
                            const Span<float3> positions,
                            const IndexMask &mask,
                            MutableSpan<int> r_indices)
 {
-  mask.foreach_index(
-      [&](const int index) {
-        r_indices[index] = find_nearest_non_self(tree, positions[index], index);
-      },
-      exec_mode::grain_size(1024));
+  kdtree_find_nearest_batch_cb<float3>(
+      &tree,
+      positions,
+      mask,
+      r_indices,
+      [](const int index, const int other, const float3 & /*co*/, const float /*dist_sq*/) {
+        return index == other ? 0 : 1;
+      });
 }
 
 class IndexOfNearestFieldInput final : public bke::GeometryFieldInput {
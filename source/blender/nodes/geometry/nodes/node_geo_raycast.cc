@@ -142,56 +142,64 @@ static void raycast_to_mesh(const IndexMask &mask,
     return;
   }
 
-  mask.foreach_index([&](const int i) {
-    const float ray_length = ray_lengths[i];
-    const float3 ray_origin = ray_origins[i];
-    const float3 ray_direction = ray_directions[i];
-
-    BVHTreeRayHit hit;
-    hit.index = -1;
-    hit.dist = ray_length;
-    if (BLI_bvhtree_ray_cast(tree_data.tree,
-                             ray_origin,
-                             ray_direction,
-                             0.0f,
-                             &hit,
-                             tree_data.raycast_callback,
-                             &tree_data) != -1)
-    {
-      if (!r_hit.is_empty()) {
-        r_hit[i] = hit.index >= 0;
-      }
-      if (!r_hit_indices.is_empty()) {
-        /* The caller must be able to handle invalid indices anyway, so don't clamp this value. */
-        r_hit_indices[i] = hit.index;
-      }
-      if (!r_hit_positions.is_empty()) {
-        r_hit_positions[i] = hit.co;
-      }
-      if (!r_hit_normals.is_empty()) {
-        r_hit_normals[i] = hit.no;
-      }
-      if (!r_hit_distances.is_empty()) {
-        r_hit_distances[i] = hit.dist;
-      }
+  /* Cast the rays in batches, to make use of the packet traversal of the BVH tree without
+   * allocating temporary data for all rays at once. */
+  threading::parallel_for(mask.index_range(), 4096, [&](const IndexRange range) {
+    const IndexMask sliced_mask = mask.slice(range);
+    Array<float3> origins(range.size());
+    Array<float3> directions(range.size());
+    Array<float> lengths(range.size());
+    ray_origins.materialize_compressed(sliced_mask, origins);
+    ray_directions.materialize_compressed(sliced_mask, directions);
+    ray_lengths.materialize_compressed(sliced_mask, lengths);
+
+    Array<BVHTreeRayHit> hits(range.size());
+    for (const int64_t i : hits.index_range()) {
+      hits[i].index = -1;
+      hits[i].dist = lengths[i];
     }
-    else {
-      if (!r_hit.is_empty()) {
-        r_hit[i] = false;
+    BLI_bvhtree_ray_cast_batch(
+        tree_data.tree, origins, directions, hits, tree_data.raycast_callback, &tree_data);
+
+    sliced_mask.foreach_index([&](const int i, const int pos) {
+      const BVHTreeRayHit &hit = hits[pos];
+      if (hit.index != -1) {
+        if (!r_hit.is_empty()) {
+          r_hit[i] = hit.index >= 0;
+        }
+        if (!r_hit_indices.is_empty()) {
+          /* The caller must be able to handle invalid indices anyway, so don't clamp this
+           * value. */
+          r_hit_indices[i] = hit.index;
+        }
+        if (!r_hit_positions.is_empty()) {
+          r_hit_positions[i] = hit.co;
+        }
+        if (!r_hit_normals.is_empty()) {
+          r_hit_normals[i] = hit.no;
+        }
+        if (!r_hit_distances.is_empty()) {
+          r_hit_distances[i] = hit.dist;
+        }
       }
-      if (!r_hit_indices.is_empty()) {
-        r_hit_indices[i] = -1;
+      else {
+        if (!r_hit.is_empty()) {
+          r_hit[i] = false;
+        }
+        if (!r_hit_indices.is_empty()) {
+          r_hit_indices[i] = -1;
+        }
+        if (!r_hit_positions.is_empty()) {
+          r_hit_positions[i] = float3(0.0f, 0.0f, 0.0f);
+        }
+        if (!r_hit_normals.is_empty()) {
+          r_hit_normals[i] = float3(0.0f, 0.0f, 0.0f);
+        }
+        if (!r_hit_distances.is_empty()) {
+          r_hit_distances[i] = lengths[pos];
+        }
       }
-      if (!r_hit_positions.is_empty()) {
-        r_hit_positions[i] = float3(0.0f, 0.0f, 0.0f);
-      }
-      if (!r_hit_normals.is_empty()) {
-        r_hit_normals[i] = float3(0.0f, 0.0f, 0.0f);
-      }
-      if (!r_hit_distances.is_empty()) {
-        r_hit_distances[i] = ray_length;
-      }
-    }
+    });
   });
 }
 
@@ -4,6 +4,8 @@
 
 #include "DNA_pointcloud_types.h"
 
+#include "BLI_array_utils.hh"
+
 #include "BKE_curves.hh"
 #include "BKE_grease_pencil.hh"
 #include "BKE_instances.hh"
@@ -56,6 +58,31 @@ static void set_points_position(bke::MutableAttributeAccessor attributes,
                                      position_field);
 }
 
+static void set_mesh_position(Mesh &mesh,
+                              const Field<bool> &selection_field,
+                              const Field<float3> &position_field)
+{
+  const bke::MeshFieldContext context(mesh, bke::AttrDomain::Point);
+  fn::FieldEvaluator evaluator(context, mesh.verts_num);
+  evaluator.set_selection(selection_field);
+
+  /* Use a temporary array for the output to avoid potentially reading from freed memory if
+   * retrieving the positions has to make a mutable copy. */
+  Array<float3> result(mesh.verts_num);
+  evaluator.add_with_destination(position_field, result.as_mutable_span());
+  evaluator.evaluate();
+
+  const IndexMask selection = evaluator.get_evaluated_selection_as_mask();
+  if (selection.is_empty()) {
+    return;
+  }
+
+  MutableSpan<float3> positions = mesh.vert_positions_for_write();
+  array_utils::copy(result.as_span(), selection, positions);
+  /* Passing the selection allows updating cached normals only around the moved vertices. */
+  mesh.tag_positions_changed(selection);
+}
+
 static void set_curves_position(bke::CurvesGeometry &curves,
                                 const fn::FieldContext &field_context,
                                 const Field<bool> &selection_field,
@@ -135,10 +162,7 @@ static void node_geo_exec(GeoNodeExecParams params)
                                 params.extract_input<Field<float3>>("Offset"_ustr)}));
 
   if (Mesh *mesh = geometry.get_mesh_for_write()) {
-    set_points_position(mesh->attributes_for_write(),
-                        bke::MeshFieldContext(*mesh, bke::AttrDomain::Point),
-                        selection_field,
-                        position_field);
+    set_mesh_position(*mesh, selection_field, position_field);
   }
   if (PointCloud *pointcloud = geometry.get_pointcloud_for_write()) {
     set_points_position(pointcloud->attributes_for_write(),
@@ -62,6 +62,7 @@
 
 #include "GEO_foreach_geometry.hh"
 
+#include "geometry_nodes_node_cache.hh"
 #include "list_function_eval.hh"
 #include "volume_grid_function_eval.hh"
 
@@ -131,6 +132,8 @@ class LazyFunctionForGeometryNode : public LazyFunction {
    * does not have to execute.
    */
   Vector<bool> is_attribute_output_bsocket_;
+  /** Identifies this function in the node cache, or none if the node can't be cached. */
+  std::optional<uint64_t> cache_uid_;
 
  public:
   LazyFunctionForGeometryNode(const bNode &node,
@@ -141,6 +144,9 @@ class LazyFunctionForGeometryNode : public LazyFunction {
   {
     BLI_assert(node.typeinfo->geometry_node_execute != nullptr);
     debug_name_ = node.name;
+    if (node_cache::node_supports_caching(node)) {
+      cache_uid_ = node_cache::new_cache_uid();
+    }
     lazy_function_interface_from_node(
         node, inputs_, outputs_, own_lf_graph_info.mapping.lf_index_by_bsocket);
 
@@ -232,8 +238,25 @@ class LazyFunctionForGeometryNode : public LazyFunction {
       return;
     }
 
+    if (cache_uid_ && node_cache::is_enabled()) {
+      if (node_cache::execute_cached(
+              *this, node_, *cache_uid_, params, context, [&](lf::Params &exec_params) {
+                this->execute_node(exec_params, context, *user_data);
+              }))
+      {
+        return;
+      }
+    }
+
+    this->execute_node(params, context, *user_data);
+  }
+
+  void execute_node(lf::Params &params,
+                    const lf::Context &context,
+                    const GeoNodesUserData &user_data) const
+  {
     auto get_anonymous_attribute_name = [&](const int i) {
-      return this->anonymous_attribute_name_for_output(*user_data, i);
+      return this->anonymous_attribute_name_for_output(user_data, i);
     };
 
     GeoNodeExecParams geo_params{
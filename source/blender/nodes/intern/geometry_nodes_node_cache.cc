@@ -0,0 +1,507 @@
+/* SPDX-FileCopyrightText: 2025 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup nodes
+ */
+
+#include <atomic>
+#include <xxhash.h>
+
+#include "BLI_array.hh"
+#include "BLI_compute_context.hh"
+#include "BLI_implicit_sharing_ptr.hh"
+#include "BLI_memory_cache.hh"
+#include "BLI_memory_counter.hh"
+#include "BLI_unique_hash.hh"
+#include "BLI_vector.hh"
+
+#include "DNA_node_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+#include "DNA_userdef_types.h"
+
+#include "BKE_geometry_nodes_reference_set.hh"
+#include "BKE_geometry_set.hh"
+#include "BKE_node_runtime.hh"
+#include "BKE_node_socket_value.hh"
+
+#include "DEG_depsgraph_query.hh"
+
+#include "FN_field.hh"
+#include "FN_lazy_function_execute.hh"
+
+#include "NOD_eval_log.hh"
+#include "NOD_geometry_nodes_lazy_function.hh"
+#include "NOD_geometry_nodes_values.hh"
+
+#include "geometry_nodes_node_cache.hh"
+
+namespace blender::nodes::node_cache {
+
+using bke::GeometryComponent;
+using bke::GeometryNodesReferenceSet;
+using bke::GeometrySet;
+using bke::SocketValueVariant;
+
+bool is_enabled()
+{
+  return USER_EXPERIMENTAL_TEST(&U, use_geometry_nodes_node_cache);
+}
+
+bool node_supports_caching(const bNode &node)
+{
+  /* These nodes read data that is not passed in through their inputs, like files on disk or the
+   * state of the operator that is being executed. */
+  const StringRef idname = node.idname;
+  if (idname.startswith("GeometryNodeImport") || idname.startswith("GeometryNodeTool") ||
+      node.is_type("GeometryNodeDeformCurvesOnSurface"_ustr))
+  {
+    return false;
+  }
+  bool has_geometry_socket = false;
+  for (const bNodeSocket *socket : node.input_sockets()) {
+    if (!socket->is_available()) {
+      continue;
+    }
+    /* Data-block references are not supported, because the referenced data can change or be
+     * freed without the socket value changing. */
+    if (!ELEM(socket->type,
+              SOCK_FLOAT,
+              SOCK_VECTOR,
+              SOCK_RGBA,
+              SOCK_BOOLEAN,
+              SOCK_INT,
+              SOCK_INT_VECTOR,
+              SOCK_STRING,
+              SOCK_ROTATION,
+              SOCK_MATRIX,
+              SOCK_MENU,
+              SOCK_GEOMETRY))
+    {
+      return false;
+    }
+    has_geometry_socket |= socket->type == SOCK_GEOMETRY;
+  }
+  for (const bNodeSocket *socket : node.output_sockets()) {
+    if (socket->is_available() && socket->type == SOCK_GEOMETRY) {
+      has_geometry_socket = true;
+    }
+  }
+  /* Caching nodes that only work on simple values does not pay off compared to the overhead of
+   * looking up the cache. */
+  return has_geometry_socket;
+}
+
+uint64_t new_cache_uid()
+{
+  static std::atomic<uint64_t> uid_counter = 0;
+  return uid_counter.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * Identifies a geometry component that is passed into a node. Data that has been modified in place
+ * has a new version, so it does not match anymore.
+ */
+struct ComponentState {
+  /** Weak user, so that the memory address is not reused while the key exists. */
+  WeakImplicitSharingPtr sharing_info;
+  int64_t version;
+
+  friend bool operator==(const ComponentState &a, const ComponentState &b)
+  {
+    return a.sharing_info == b.sharing_info && a.version == b.version;
+  }
+};
+
+class NodeCacheKey : public GenericKey {
+ public:
+  uint64_t cache_uid = 0;
+  ComputeContextHash context_hash;
+  /** Hash of all inputs that are not geometries. */
+  UniqueHash inputs_hash;
+  /**
+   * The deep hash of some field inputs depends on their memory address, so the fields are kept
+   * alive to avoid that the address is reused by a different field.
+   */
+  Vector<fn::GField> fields;
+  Vector<ComponentState> components;
+
+  uint64_t hash() const override
+  {
+    return get_default_hash(cache_uid, context_hash.hash(), inputs_hash.hash());
+  }
+
+  friend bool operator==(const NodeCacheKey &a, const NodeCacheKey &b)
+  {
+    return a.cache_uid == b.cache_uid && a.context_hash == b.context_hash &&
+           a.inputs_hash == b.inputs_hash && a.components == b.components;
+  }
+
+  bool equal_to(const GenericKey &other) const override
+  {
+    if (const auto *other_typed = dynamic_cast<const NodeCacheKey *>(&other)) {
+      return *this == *other_typed;
+    }
+    return false;
+  }
+
+  std::unique_ptr<GenericKey> to_storable() const override
+  {
+    return std::make_unique<NodeCacheKey>(*this);
+  }
+};
+
+class NodeCacheValue : public memory_cache::CachedValue {
+ public:
+  /** The computed outputs, indexed like the outputs of the lazy-function. */
+  Array<std::optional<SocketValueVariant>> outputs;
+  Vector<eval_log::NodeWarning> warnings;
+  Vector<std::pair<std::string, eval_log::NamedAttributeUsage>> used_named_attributes;
+  /**
+   * The fields of the key of this value. The memory cache only counts the memory of values, so
+   * they are counted here.
+   */
+  Vector<fn::GField> key_fields;
+
+  void count_memory(MemoryCounter &memory) const override
+  {
+    for (const std::optional<SocketValueVariant> &value : this->outputs) {
+      if (value) {
+        value->count_memory(memory);
+      }
+    }
+    for (const fn::GField &field : this->key_fields) {
+      count_field_memory(field, memory);
+    }
+  }
+
+ private:
+  /**
+   * Fields don't know the size of their inputs and functions, so this is an estimate based on the
+   * number of field nodes. Field nodes may be shared by multiple fields and are only counted once.
+   */
+  static void count_field_memory(const fn::GField &field, MemoryCounter &memory)
+  {
+    memory.add(sizeof(fn::GField));
+    const fn::GField::Variant &variant = field.variant();
+    if (const auto *input = std::get_if<fn::GField::Input>(&variant)) {
+      memory.add_shared(input->node.get(), sizeof(fn::FieldInput));
+    }
+    else if (const auto *multi_fn = std::get_if<fn::GField::MultiFn>(&variant)) {
+      const fn::FieldOperation &operation = *multi_fn->node;
+      memory.add_shared(&operation, [&](MemoryCounter &shared_memory) {
+        shared_memory.add(sizeof(fn::FieldOperation));
+        for (const fn::GField &input_field : operation.inputs()) {
+          count_field_memory(input_field, shared_memory);
+        }
+      });
+    }
+    else if (const auto *constant = std::get_if<fn::GField::OwnedConstant>(&variant)) {
+      memory.add(constant->type->size);
+    }
+  }
+};
+
+static void hash_string(const StringRef str, UniqueHashBytes &hash)
+{
+  hash.add(str.size());
+  hash.data.extend(Span(str.data(), str.size()).cast<std::byte>());
+}
+
+/**
+ * Add the value to the key. Returns false if the value can't be used in a key.
+ */
+static bool add_value_to_key(const SocketValueVariant &value,
+                             NodeCacheKey &key,
+                             fn::FieldHashDeep &field_hash,
+                             UniqueHashBytes &hash)
+{
+  hash.add(value.socket_type());
+  if (value.is_field()) {
+    fn::GField field = value.get<fn::GField>();
+    hash.add(field_hash.ensure(field));
+    key.fields.append(std::move(field));
+    return true;
+  }
+  if (!value.is_single()) {
+    /* Grids and lists are not supported yet. */
+    return false;
+  }
+  const GPointer single = value.get_single_ptr();
+  if (single.type()->is<GeometrySet>()) {
+    const GeometrySet &geometry = *single.get<GeometrySet>();
+    if (geometry.has_bundle()) {
+      return false;
+    }
+    hash_string(geometry.name(), hash);
+    const Vector<const GeometryComponent *> components = geometry.get_components();
+    hash.add(components.size());
+    for (const GeometryComponent *component : components) {
+      hash.add(component->type());
+      component->add_weak_user();
+      key.components.append({WeakImplicitSharingPtr(component), component->version()});
+    }
+    return true;
+  }
+  if (!single.type()->is_hashable()) {
+    return false;
+  }
+  hash.add(single.type());
+  single.type()->hash_unique(single.get(), hash);
+  return true;
+}
+
+/**
+ * Some nodes depend on the evaluation mode and the simplify settings of the scene, like the voxel
+ * size of the Mesh to Volume node.
+ */
+static void add_depsgraph_state_to_key(const GeoNodesCallData &call_data, UniqueHashBytes &hash)
+{
+  const Depsgraph *depsgraph = nullptr;
+  if (call_data.modifier_data) {
+    depsgraph = call_data.modifier_data->depsgraph;
+  }
+  else if (call_data.operator_data) {
+    depsgraph = call_data.operator_data->depsgraphs->active;
+  }
+  hash.add(depsgraph != nullptr);
+  if (depsgraph == nullptr) {
+    return;
+  }
+  hash.add(DEG_get_mode(depsgraph));
+  const Scene *scene = DEG_get_input_scene(depsgraph);
+  const bool use_simplify = scene->r.mode & R_SIMPLIFY;
+  hash.add(use_simplify);
+  if (use_simplify) {
+    hash.add(scene->r.simplify_subsurf);
+    hash.add(scene->r.simplify_subsurf_render);
+    hash.add(scene->r.simplify_gpencil);
+    hash.add(scene->r.simplify_particles);
+    hash.add(scene->r.simplify_particles_render);
+    hash.add(scene->r.simplify_volumes);
+  }
+}
+
+static std::optional<NodeCacheKey> build_key(const lf::LazyFunction &fn,
+                                             const uint64_t cache_uid,
+                                             const lf::Params &params,
+                                             const GeoNodesUserData &user_data,
+                                             const bool use_logging)
+{
+  NodeCacheKey key;
+  key.cache_uid = cache_uid;
+  key.context_hash = user_data.compute_context->hash();
+
+  fn::FieldHashDeep field_hash;
+  UniqueHashBytes hash;
+  /* The names of anonymous attributes created by the node depend on the object. */
+  if (const Object *self_object = user_data.call_data->self_object()) {
+    hash_string(self_object->id.name, hash);
+  }
+  /* Entries computed without logging don't know about warnings of the node. */
+  hash.add(use_logging);
+  add_depsgraph_state_to_key(*user_data.call_data, hash);
+
+  for (const int input_i : fn.inputs().index_range()) {
+    const CPPType &type = *fn.inputs()[input_i].type;
+    const void *value = params.try_get_input_data_ptr(input_i);
+    BLI_assert(value != nullptr);
+    if (type.is<SocketValueVariant>()) {
+      const auto &value_variant = *static_cast<const SocketValueVariant *>(value);
+      if (!add_value_to_key(value_variant, key, field_hash, hash)) {
+        return std::nullopt;
+      }
+    }
+    else if (type.is<GeoNodesMultiInput<SocketValueVariant>>()) {
+      const auto &multi_input = *static_cast<const GeoNodesMultiInput<SocketValueVariant> *>(
+          value);
+      hash.add(multi_input.values.size());
+      for (const SocketValueVariant &item : multi_input.values) {
+        if (!add_value_to_key(item, key, field_hash, hash)) {
+          return std::nullopt;
+        }
+      }
+    }
+    else if (type.is<bool>()) {
+      hash.add(*static_cast<const bool *>(value));
+    }
+    else if (type.is<GeometryNodesReferenceSet>()) {
+      const auto &reference_set = *static_cast<const GeometryNodesReferenceSet *>(value);
+      Vector<StringRef> names;
+      if (reference_set.names) {
+        names.extend(reference_set.names->begin(), reference_set.names->end());
+      }
+      std::sort(names.begin(), names.end());
+      hash.add(names.size());
+      for (const StringRef name : names) {
+        hash_string(name, hash);
+      }
+    }
+    else {
+      return std::nullopt;
+    }
+  }
+
+  const Span bytes = hash.data.as_span();
+  const XXH128_hash_t xxhash = XXH3_128bits(bytes.data(), bytes.size());
+  static_assert(sizeof(UniqueHash) == sizeof(xxhash));
+  memcpy(static_cast<void *>(&key.inputs_hash), &xxhash, sizeof(xxhash));
+  return key;
+}
+
+/**
+ * Execute the node with separate output storage, so that the outputs can be stored in the cache.
+ */
+static std::unique_ptr<NodeCacheValue> execute_for_cache(
+    const lf::LazyFunction &fn,
+    const bNode &node,
+    lf::Params &params,
+    eval_log::NodeTreeLogger *tree_logger,
+    const FunctionRef<void(lf::Params &params)> execute_fn)
+{
+  const int inputs_num = fn.inputs().size();
+  const int outputs_num = fn.outputs().size();
+
+  Array<GMutablePointer> inputs(inputs_num);
+  Array<std::optional<lf::ValueUsage>> input_usages(inputs_num);
+  for (const int input_i : IndexRange(inputs_num)) {
+    inputs[input_i] = {*fn.inputs()[input_i].type, params.try_get_input_data_ptr(input_i)};
+  }
+
+  /* All outputs are computed, even if they are not used currently, so that the cached value can
+   * be reused when a different subset of outputs is requested later on. Outputs that have been
+   * set already only output anonymous attribute fields and are not computed by the node. */
+  Array<SocketValueVariant> output_values(outputs_num, NoInitialization());
+  Array<GMutablePointer> outputs(outputs_num);
+  Array<lf::ValueUsage> output_usages(outputs_num);
+  Array<bool> set_outputs(outputs_num);
+  Array<bool> already_set(outputs_num);
+  for (const int output_i : IndexRange(outputs_num)) {
+    BLI_assert(fn.outputs()[output_i].type->is<SocketValueVariant>());
+    outputs[output_i] = {CPPType::get<SocketValueVariant>(), &output_values[output_i]};
+    already_set[output_i] = params.output_was_set(output_i);
+    set_outputs[output_i] = already_set[output_i];
+    output_usages[output_i] = already_set[output_i] ? lf::ValueUsage::Unused :
+                                                      lf::ValueUsage::Used;
+  }
+
+  lf::BasicParams cache_params{fn, inputs, outputs, input_usages, output_usages, set_outputs};
+  execute_fn(cache_params);
+
+  auto cached_value = std::make_unique<NodeCacheValue>();
+  cached_value->outputs.reinitialize(outputs_num);
+  for (const int output_i : IndexRange(outputs_num)) {
+    SocketValueVariant &value = output_values[output_i];
+    if (already_set[output_i] || !set_outputs[output_i]) {
+      /* Construct a value so that the array can be destructed as usual. */
+      new (&value) SocketValueVariant();
+      continue;
+    }
+    /* Cached data must not reference data that may be freed independently of the cache. */
+    value.ensure_owns_direct_data();
+    cached_value->outputs[output_i] = std::move(value);
+  }
+
+  if (tree_logger) {
+    /* The logger lists the most recently added elements first. */
+    for (const eval_log::NodeTreeLogger::WarningWithNode &warning : tree_logger->node_warnings) {
+      if (warning.node_id == node.identifier) {
+        cached_value->warnings.append(warning.warning);
+      }
+    }
+    std::reverse(cached_value->warnings.begin(), cached_value->warnings.end());
+    for (const eval_log::NodeTreeLogger::AttributeUsageWithNode &usage :
+         tree_logger->used_named_attributes)
+    {
+      if (usage.node_id == node.identifier) {
+        cached_value->used_named_attributes.append({usage.attribute_name, usage.usage});
+      }
+    }
+    std::reverse(cached_value->used_named_attributes.begin(),
+                 cached_value->used_named_attributes.end());
+  }
+  return cached_value;
+}
+
+static void replay_log(const NodeCacheValue &cached_value,
+                       const bNode &node,
+                       eval_log::NodeTreeLogger &tree_logger)
+{
+  for (const eval_log::NodeWarning &warning : cached_value.warnings) {
+    tree_logger.node_warnings.append(
+        *tree_logger.allocator,
+        {node.identifier, {warning.type, tree_logger.allocator->copy_string(warning.message)}});
+  }
+  for (const auto &[name, usage] : cached_value.used_named_attributes) {
+    tree_logger.used_named_attributes.append(
+        *tree_logger.allocator,
+        {node.identifier, tree_logger.allocator->copy_string(name), usage});
+  }
+}
+
+bool execute_cached(const lf::LazyFunction &fn,
+                    const bNode &node,
+                    const uint64_t cache_uid,
+                    lf::Params &params,
+                    const lf::Context &context,
+                    const FunctionRef<void(lf::Params &params)> execute_fn)
+{
+  const auto &user_data = *static_cast<GeoNodesUserData *>(context.user_data);
+  const auto &local_user_data = *static_cast<GeoNodesLocalUserData *>(context.local_user_data);
+  eval_log::NodeTreeLogger *tree_logger = local_user_data.try_get_tree_logger(user_data);
+
+  const std::optional<NodeCacheKey> key = build_key(
+      fn, cache_uid, params, user_data, tree_logger != nullptr);
+  if (!key) {
+    return false;
+  }
+
+  bool computed = false;
+  const std::shared_ptr<const NodeCacheValue> cached_value = memory_cache::get<NodeCacheValue>(
+      *key, [&]() {
+        computed = true;
+        std::unique_ptr<NodeCacheValue> value = execute_for_cache(
+            fn, node, params, tree_logger, execute_fn);
+        value->key_fields = key->fields;
+        return value;
+      });
+
+  /* The inputs may have been consumed when the node was executed above, so there is no fallback
+   * anymore in that case. */
+  if (!computed) {
+    for (const int output_i : fn.outputs().index_range()) {
+      if (params.output_was_set(output_i) ||
+          params.get_output_usage(output_i) == lf::ValueUsage::Unused)
+      {
+        continue;
+      }
+      if (!cached_value->outputs[output_i]) {
+        /* Some outputs were not computed when the value was cached. */
+        execute_fn(params);
+        return true;
+      }
+    }
+    if (tree_logger) {
+      replay_log(*cached_value, node, *tree_logger);
+    }
+  }
+
+  for (const int output_i : fn.outputs().index_range()) {
+    if (params.output_was_set(output_i) ||
+        params.get_output_usage(output_i) == lf::ValueUsage::Unused)
+    {
+      continue;
+    }
+    const std::optional<SocketValueVariant> &value = cached_value->outputs[output_i];
+    if (!value) {
+      continue;
+    }
+    new (params.get_output_data_ptr(output_i)) SocketValueVariant(*value);
+    params.output_set(output_i);
+  }
+  return true;
+}
+
+}  // namespace blender::nodes::node_cache
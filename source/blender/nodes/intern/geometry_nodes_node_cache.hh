@@ -0,0 +1,58 @@
+/* SPDX-FileCopyrightText: 2025 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup nodes
+ *
+ * Optional cache for the results of individual geometry nodes that persists across evaluations.
+ * Entries are stored in the global #memory_cache, so they share its memory budget and are freed
+ * when the cache is full.
+ *
+ * The key of a cache entry identifies the node, the compute context it is evaluated in and all
+ * its input values. Geometry inputs are identified by the implicit-sharing identity and version of
+ * their components, so an entry can only be reused if exactly the same unmodified data is passed
+ * in again, which is typically the case when the upstream node was cached as well. Fields are
+ * identified by their deep hash.
+ */
+
+#include "BLI_function_ref.hh"
+
+#include "FN_lazy_function.hh"
+
+struct bNode;
+
+namespace blender::nodes::node_cache {
+
+namespace lf = fn::lazy_function;
+
+/** True if the cache is enabled in the user preferences. */
+bool is_enabled();
+
+/**
+ * Check whether the node can be cached at all, independent of the values that are passed to it.
+ * This excludes nodes that depend on data that is not part of their inputs.
+ */
+bool node_supports_caching(const bNode &node);
+
+/**
+ * Get a new identifier for a lazy-function that uses the cache. Identifiers are never reused, so
+ * that entries of a lazy-function that has been freed can't be found anymore.
+ */
+uint64_t new_cache_uid();
+
+/**
+ * Execute the node using cached outputs if possible. All inputs of the lazy-function have to be
+ * available already. The given #execute_fn executes the node with the params passed to it. If
+ * false is returned, the input values can't be cached and nothing has been done.
+ */
+bool execute_cached(const lf::LazyFunction &fn,
+                    const bNode &node,
+                    uint64_t cache_uid,
+                    lf::Params &params,
+                    const lf::Context &context,
+                    FunctionRef<void(lf::Params &params)> execute_fn);
+
+}  // namespace blender::nodes::node_cache
@@ -0,0 +1,161 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+#include "testing/testing.h"
+
+#include <atomic>
+
+#include "BLI_memory_cache.hh"
+
+#include "BKE_compute_contexts.hh"
+#include "BKE_geometry_set.hh"
+#include "BKE_gtest_base.hh"
+#include "BKE_mesh.hh"
+#include "BKE_node_socket_value.hh"
+
+#include "DNA_mesh_types.h"
+#include "DNA_node_types.h"
+
+#include "NOD_geometry_nodes_lazy_function.hh"
+
+#include "geometry_nodes_node_cache.hh"
+
+namespace blender::nodes::node_cache::tests {
+
+using bke::GeometrySet;
+using bke::SocketValueVariant;
+
+class NodeCacheTest : public bke::BlenderGTestBase {
+ protected:
+  void SetUp() override
+  {
+    memory_cache::clear();
+  }
+
+  void TearDown() override
+  {
+    memory_cache::clear();
+    memory_cache::set_approximate_size_limit(1024 * 1024 * 1024);
+  }
+};
+
+/** Adds the given number of vertices to a new mesh and counts how often it is executed. */
+class AddVerticesFunction : public lf::LazyFunction {
+ public:
+  mutable std::atomic<int> executions = 0;
+
+  AddVerticesFunction()
+  {
+    debug_name_ = "Add Vertices";
+    inputs_.append({"Geometry", CPPType::get<SocketValueVariant>()});
+    inputs_.append({"Count", CPPType::get<SocketValueVariant>()});
+    outputs_.append({"Geometry", CPPType::get<SocketValueVariant>()});
+  }
+
+  void execute_impl(lf::Params &params, const lf::Context & /*context*/) const override
+  {
+    executions++;
+    const int count = params.get_input<SocketValueVariant>(1).get<int>();
+    Mesh *mesh = BKE_mesh_new_nomain(count, 0, 0, 0);
+    params.set_output(0, SocketValueVariant::From(GeometrySet::from_mesh(mesh)));
+  }
+};
+
+/** Execute the function through the cache and return the vertex count of its output. */
+static int execute_cached_test(const AddVerticesFunction &fn,
+                               const uint64_t cache_uid,
+                               const GeometrySet &geometry,
+                               const int count)
+{
+  SocketValueVariant geometry_input = SocketValueVariant::From(GeometrySet(geometry));
+  SocketValueVariant count_input = SocketValueVariant::From(count);
+  TypedBuffer<SocketValueVariant> output;
+  Array<GMutablePointer> inputs = {{CPPType::get<SocketValueVariant>(), &geometry_input},
+                                   {CPPType::get<SocketValueVariant>(), &count_input}};
+  Array<GMutablePointer> outputs = {{CPPType::get<SocketValueVariant>(), output}};
+  Array<std::optional<lf::ValueUsage>> input_usages(inputs.size());
+  Array<lf::ValueUsage> output_usages = {lf::ValueUsage::Used};
+  Array<bool> set_outputs = {false};
+  lf::BasicParams params{fn, inputs, outputs, input_usages, output_usages, set_outputs};
+
+  bke::OperatorComputeContext compute_context;
+  GeoNodesCallData call_data;
+  GeoNodesUserData user_data;
+  user_data.call_data = &call_data;
+  user_data.compute_context = &compute_context;
+  GeoNodesLocalUserData local_user_data(user_data);
+  lf::Context context{nullptr, &user_data, &local_user_data};
+
+  bNode node{};
+  const bool cached = execute_cached(
+      fn, node, cache_uid, params, context, [&](lf::Params &exec_params) {
+        fn.execute(exec_params, context);
+      });
+  EXPECT_TRUE(cached);
+  EXPECT_TRUE(set_outputs[0]);
+
+  const GeometrySet result = (*output).get<GeometrySet>();
+  (*output).~SocketValueVariant();
+  const Mesh *mesh = result.get_mesh();
+  return mesh ? mesh->verts_num : 0;
+}
+
+TEST_F(NodeCacheTest, HitWithSameInputs)
+{
+  const AddVerticesFunction fn;
+  const uint64_t cache_uid = new_cache_uid();
+  const GeometrySet geometry = GeometrySet::from_mesh(BKE_mesh_new_nomain(3, 0, 0, 0));
+
+  EXPECT_EQ(execute_cached_test(fn, cache_uid, geometry, 10), 10);
+  EXPECT_EQ(fn.executions.load(), 1);
+  EXPECT_EQ(execute_cached_test(fn, cache_uid, geometry, 10), 10);
+  EXPECT_EQ(fn.executions.load(), 1);
+
+  /* A different function with the same inputs doesn't use the cached value. */
+  EXPECT_EQ(execute_cached_test(fn, new_cache_uid(), geometry, 10), 10);
+  EXPECT_EQ(fn.executions.load(), 2);
+}
+
+TEST_F(NodeCacheTest, MissWithChangedInputs)
+{
+  const AddVerticesFunction fn;
+  const uint64_t cache_uid = new_cache_uid();
+  GeometrySet geometry = GeometrySet::from_mesh(BKE_mesh_new_nomain(3, 0, 0, 0));
+
+  EXPECT_EQ(execute_cached_test(fn, cache_uid, geometry, 10), 10);
+  EXPECT_EQ(execute_cached_test(fn, cache_uid, geometry, 20), 20);
+  EXPECT_EQ(fn.executions.load(), 2);
+
+  /* Modifying the geometry in place changes its version. */
+  geometry.get_mesh_for_write()->tag_positions_changed();
+  EXPECT_EQ(execute_cached_test(fn, cache_uid, geometry, 10), 10);
+  EXPECT_EQ(fn.executions.load(), 3);
+
+  /* A different geometry with the same content is not identified as the same input. */
+  const GeometrySet other_geometry = GeometrySet::from_mesh(BKE_mesh_new_nomain(3, 0, 0, 0));
+  EXPECT_EQ(execute_cached_test(fn, cache_uid, other_geometry, 10), 10);
+  EXPECT_EQ(fn.executions.load(), 4);
+}
+
+TEST_F(NodeCacheTest, EvictWhenFull)
+{
+  const AddVerticesFunction fn;
+  const uint64_t cache_uid = new_cache_uid();
+  const GeometrySet geometry;
+
+  /* Every value has at least 12 MB of positions, so only a few fit into the cache. */
+  const int count = 1024 * 1024;
+  memory_cache::set_approximate_size_limit(32 * 1024 * 1024);
+  for (const int i : IndexRange(8)) {
+    EXPECT_EQ(execute_cached_test(fn, cache_uid, geometry, count + i), count + i);
+  }
+  EXPECT_EQ(fn.executions.load(), 8);
+
+  /* The most recently used value is still cached, but the oldest one was freed. */
+  EXPECT_EQ(execute_cached_test(fn, cache_uid, geometry, count + 7), count + 7);
+  EXPECT_EQ(fn.executions.load(), 8);
+  EXPECT_EQ(execute_cached_test(fn, cache_uid, geometry, count), count);
+  EXPECT_EQ(fn.executions.load(), 9);
+}
+
+}  // namespace blender::nodes::node_cache::tests
@@ -528,6 +528,13 @@ class MixColorFunction : public mf::MultiFunction {
     hash.add(clamp_result_);
     hash.add(blend_type_);
   }
+
+  ExecutionHints get_execution_hints() const override
+  {
+    ExecutionHints hints;
+    hints.is_elementwise = true;
+    return hints;
+  }
 };
 
 static const mf::MultiFunction *get_multi_function(const bNode &node)